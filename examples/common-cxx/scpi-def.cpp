@@ -371,7 +371,9 @@ const scpi_command_t scpi_commands[] = {
 
     /* Required SCPI commands (SCPI std V1999.0 4.2.1) */
     {"SYSTem:ERRor[:NEXT]?", SCPI_SystemErrorNextQ, 0},
+    {"SYSTem:ERRor:ALL?", SCPI_SystemErrorAllQ, 0},
     {"SYSTem:ERRor:COUNt?", SCPI_SystemErrorCountQ, 0},
+    {"SYSTem:ERRor:STATistics?", SCPI_SystemErrorStatisticsQ, 0},
     {"SYSTem:VERSion?", SCPI_SystemVersionQ, 0},
 
     //{"STATus:OPERation?", scpi_stub_callback, 0},
@@ -384,8 +386,18 @@ const scpi_command_t scpi_commands[] = {
     //{"STATus:QUEStionable:CONDition?", scpi_stub_callback, 0},
     {"STATus:QUEStionable:ENABle", SCPI_StatusQuestionableEnable, 0},
     {"STATus:QUEStionable:ENABle?", SCPI_StatusQuestionableEnableQ, 0},
+    {"STATus:QUEStionable:PTRansition", SCPI_StatusQuestionablePtransition, 0},
+    {"STATus:QUEStionable:PTRansition?", SCPI_StatusQuestionablePtransitionQ, 0},
+    {"STATus:QUEStionable:NTRansition", SCPI_StatusQuestionableNtransition, 0},
+    {"STATus:QUEStionable:NTRansition?", SCPI_StatusQuestionableNtransitionQ, 0},
 
     {"STATus:PRESet", SCPI_StatusPreset, 0},
+    {"STATus:SNAPshot?", SCPI_StatusSnapshotQ, 0},
+
+    {"FORMat[:DATA]", SCPI_FormatData, 0},
+    {"FORMat[:DATA]?", SCPI_FormatDataQ, 0},
+    {"FORMat:BORDer", SCPI_FormatBorder, 0},
+    {"FORMat:BORDer?", SCPI_FormatBorderQ, 0},
 
     /* DMM */
     {"MEASure:VOLTage:DC?", DMM_MeasureVoltageDcQ, 0},
@@ -417,6 +429,11 @@ scpi_interface_t scpi_interface = {
     /*.control = */ SCPI_Control,
     /*.flush = */ SCPI_Flush,
     /*.reset = */ SCPI_Reset,
+    /*.reserve = */ NULL,
+    /*.commit = */ NULL,
+    /*.writev = */ NULL,
+    /*.sendfile = */ NULL,
+    /*.error_batch = */ NULL,
 };
 
 char scpi_input_buffer[SCPI_INPUT_BUFFER_LENGTH];
@@ -371,7 +371,9 @@ const scpi_command_t scpi_commands[] = {
 
     /* Required SCPI commands (SCPI std V1999.0 4.2.1) */
     {.pattern = "SYSTem:ERRor[:NEXT]?", .callback = SCPI_SystemErrorNextQ,},
+    {.pattern = "SYSTem:ERRor:ALL?", .callback = SCPI_SystemErrorAllQ,},
     {.pattern = "SYSTem:ERRor:COUNt?", .callback = SCPI_SystemErrorCountQ,},
+    {.pattern = "SYSTem:ERRor:STATistics?", .callback = SCPI_SystemErrorStatisticsQ,},
     {.pattern = "SYSTem:VERSion?", .callback = SCPI_SystemVersionQ,},
 
     /* {.pattern = "STATus:OPERation?", .callback = scpi_stub_callback,}, */
@@ -384,8 +386,18 @@ const scpi_command_t scpi_commands[] = {
     /* {.pattern = "STATus:QUEStionable:CONDition?", .callback = scpi_stub_callback,}, */
     {.pattern = "STATus:QUEStionable:ENABle", .callback = SCPI_StatusQuestionableEnable,},
     {.pattern = "STATus:QUEStionable:ENABle?", .callback = SCPI_StatusQuestionableEnableQ,},
+    {.pattern = "STATus:QUEStionable:PTRansition", .callback = SCPI_StatusQuestionablePtransition,},
+    {.pattern = "STATus:QUEStionable:PTRansition?", .callback = SCPI_StatusQuestionablePtransitionQ,},
+    {.pattern = "STATus:QUEStionable:NTRansition", .callback = SCPI_StatusQuestionableNtransition,},
+    {.pattern = "STATus:QUEStionable:NTRansition?", .callback = SCPI_StatusQuestionableNtransitionQ,},
 
     {.pattern = "STATus:PRESet", .callback = SCPI_StatusPreset,},
+    {.pattern = "STATus:SNAPshot?", .callback = SCPI_StatusSnapshotQ,},
+
+    {.pattern = "FORMat[:DATA]", .callback = SCPI_FormatData,},
+    {.pattern = "FORMat[:DATA]?", .callback = SCPI_FormatDataQ,},
+    {.pattern = "FORMat:BORDer", .callback = SCPI_FormatBorder,},
+    {.pattern = "FORMat:BORDer?", .callback = SCPI_FormatBorderQ,},
 
     /* DMM */
     {.pattern = "MEASure:VOLTage:DC?", .callback = DMM_MeasureVoltageDcQ,},
@@ -0,0 +1,164 @@
+/*-
+ * BSD 2-Clause License
+ *
+ * Copyright (c) 2012-2018, Jan Breuer
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * * Redistributions of source code must retain the above copyright notice, this
+ *   list of conditions and the following disclaimer.
+ *
+ * * Redistributions in binary form must reproduce the above copyright notice,
+ *   this list of conditions and the following disclaimer in the documentation
+ *   and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/**
+ * @file   main.c
+ *
+ * @brief  Benchmark of array result formats
+ *
+ * Sends the same waveform as binary block in NORMAL and COMPRESSED format
+ * and reports size of the response, CPU time per response and time needed
+ * to transfer the response over slow links.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <time.h>
+#include "scpi/scpi.h"
+
+#define SAMPLES     (1024 * 1024)
+#define REPEAT      10
+
+static size_t written;
+
+static size_t SCPI_Write(scpi_t * context, const char * data, size_t len) {
+    (void) context;
+    (void) data;
+    written += len;
+    return len;
+}
+
+static scpi_interface_t scpi_interface = {
+    .write = SCPI_Write,
+};
+
+static const scpi_command_t scpi_commands[] = {
+    SCPI_CMD_LIST_END
+};
+
+static char scpi_input_buffer[256];
+static scpi_error_t scpi_error_queue_data[16];
+static scpi_t scpi_context;
+
+static int16_t wave_int16[SAMPLES];
+static int32_t wave_int32[SAMPLES];
+static float wave_float[SAMPLES];
+
+typedef size_t (*result_array_t)(scpi_t * context, const void * array, size_t count, scpi_array_format_t format);
+
+static size_t resultInt16(scpi_t * context, const void * array, size_t count, scpi_array_format_t format) {
+    return SCPI_ResultArrayInt16(context, (const int16_t *) array, count, format);
+}
+
+static size_t resultInt32(scpi_t * context, const void * array, size_t count, scpi_array_format_t format) {
+    return SCPI_ResultArrayInt32(context, (const int32_t *) array, count, format);
+}
+
+static size_t resultFloat(scpi_t * context, const void * array, size_t count, scpi_array_format_t format) {
+    return SCPI_ResultArrayFloat(context, (const float *) array, count, format);
+}
+
+static double now(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+/**
+ * Measure one format
+ * @param result - array result function
+ * @param array - data
+ * @param format - NORMAL or COMPRESSED
+ * @param size - size of the response
+ * @return CPU time of one response in seconds
+ */
+static double measure(result_array_t result, const void * array, scpi_array_format_t format, size_t * size) {
+    double start;
+    double best = 0;
+    double t;
+    int i;
+
+    for (i = 0; i < REPEAT; i++) {
+        written = 0;
+        scpi_context.output_count = 0;
+        start = now();
+        result(&scpi_context, array, SAMPLES, format);
+        t = now() - start;
+        if ((i == 0) || (t < best)) {
+            best = t;
+        }
+    }
+    *size = written;
+    return best;
+}
+
+static void report(const char * name, result_array_t result, const void * array) {
+    size_t normal_size;
+    size_t compressed_size;
+    double normal_time = measure(result, array, SCPI_FORMAT_NORMAL, &normal_size);
+    double compressed_time = measure(result, array, SCPI_FORMAT_COMPRESSED, &compressed_size);
+
+    printf("%-6s %9zu %8.2f %9zu %8.2f %6.2f %8.2f %8.2f\n", name,
+            normal_size, normal_time * 1e3,
+            compressed_size, compressed_time * 1e3,
+            (double) normal_size / compressed_size,
+            normal_size * 8 / 1e6, compressed_size * 8 / 1e6);
+}
+
+int main(void) {
+    double v;
+    size_t i;
+
+    SCPI_Init(&scpi_context,
+            scpi_commands,
+            &scpi_interface,
+            scpi_units_def,
+            "BENCH", "SCPI", NULL, "1",
+            scpi_input_buffer, sizeof (scpi_input_buffer),
+            scpi_error_queue_data, sizeof (scpi_error_queue_data) / sizeof (scpi_error_queue_data[0]));
+
+    /* slowly varying waveform with small noise */
+    srand(1);
+    for (i = 0; i < SAMPLES; i++) {
+        v = sin(2 * M_PI * i / 4096.0) + (rand() % 64 - 32) / 32768.0;
+        wave_int16[i] = (int16_t) (v * 30000);
+        wave_int32[i] = (int32_t) (v * 2000000000.0);
+        wave_float[i] = (float) v;
+    }
+
+    printf("%d samples, best of %d, transfer time at 1 Mbit/s\n", SAMPLES, REPEAT);
+    printf("%-6s %9s %8s %9s %8s %6s %8s %8s\n", "type",
+            "NORMAL B", "ms", "COMPR. B", "ms", "ratio", "NORM. s", "COMPR. s");
+    report("int16", resultInt16, wave_int16);
+    report("int32", resultInt32, wave_int32);
+    report("float", resultFloat, wave_float);
+
+    return SCPI_ErrorCount(&scpi_context) == 0 ? 0 : 1;
+}
@@ -336,6 +336,9 @@ int main(int argc, char** argv) {
             processSrqIo(&user_data);
         }
 
+        /* deliver service request of status changes outside of SCPI_Parse */
+        SCPI_RegServiceRequestFlush(&scpi_context);
+
     }
 
     return (EXIT_SUCCESS);
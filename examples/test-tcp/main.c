@@ -42,6 +42,8 @@
 #include <sys/select.h>
 #include <sys/socket.h>
 #include <sys/ioctl.h>
+#include <sys/uio.h>
+#include <sys/sendfile.h>
 #include <errno.h>
 #include <arpa/inet.h>
 #include <unistd.h>
@@ -62,6 +64,49 @@ size_t SCPI_Write(scpi_t * context, const char * data, size_t len) {
     return 0;
 }
 
+static size_t SCPI_Writev(scpi_t * context, const scpi_iovec_t * iov, size_t iovcnt) {
+    if (context->user_context != NULL) {
+        int fd = *(int *) (context->user_context);
+        struct iovec vec[4];
+        ssize_t result;
+        size_t i;
+
+        if (iovcnt > 4) {
+            iovcnt = 4;
+        }
+        for (i = 0; i < iovcnt; i++) {
+            vec[i].iov_base = (void *) iov[i].data;
+            vec[i].iov_len = iov[i].len;
+        }
+
+        int state = 1;
+        setsockopt(fd, IPPROTO_TCP, TCP_CORK, &state, sizeof(state));
+
+        result = writev(fd, vec, iovcnt);
+        return result < 0 ? 0 : (size_t) result;
+    }
+    return 0;
+}
+
+static size_t SCPI_Sendfile(scpi_t * context, int fd, int64_t offset, size_t len) {
+    if (context->user_context != NULL) {
+        int sockfd = *(int *) (context->user_context);
+        off_t off = (off_t) offset;
+        size_t sent = 0;
+        ssize_t result;
+
+        while (sent < len) {
+            result = sendfile(sockfd, fd, &off, len - sent);
+            if (result <= 0) {
+                break;
+            }
+            sent += (size_t) result;
+        }
+        return sent;
+    }
+    return 0;
+}
+
 scpi_result_t SCPI_Flush(scpi_t * context) {
     if (context->user_context != NULL) {
         int fd = *(int *) (context->user_context);
@@ -190,6 +235,11 @@ int main(int argc, char** argv) {
     /* user_context will be pointer to socket */
     scpi_context.user_context = NULL;
 
+    /* header and data of arbitrary blocks in one system call */
+    scpi_interface.writev = SCPI_Writev;
+    /* file data of arbitrary blocks without copying to user memory */
+    scpi_interface.sendfile = SCPI_Sendfile;
+
     SCPI_Init(&scpi_context,
             scpi_commands,
             &scpi_interface,
@@ -51,6 +51,9 @@ extern "C" {
 #  if (__STDC_VERSION__ >= 199901L)
 #   define C99 1
 #  endif
+#  if (__STDC_VERSION__ >= 201112L)
+#   define C11 1
+#  endif
 # endif
 #endif
 
@@ -74,6 +77,11 @@ extern "C" {
     #define HAVE_SNPRINTF 1
 #endif
 
+#if (defined _XOPEN_SOURCE && _XOPEN_SOURCE >= 500) || \
+    (defined _POSIX_C_SOURCE && _POSIX_C_SOURCE >= 200809L)
+    #define HAVE_PREAD 1
+#endif
+
 #if (defined _POSIX_C_SOURCE && _POSIX_C_SOURCE >= 200112L)
     #define HAVE_STRNCASECMP 1
 #endif
@@ -114,6 +122,10 @@ extern "C" {
     #define HAVE_STDBOOL 1
 #endif
 
+#if C11 && !defined(__STDC_NO_ATOMICS__)
+    #define HAVE_STDATOMIC 1
+#endif
+
 /* Compiler specific */
 /* RealView/Keil ARM Compiler, e.g. Cortex-M CPUs */
 #if defined(__CC_ARM)
@@ -196,6 +208,14 @@ extern "C" {
 #define HAVE_STRTOLL            0
 #endif
 
+#ifndef HAVE_PREAD
+#define HAVE_PREAD              0
+#endif
+
+#ifndef HAVE_STDATOMIC
+#define HAVE_STDATOMIC          0
+#endif
+
 #ifndef HAVE_STRTOF
 #define HAVE_STRTOF             0
 #endif
@@ -178,6 +178,132 @@ extern "C" {
 #define USE_UNITS_ELECTRIC_CHARGE_CONDUCTANCE SYSTEM_TYPE
 #endif
 
+/**
+ * Convert large ASCII arrays (SCPI_ResultArray* and SCPI_ParamArray*) on
+ * several threads. Requires POSIX threads (link with -lpthread), so it is
+ * disabled by default and bare metal builds keep the sequential path.
+ * Arrays shorter than SCPI_PARALLEL_ARRAY_THRESHOLD items are always
+ * converted on the calling thread.
+ */
+#ifndef USE_PARALLEL_ARRAY_CONVERSION
+#define USE_PARALLEL_ARRAY_CONVERSION 0
+#endif
+
+#ifndef SCPI_PARALLEL_ARRAY_THRESHOLD
+#define SCPI_PARALLEL_ARRAY_THRESHOLD 65536
+#endif
+
+#ifndef SCPI_PARALLEL_ARRAY_THREADS
+#define SCPI_PARALLEL_ARRAY_THREADS 4
+#endif
+
+/**
+ * Size of stack buffer used by SCPI_ResultArbitraryBlockFile to copy file
+ * data when the interface has no sendfile callback.
+ */
+#ifndef SCPI_FILE_BLOCK_CHUNK_SIZE
+#define SCPI_FILE_BLOCK_CHUNK_SIZE 512
+#endif
+
+/**
+ * Error queue as lock-free multi-producer single-consumer ring. Errors can
+ * be pushed from other threads or interrupt handlers by SCPI_ErrorPushAsync
+ * while the parser pops them, status registers, counters and callbacks are
+ * then updated by the parser thread. Queue sizes are rounded down to power
+ * of two. Requires C11 atomics.
+ */
+#ifndef USE_ATOMIC_ERROR_QUEUE
+#define USE_ATOMIC_ERROR_QUEUE 0
+#endif
+
+#if USE_ATOMIC_ERROR_QUEUE && !HAVE_STDATOMIC
+#error "USE_ATOMIC_ERROR_QUEUE requires C11 atomics"
+#endif
+
+/**
+ * Status registers as C11 atomics. SCPI_RegSet, SCPI_RegSetBits and
+ * SCPI_RegClearBits can be then called from other threads while the parser
+ * is running, summary bits are propagated without locks.
+ */
+#ifndef USE_ATOMIC_REGISTERS
+#define USE_ATOMIC_REGISTERS 0
+#endif
+
+#if USE_ATOMIC_REGISTERS && !HAVE_STDATOMIC
+#error "USE_ATOMIC_REGISTERS requires C11 atomics"
+#endif
+
+/**
+ * Store device dependent error info in fixed size records carved from the
+ * buffer given to SCPI_InitHeap instead of the ring heap (applies when
+ * USE_MEMORY_ALLOCATION_FREE is 0). Allocation and free are O(1), identical
+ * info strings share one record and longer info is truncated to
+ * SCPI_ERROR_INFO_RECORD_LENGTH - 1 characters ending with "...". Records
+ * are a pool rather than a buffer inside every scpi_error_t, so the error
+ * queue items keep their size and SCPI_InitHeap still decides how much
+ * memory info uses.
+ * Give it (queue size + 1) * sizeof (scpi_error_info_record_t) bytes plus
+ * sizeof (void *) for alignment to have a record for every queue item.
+ */
+#ifndef USE_ERROR_INFO_RECORDS
+#define USE_ERROR_INFO_RECORDS 0
+#endif
+
+#ifndef SCPI_ERROR_INFO_RECORD_LENGTH
+#define SCPI_ERROR_INFO_RECORD_LENGTH 48
+#endif
+
+#if USE_ERROR_INFO_RECORDS && SCPI_ERROR_INFO_RECORD_LENGTH < 8
+#error "SCPI_ERROR_INFO_RECORD_LENGTH is too short for truncated info"
+#endif
+
+/**
+ * Capture info of errors detected by the parser (undefined header) as a
+ * reference into the input instead of copying it. The text is copied only
+ * for errors still queued when SCPI_Parse returns, so errors dropped by
+ * queue overflow or read in the same message never allocate.
+ */
+#ifndef USE_LAZY_ERROR_INFO
+#define USE_LAZY_ERROR_INFO 0
+#endif
+
+#if USE_LAZY_ERROR_INFO && USE_ATOMIC_ERROR_QUEUE
+#error "USE_LAZY_ERROR_INFO can't be used with USE_ATOMIC_ERROR_QUEUE"
+#endif
+
+#if !USE_DEVICE_DEPENDENT_ERROR_INFORMATION
+#undef USE_LAZY_ERROR_INFO
+#define USE_LAZY_ERROR_INFO 0
+#endif
+
+/**
+ * Deliver errors pushed while parsing a message at the end of the message
+ * in one error_batch callback, once per distinct error code with its repeat
+ * count. The window is one program message, not a time interval. At most
+ * SCPI_ERROR_COALESCE_SIZE distinct codes are reported per message, the
+ * rest are only counted. Without error_batch callback, error callback is
+ * called immediately for every error. Error queue and status registers are
+ * updated immediately.
+ */
+#ifndef USE_ERROR_COALESCING
+#define USE_ERROR_COALESCING 0
+#endif
+
+#ifndef SCPI_ERROR_COALESCE_SIZE
+#define SCPI_ERROR_COALESCE_SIZE 8
+#endif
+
+/**
+ * Don't call control callback with SCPI_CTRL_SRQ from the register update.
+ * Rising request service only marks the service request pending and it is
+ * delivered once by SCPI_RegServiceRequestFlush, called at the end of
+ * SCPI_Parse and by the application (main loop or notifier thread) for
+ * changes made outside of parsing.
+ */
+#ifndef USE_SRQ_COALESCING
+#define USE_SRQ_COALESCING 0
+#endif
+
 /* define local macros depending on existance of strnlen */
 #if HAVE_STRNLEN
 #define SCPIDEFINE_strnlen(s, l)	strnlen((s), (l))
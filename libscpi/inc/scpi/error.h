@@ -52,6 +52,19 @@ extern "C" {
     void SCPI_ErrorPush(scpi_t * context, int16_t err);
     int32_t SCPI_ErrorCount(scpi_t * context);
     const char * SCPI_ErrorTranslate(int16_t err);
+    void SCPI_ErrorCountersInit(scpi_t * context, uint32_t * counters, size_t size);
+    void SCPI_ErrorCountersClear(scpi_t * context);
+    uint32_t SCPI_ErrorCounterGet(scpi_t * context, int16_t err);
+    uint32_t SCPI_ErrorCounterOtherGet(scpi_t * context);
+#if USE_ATOMIC_ERROR_QUEUE
+    void SCPI_ErrorAsyncInit(scpi_t * context, scpi_error_t * data, int16_t size);
+    scpi_bool_t SCPI_ErrorPushAsync(scpi_t * context, int16_t err);
+    void SCPI_ErrorAsyncApply(scpi_t * context);
+#endif
+#if USE_ERROR_COALESCING
+    void SCPI_ErrorBatchBegin(scpi_t * context);
+    void SCPI_ErrorBatchEnd(scpi_t * context);
+#endif
 
 
     /* Using X-Macro technique to define everything once
@@ -93,7 +106,7 @@ extern "C" {
     X(SCPI_ERROR_INVALID_STRING_DATA,           -151, "Invalid string data")                          \
     XE(SCPI_ERROR_STRING_DATA_NOT_ALLOWED,      -158, "String data not allowed")                      \
     XE(SCPI_ERROR_BLOCK_DATA_ERROR,             -160, "Block data error")                             \
-    XE(SCPI_ERROR_INVALID_BLOCK_DATA,           -161, "Invalid block data")                           \
+    X(SCPI_ERROR_INVALID_BLOCK_DATA,            -161, "Invalid block data")                           \
     XE(SCPI_ERROR_BLOCK_DATA_NOT_ALLOWED,       -168, "Block data not allowed")                       \
     X(SCPI_ERROR_EXPRESSION_PARSING_ERROR,      -170, "Expression error")                             \
     XE(SCPI_ERROR_INVAL_EXPRESSION,             -171, "Invalid expression")                           \
@@ -124,7 +137,7 @@ extern "C" {
     XE(SCPI_ERROR_INVAL_VERSION,                -233, "Invalid version")                              \
     XE(SCPI_ERROR_HARDWARE_ERROR,               -240, "Hardware error")                               \
     XE(SCPI_ERROR_HARDWARE_MISSING,             -241, "Hardware missing")                             \
-    XE(SCPI_ERROR_MASS_STORAGE_ERROR,           -250, "Mass storage error")                           \
+    X(SCPI_ERROR_MASS_STORAGE_ERROR,            -250, "Mass storage error")                           \
     XE(SCPI_ERROR_MISSING_MASS_STORAGE,         -251, "Missing mass storage")                         \
     XE(SCPI_ERROR_MISSING_MASS_MEDIA,           -252, "Missing media")                                \
     XE(SCPI_ERROR_CORRUPT_MEDIA,                -253, "Corrupt media")                                \
@@ -174,10 +187,10 @@ extern "C" {
     X(SCPI_ERROR_INPUT_BUFFER_OVERRUN,          -363, "Input buffer overrun")                         \
     XE(SCPI_ERROR_TIME_OUT,                     -365, "Time out error")                               \
     XE(SCPI_ERROR_QUERY_ERROR,                  -400, "Query error")                                  \
-    XE(SCPI_ERROR_QUERY_INTERRUPTED,            -410, "Query INTERRUPTED")                            \
+    X(SCPI_ERROR_QUERY_INTERRUPTED,             -410, "Query INTERRUPTED")                            \
     XE(SCPI_ERROR_QUERY_UNTERMINATED,           -420, "Query UNTERMINATED")                           \
-    XE(SCPI_ERROR_QUERY_DEADLOCKED,             -430, "Query DEADLOCKED")                             \
-    XE(SCPI_ERROR_QUERY_UNTERM_INDEF_RESP,      -440, "Query UNTERMINATED after indefinite response") \
+    X(SCPI_ERROR_QUERY_DEADLOCKED,              -430, "Query DEADLOCKED")                             \
+    X(SCPI_ERROR_QUERY_UNTERM_INDEF_RESP,       -440, "Query UNTERMINATED after indefinite response") \
     XE(SCPI_ERROR_POWER_ON,                     -500, "Power on")                                     \
     XE(SCPI_ERROR_USER_REQUEST,                 -600, "User request")                                 \
     XE(SCPI_ERROR_REQUEST_CONTROL,              -700, "Request control")                              \
@@ -193,6 +206,25 @@ extern "C" {
 #endif
         LIST_OF_ERRORS
 
+#if USE_USER_ERROR_LIST
+        LIST_OF_USER_ERRORS
+#endif
+#undef X
+#undef XE
+    };
+
+    /* number of counters for SCPI_ErrorCountersInit, one for each error in
+     * the lists and one for all other errors */
+    enum {
+#define X(def, val, str) + 1
+#if USE_FULL_ERROR_LIST
+#define XE X
+#else
+#define XE(def, val, str)
+#endif
+        SCPI_ERROR_COUNTERS_SIZE = 1
+        LIST_OF_ERRORS
+
 #if USE_USER_ERROR_LIST
         LIST_OF_USER_ERRORS
 #endif
@@ -80,9 +80,13 @@ extern "C" {
 
 
     scpi_reg_val_t SCPI_RegGet(scpi_t * context, scpi_reg_name_t name);
+    scpi_reg_class_t SCPI_RegClass(scpi_reg_name_t name);
     void SCPI_RegSet(scpi_t * context, scpi_reg_name_t name, scpi_reg_val_t val);
     void SCPI_RegSetBits(scpi_t * context, scpi_reg_name_t name, scpi_reg_val_t bits);
     void SCPI_RegClearBits(scpi_t * context, scpi_reg_name_t name, scpi_reg_val_t bits);
+    void SCPI_RegSetConditions(scpi_t * context, const scpi_reg_condition_t * conditions, size_t count);
+    void SCPI_RegPresetFilters(scpi_t * context);
+    scpi_bool_t SCPI_RegServiceRequestFlush(scpi_t * context);
 
     void SCPI_EventClear(scpi_t * context);
 
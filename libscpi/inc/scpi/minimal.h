@@ -49,16 +49,31 @@ extern "C" {
 
     scpi_result_t SCPI_SystemVersionQ(scpi_t * context);
     scpi_result_t SCPI_SystemErrorNextQ(scpi_t * context);
+    scpi_result_t SCPI_SystemErrorAllQ(scpi_t * context);
     scpi_result_t SCPI_SystemErrorCountQ(scpi_t * context);
+    scpi_result_t SCPI_SystemErrorStatisticsQ(scpi_t * context);
     scpi_result_t SCPI_StatusQuestionableEventQ(scpi_t * context);
     scpi_result_t SCPI_StatusQuestionableConditionQ(scpi_t * context);
     scpi_result_t SCPI_StatusQuestionableEnableQ(scpi_t * context);
     scpi_result_t SCPI_StatusQuestionableEnable(scpi_t * context);
+    scpi_result_t SCPI_StatusQuestionablePtransitionQ(scpi_t * context);
+    scpi_result_t SCPI_StatusQuestionablePtransition(scpi_t * context);
+    scpi_result_t SCPI_StatusQuestionableNtransitionQ(scpi_t * context);
+    scpi_result_t SCPI_StatusQuestionableNtransition(scpi_t * context);
     scpi_result_t SCPI_StatusOperationConditionQ(scpi_t * context);
     scpi_result_t SCPI_StatusOperationEventQ(scpi_t * context);
     scpi_result_t SCPI_StatusOperationEnableQ(scpi_t * context);
     scpi_result_t SCPI_StatusOperationEnable(scpi_t * context);
+    scpi_result_t SCPI_StatusOperationPtransitionQ(scpi_t * context);
+    scpi_result_t SCPI_StatusOperationPtransition(scpi_t * context);
+    scpi_result_t SCPI_StatusOperationNtransitionQ(scpi_t * context);
+    scpi_result_t SCPI_StatusOperationNtransition(scpi_t * context);
     scpi_result_t SCPI_StatusPreset(scpi_t * context);
+    scpi_result_t SCPI_StatusSnapshotQ(scpi_t * context);
+    scpi_result_t SCPI_FormatData(scpi_t * context);
+    scpi_result_t SCPI_FormatDataQ(scpi_t * context);
+    scpi_result_t SCPI_FormatBorder(scpi_t * context);
+    scpi_result_t SCPI_FormatBorderQ(scpi_t * context);
 
 
 #ifdef	__cplusplus
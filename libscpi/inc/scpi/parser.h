@@ -55,8 +55,17 @@ extern "C" {
     void SCPI_InitHeap(scpi_t * context, char * error_info_heap, size_t error_info_heap_length);
 #endif
 
-    scpi_bool_t SCPI_Input(scpi_t * context, const char * data, int len);
-    scpi_bool_t SCPI_Parse(scpi_t * context, char * data, int len);
+    void SCPI_InitOutputBuffer(scpi_t * context, char * output_buffer, size_t output_buffer_length);
+
+    scpi_bool_t SCPI_Input(scpi_t * context, const char * data, size_t len);
+    scpi_bool_t SCPI_Parse(scpi_t * context, char * data, size_t len);
+    size_t SCPI_OutputFlush(scpi_t * context);
+    size_t SCPI_OutputPending(scpi_t * context);
+    size_t SCPI_OutputPull(scpi_t * context, char * buffer, size_t len);
+
+    int32_t SCPI_OperationBegin(scpi_t * context);
+    void SCPI_OperationComplete(scpi_t * context, int32_t handle);
+    scpi_bool_t SCPI_OperationPending(scpi_t * context);
 
     size_t SCPI_ResultCharacters(scpi_t * context, const char * data, size_t len);
 #define SCPI_ResultMnemonic(context, data) SCPI_ResultCharacters((context), (data), strlen(data))
@@ -79,6 +88,16 @@ extern "C" {
     size_t SCPI_ResultArbitraryBlock(scpi_t * context, const void * data, size_t len);
     size_t SCPI_ResultArbitraryBlockHeader(scpi_t * context, size_t len);
     size_t SCPI_ResultArbitraryBlockData(scpi_t * context, const void * data, size_t len);
+    void * SCPI_ResultArbitraryBlockReserve(scpi_t * context, size_t len);
+    size_t SCPI_ResultArbitraryBlockCommit(scpi_t * context, size_t len);
+#if HAVE_PREAD
+    size_t SCPI_ResultArbitraryBlockFile(scpi_t * context, int fd, int64_t offset, size_t len);
+#endif
+    size_t SCPI_ResultArbitraryBlockIndefiniteHeader(scpi_t * context);
+    size_t SCPI_ResultArbitraryBlockIndefiniteData(scpi_t * context, const void * data, size_t len);
+#define SCPI_BLOCK_LENGTH_UNKNOWN ((size_t) -1)
+#define SCPI_BLOCK_LENGTH_MAX 999999999UL
+    size_t SCPI_ResultArbitraryBlockStream(scpi_t * context, size_t len, scpi_stream_producer_t producer, void * user_data);
     size_t SCPI_ResultBool(scpi_t * context, scpi_bool_t val);
 
     size_t SCPI_ResultArrayInt8(scpi_t * context, const int8_t * array, size_t count, scpi_array_format_t format);
@@ -91,6 +110,25 @@ extern "C" {
     size_t SCPI_ResultArrayUInt64(scpi_t * context, const uint64_t * array, size_t count, scpi_array_format_t format);
     size_t SCPI_ResultArrayFloat(scpi_t * context, const float * array, size_t count, scpi_array_format_t format);
     size_t SCPI_ResultArrayDouble(scpi_t * context, const double * array, size_t count, scpi_array_format_t format);
+    size_t SCPI_ResultArrayStridedInt8(scpi_t * context, const int8_t * array, size_t offset, size_t stride, size_t count, scpi_array_format_t format);
+    size_t SCPI_ResultArrayStridedUInt8(scpi_t * context, const uint8_t * array, size_t offset, size_t stride, size_t count, scpi_array_format_t format);
+    size_t SCPI_ResultArrayStridedInt16(scpi_t * context, const int16_t * array, size_t offset, size_t stride, size_t count, scpi_array_format_t format);
+    size_t SCPI_ResultArrayStridedUInt16(scpi_t * context, const uint16_t * array, size_t offset, size_t stride, size_t count, scpi_array_format_t format);
+    size_t SCPI_ResultArrayStridedInt32(scpi_t * context, const int32_t * array, size_t offset, size_t stride, size_t count, scpi_array_format_t format);
+    size_t SCPI_ResultArrayStridedUInt32(scpi_t * context, const uint32_t * array, size_t offset, size_t stride, size_t count, scpi_array_format_t format);
+    size_t SCPI_ResultArrayStridedInt64(scpi_t * context, const int64_t * array, size_t offset, size_t stride, size_t count, scpi_array_format_t format);
+    size_t SCPI_ResultArrayStridedUInt64(scpi_t * context, const uint64_t * array, size_t offset, size_t stride, size_t count, scpi_array_format_t format);
+    size_t SCPI_ResultArrayStridedFloat(scpi_t * context, const float * array, size_t offset, size_t stride, size_t count, scpi_array_format_t format);
+    size_t SCPI_ResultArrayStridedDouble(scpi_t * context, const double * array, size_t offset, size_t stride, size_t count, scpi_array_format_t format);
+    size_t SCPI_ResultArrayHalf(scpi_t * context, const float * array, size_t count, scpi_array_format_t format);
+    size_t SCPI_ResultArrayPackedInt32(scpi_t * context, const int32_t * array, size_t count, size_t bits, scpi_array_format_t format);
+    size_t SCPI_ResultArrayPackedUInt32(scpi_t * context, const uint32_t * array, size_t count, size_t bits, scpi_array_format_t format);
+
+    scpi_array_format_t SCPI_DataArrayFormat(scpi_t * context);
+    size_t SCPI_ResultDataArrayInt16(scpi_t * context, const int16_t * array, size_t count);
+    size_t SCPI_ResultDataArrayInt32(scpi_t * context, const int32_t * array, size_t count);
+    size_t SCPI_ResultDataArrayFloat(scpi_t * context, const float * array, size_t count);
+    size_t SCPI_ResultDataArrayDouble(scpi_t * context, const double * array, size_t count);
 
     scpi_bool_t SCPI_Parameter(scpi_t * context, scpi_parameter_t * parameter, scpi_bool_t mandatory);
     scpi_bool_t SCPI_ParamIsValid(scpi_parameter_t * parameter);
@@ -125,6 +163,9 @@ extern "C" {
     scpi_bool_t SCPI_ParamArrayUInt64(scpi_t * context, uint64_t *data, size_t i_count, size_t *o_count, scpi_array_format_t format, scpi_bool_t mandatory);
     scpi_bool_t SCPI_ParamArrayFloat(scpi_t * context, float *data, size_t i_count, size_t *o_count, scpi_array_format_t format, scpi_bool_t mandatory);
     scpi_bool_t SCPI_ParamArrayDouble(scpi_t * context, double *data, size_t i_count, size_t *o_count, scpi_array_format_t format, scpi_bool_t mandatory);
+    scpi_bool_t SCPI_ParamArrayHalf(scpi_t * context, float *data, size_t i_count, size_t *o_count, scpi_array_format_t format, scpi_bool_t mandatory);
+    scpi_bool_t SCPI_ParamArrayPackedInt32(scpi_t * context, int32_t *data, size_t i_count, size_t *o_count, size_t bits, scpi_array_format_t format, scpi_bool_t mandatory);
+    scpi_bool_t SCPI_ParamArrayPackedUInt32(scpi_t * context, uint32_t *data, size_t i_count, size_t *o_count, size_t bits, scpi_array_format_t format, scpi_bool_t mandatory);
 
     scpi_bool_t SCPI_IsCmd(scpi_t * context, const char * cmd);
 #if USE_COMMAND_TAGS
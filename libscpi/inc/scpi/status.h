@@ -0,0 +1,63 @@
+/*-
+ * BSD 2-Clause License
+ *
+ * Copyright (c) 2012-2018, Jan Breuer
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * * Redistributions of source code must retain the above copyright notice, this
+ *   list of conditions and the following disclaimer.
+ *
+ * * Redistributions in binary form must reproduce the above copyright notice,
+ *   this list of conditions and the following disclaimer in the documentation
+ *   and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+
+/**
+ * @file   status.h
+ *
+ * @brief  Status register tree of instrument subsystems and channels
+ *
+ *
+ */
+#ifndef SCPI_STATUS_H
+#define SCPI_STATUS_H
+
+#include "scpi/config.h"
+#include "scpi/types.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+    scpi_bool_t SCPI_StatusTreeInit(scpi_t * context, const scpi_status_node_def_t * defs, size_t defs_count, scpi_status_node_t * nodes, size_t nodes_count, uint32_t * bitmap, size_t bitmap_words);
+    uint16_t SCPI_StatusNode(scpi_t * context, uint16_t def, uint16_t instance);
+
+    scpi_reg_val_t SCPI_StatusGet(scpi_t * context, uint16_t node, scpi_reg_class_t type);
+    void SCPI_StatusSet(scpi_t * context, uint16_t node, scpi_reg_class_t type, scpi_reg_val_t val);
+    void SCPI_StatusSetConditions(scpi_t * context, const scpi_status_condition_t * conditions, size_t count);
+    size_t SCPI_StatusEventsRead(scpi_t * context, uint16_t first, scpi_reg_val_t * values, size_t count);
+    size_t SCPI_StatusSummaryNext(scpi_t * context, uint16_t node, size_t start);
+
+    void SCPI_StatusTreeClear(scpi_t * context);
+    void SCPI_StatusTreePreset(scpi_t * context);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* SCPI_STATUS_H */
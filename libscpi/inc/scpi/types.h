@@ -42,6 +42,10 @@
 #include <stdint.h>
 #include "scpi/config.h"
 
+#if USE_ATOMIC_ERROR_QUEUE || USE_ATOMIC_REGISTERS
+#include <stdatomic.h>
+#endif
+
 #if HAVE_STDBOOL
 #include <stdbool.h>
 #endif
@@ -77,6 +81,10 @@ extern "C" {
         SCPI_REG_QUES, /* QUEStionable status register */
         SCPI_REG_QUESE, /* QUEStionable status Enable Register */
         SCPI_REG_QUESC, /* QUEStionable status Condition Register */
+        SCPI_REG_OPERP, /* OPERation status Positive transition filter */
+        SCPI_REG_OPERN, /* OPERation status Negative transition filter */
+        SCPI_REG_QUESP, /* QUEStionable status Positive transition filter */
+        SCPI_REG_QUESN, /* QUEStionable status Negative transition filter */
 
 #if USE_CUSTOM_REGISTERS
 #ifndef USER_REGISTERS
@@ -162,10 +170,70 @@ extern "C" {
     };
     typedef struct _scpi_reg_group_info_t scpi_reg_group_info_t;
 
+    struct _scpi_reg_condition_t {
+        scpi_reg_name_t name;
+        scpi_reg_val_t val;
+    };
+    typedef struct _scpi_reg_condition_t scpi_reg_condition_t;
+
+#define SCPI_STATUS_NODE_NONE 0xFFFF
+
+    enum _scpi_status_node_type_t {
+        SCPI_STATUS_NODE_REGISTER = 0,
+        SCPI_STATUS_NODE_SUMMARY,
+    };
+    typedef enum _scpi_status_node_type_t scpi_status_node_type_t;
+
+    /* declaration of one level of status tree */
+    struct _scpi_status_node_def_t {
+        scpi_status_node_type_t type;
+        /* register: number of instances, summary: number of summary bits */
+        uint16_t count;
+        /* index of parent definition or SCPI_STATUS_NODE_NONE */
+        uint16_t parent;
+        /* bit number in parent of the first instance */
+        uint16_t parent_bit;
+        /* condition register used for parent SCPI_STATUS_NODE_NONE */
+        scpi_reg_name_t parent_reg;
+    };
+    typedef struct _scpi_status_node_def_t scpi_status_node_def_t;
+
+    struct _scpi_status_node_t {
+        scpi_reg_val_t condition;
+        scpi_reg_val_t event;
+        scpi_reg_val_t enable;
+        scpi_reg_val_t ptfilt;
+        scpi_reg_val_t ntfilt;
+        uint16_t parent;
+        uint16_t parent_bit;
+        scpi_reg_name_t parent_reg;
+        /* summary node: bitmap of active children */
+        uint32_t * summary;
+        uint16_t size;
+        uint16_t active;
+    };
+    typedef struct _scpi_status_node_t scpi_status_node_t;
+
+    struct _scpi_status_condition_t {
+        uint16_t node;
+        scpi_reg_val_t val;
+    };
+    typedef struct _scpi_status_condition_t scpi_status_condition_t;
+
+    struct _scpi_status_tree_t {
+        const scpi_status_node_def_t * defs;
+        size_t defs_count;
+        scpi_status_node_t * nodes;
+        size_t nodes_count;
+    };
+    typedef struct _scpi_status_tree_t scpi_status_tree_t;
+
     /* scpi commands */
     enum _scpi_result_t {
         SCPI_RES_OK = 1,
-        SCPI_RES_ERR = -1
+        SCPI_RES_ERR = -1,
+        /* operation started by SCPI_OperationBegin continues after return */
+        SCPI_RES_PENDING = 2
     };
     typedef enum _scpi_result_t scpi_result_t;
 
@@ -196,10 +264,29 @@ extern "C" {
     };
     typedef struct _scpi_const_buffer_t scpi_const_buffer_t;
 
+    struct _scpi_iovec_t {
+        const char * data;
+        size_t len;
+    };
+    typedef struct _scpi_iovec_t scpi_iovec_t;
+
     typedef size_t(*scpi_write_t)(scpi_t * context, const char * data, size_t len);
+    typedef size_t(*scpi_writev_t)(scpi_t * context, const scpi_iovec_t * iov, size_t iovcnt);
+    typedef size_t(*scpi_sendfile_t)(scpi_t * context, int fd, int64_t offset, size_t len);
+    typedef char * (*scpi_reserve_t)(scpi_t * context, size_t len);
+    typedef size_t(*scpi_stream_producer_t)(scpi_t * context, void * user_data, char * buffer, size_t len);
+    typedef size_t(*scpi_commit_t)(scpi_t * context, char * data, size_t len);
     typedef scpi_result_t(*scpi_write_control_t)(scpi_t * context, scpi_ctrl_name_t ctrl, scpi_reg_val_t val);
     typedef int (*scpi_error_callback_t)(scpi_t * context, int_fast16_t error);
 
+    struct _scpi_error_count_t {
+        int16_t error_code;
+        uint16_t count;
+    };
+    typedef struct _scpi_error_count_t scpi_error_count_t;
+
+    typedef void (*scpi_error_batch_callback_t)(scpi_t * context, const scpi_error_count_t * errors, size_t count, size_t suppressed);
+
     /* scpi lexer */
     enum _scpi_token_type_t {
         SCPI_TOKEN_COMMA,
@@ -235,14 +322,14 @@ extern "C" {
     struct _scpi_token_t {
         scpi_token_type_t type;
         char * ptr;
-        int len;
+        size_t len;
     };
     typedef struct _scpi_token_t scpi_token_t;
 
     struct _lex_state_t {
         char * buffer;
         char * pos;
-        int len;
+        size_t len;
     };
     typedef struct _lex_state_t lex_state_t;
 
@@ -262,8 +349,48 @@ extern "C" {
     };
     typedef struct _scpi_parser_state_t scpi_parser_state_t;
 
+    /* overlapped commands in progress */
+    struct _scpi_operations_t {
+        /* one bit per operation handle */
+        uint32_t pending;
+        /* *OPC waits for completion */
+        scpi_bool_t opc;
+        /* *OPC? waits for completion */
+        scpi_bool_t opc_query;
+        /* parsing is paused by *WAI or *OPC? */
+        scpi_bool_t wait;
+        /* rest of the paused message */
+        char * data;
+        size_t len;
+        scpi_token_t cmd_prev;
+        scpi_bool_t result;
+        /* length of the paused message in the input buffer */
+        size_t input_len;
+        /* SCPI_Input with len=0 requested while parsing was paused */
+        scpi_bool_t input_flush;
+    };
+    typedef struct _scpi_operations_t scpi_operations_t;
+
     typedef scpi_result_t(*scpi_command_callback_t)(scpi_t *);
 
+#if USE_ERROR_INFO_RECORDS
+    struct _scpi_error_info_record_t {
+        struct _scpi_error_info_record_t * prev;
+        struct _scpi_error_info_record_t * next;
+        struct _scpi_error_info_record_t * alias;
+        uint16_t refs;
+        uint16_t len;
+        char text[SCPI_ERROR_INFO_RECORD_LENGTH];
+    };
+    typedef struct _scpi_error_info_record_t scpi_error_info_record_t;
+
+    struct _scpi_error_info_heap_t {
+        scpi_error_info_record_t * records;
+        scpi_error_info_record_t * free;
+        size_t size;
+        size_t count;
+    };
+#else
     struct _scpi_error_info_heap_t {
         size_t wr;
         /* size_t rd; */
@@ -271,25 +398,52 @@ extern "C" {
         size_t size;
         char * data;
     };
+#endif
     typedef struct _scpi_error_info_heap_t scpi_error_info_heap_t;
 
     struct _scpi_error_t {
         int16_t error_code;
 #if USE_DEVICE_DEPENDENT_ERROR_INFORMATION
         char * device_dependent_info;
+#endif
+#if USE_LAZY_ERROR_INFO
+        /* not yet copied info, valid until SCPI_Parse returns */
+        const char * pending_info;
+        uint16_t pending_info_len;
+#endif
+#if USE_ATOMIC_ERROR_QUEUE
+        /* state of the queue slot, not part of the error value */
+        atomic_uint sequence;
 #endif
     };
     typedef struct _scpi_error_t scpi_error_t;
 
     struct _scpi_fifo_t {
+#if USE_ATOMIC_ERROR_QUEUE
+        atomic_uint wr;
+        atomic_uint rd;
+#else
         int16_t wr;
         int16_t rd;
         int16_t count;
+#endif
         int16_t size;
         scpi_error_t * data;
     };
     typedef struct _scpi_fifo_t scpi_fifo_t;
 
+#if USE_ERROR_COALESCING
+    /* error callbacks waiting for the end of message */
+    struct _scpi_error_batch_t {
+        scpi_error_count_t errors[SCPI_ERROR_COALESCE_SIZE];
+        uint8_t used;
+        uint16_t suppressed;
+        scpi_bool_t active;
+        scpi_bool_t empty;
+    };
+    typedef struct _scpi_error_batch_t scpi_error_batch_t;
+#endif
+
     /* scpi units */
     enum _scpi_unit_t {
         SCPI_UNIT_NONE,
@@ -413,12 +567,44 @@ extern "C" {
 #endif /* USE_COMMAND_TAGS */
     };
 
+    struct _scpi_stream_t {
+        scpi_stream_producer_t producer;
+        void * user_data;
+        size_t remaining;
+        scpi_bool_t indefinite;
+        size_t terminator;
+        /* output buffered before the block, rest follows the block */
+        size_t head;
+    };
+    typedef struct _scpi_stream_t scpi_stream_t;
+
+    enum _scpi_data_type_t {
+        SCPI_DATA_ASCII = 0,
+        SCPI_DATA_INTEGER,
+        SCPI_DATA_REAL,
+        SCPI_DATA_COMPRESSED,
+    };
+    typedef enum _scpi_data_type_t scpi_data_type_t;
+
+    /* state of FORMat:DATA and FORMat:BORDer */
+    struct _scpi_data_format_t {
+        scpi_data_type_t type;
+        uint8_t length;
+        scpi_bool_t swapped;
+    };
+    typedef struct _scpi_data_format_t scpi_data_format_t;
+
     struct _scpi_interface_t {
         scpi_error_callback_t error;
         scpi_write_t write;
         scpi_write_control_t control;
         scpi_command_callback_t flush;
         scpi_command_callback_t reset;
+        scpi_reserve_t reserve;
+        scpi_commit_t commit;
+        scpi_writev_t writev;
+        scpi_sendfile_t sendfile;
+        scpi_error_batch_callback_t error_batch;
     };
 
     struct _scpi_t {
@@ -431,15 +617,46 @@ extern "C" {
         scpi_bool_t first_output;
         scpi_bool_t cmd_error;
         scpi_fifo_t error_queue;
+#if USE_ATOMIC_ERROR_QUEUE
+        /* errors pushed by other threads, applied by the parser thread */
+        scpi_fifo_t error_async_queue;
+        atomic_bool error_async_pending;
+#endif
 #if USE_DEVICE_DEPENDENT_ERROR_INFORMATION && !USE_MEMORY_ALLOCATION_FREE
         scpi_error_info_heap_t error_info_heap;
 #endif
+#if USE_LAZY_ERROR_INFO
+        int16_t error_info_pending;
+#endif
+#if USE_ERROR_COALESCING
+        scpi_error_batch_t error_batch;
+#endif
+        uint32_t * error_counters;
+        size_t error_counters_size;
+#if USE_ATOMIC_REGISTERS
+        _Atomic scpi_reg_val_t registers[SCPI_REG_COUNT];
+#else
         scpi_reg_val_t registers[SCPI_REG_COUNT];
+#endif
+#if USE_SRQ_COALESCING && USE_ATOMIC_REGISTERS
+        atomic_bool srq_pending;
+#elif USE_SRQ_COALESCING
+        scpi_bool_t srq_pending;
+#endif
+        scpi_status_tree_t status_tree;
         const scpi_unit_def_t * units;
         void * user_context;
         scpi_parser_state_t parser_state;
+        scpi_operations_t operations;
         const char * idn[4];
         size_t arbitrary_remaining;
+        scpi_buffer_t output_buffer;
+        scpi_bool_t output_discard;
+        char * output_reserved;
+        size_t output_reserved_len;
+        scpi_stream_t stream;
+        scpi_bool_t output_indefinite;
+        scpi_data_format_t data_format;
     };
 
     enum _scpi_array_format_t {
@@ -448,6 +665,8 @@ extern "C" {
         SCPI_FORMAT_SWAPPED = 2,
         SCPI_FORMAT_BIGENDIAN = SCPI_FORMAT_NORMAL,
         SCPI_FORMAT_LITTLEENDIAN = SCPI_FORMAT_SWAPPED,
+        /* delta + zigzag + varint coded items in self-describing block */
+        SCPI_FORMAT_COMPRESSED = 3,
     };
     typedef enum _scpi_array_format_t scpi_array_format_t;
 
@@ -50,6 +50,8 @@ extern "C" {
     size_t SCPI_Int64ToStr(int64_t val, char * str, size_t len);
     size_t SCPI_FloatToStr(float val, char * str, size_t len);
     size_t SCPI_DoubleToStr(double val, char * str, size_t len);
+    uint16_t SCPI_FloatToHalf(float val);
+    float SCPI_HalfToFloat(uint16_t val);
 
     /* deprecated finction, should be removed later */
 #define SCPI_LongToStr(val, str, len, base) SCPI_Int32ToStr((val), (str), (len), (base), TRUE)
@@ -40,9 +40,12 @@
 #include "scpi/ieee488.h"
 #include "scpi/error.h"
 #include "fifo_private.h"
+#include "parser_private.h"
 #include "scpi/constants.h"
 
-#if USE_DEVICE_DEPENDENT_ERROR_INFORMATION
+#if USE_LAZY_ERROR_INFO
+#define SCPI_ERROR_SETVAL(e, c, i) do { (e)->error_code = (c); (e)->device_dependent_info = (i); (e)->pending_info = NULL; (e)->pending_info_len = 0; } while(0)
+#elif USE_DEVICE_DEPENDENT_ERROR_INFORMATION
 #define SCPI_ERROR_SETVAL(e, c, i) do { (e)->error_code = (c); (e)->device_dependent_info = (i); } while(0)
 #else
 #define SCPI_ERROR_SETVAL(e, c, i) do { (e)->error_code = (c); (void)(i);} while(0)
@@ -56,6 +59,98 @@ void SCPI_ErrorInit(scpi_t * context, scpi_error_t * data, int16_t size) {
     fifo_init(&context->error_queue, data, size);
 }
 
+#if USE_ATOMIC_ERROR_QUEUE
+/**
+ * Initialize queue of errors pushed by SCPI_ErrorPushAsync
+ * @param context - scpi context
+ * @param data - storage for the queue
+ * @param size - number of entries
+ */
+void SCPI_ErrorAsyncInit(scpi_t * context, scpi_error_t * data, int16_t size) {
+    fifo_init(&context->error_async_queue, data, size);
+    atomic_init(&context->error_async_pending, false);
+}
+#endif
+
+#if USE_ERROR_COALESCING
+/**
+ * Count error in the batch waiting for end of message
+ * @param batch
+ * @param err Error to count
+ */
+static void SCPI_ErrorBatchAdd(scpi_error_batch_t * batch, int16_t err) {
+    uint8_t i;
+
+    for (i = 0; i < batch->used; i++) {
+        if (batch->errors[i].error_code == err) {
+            if (batch->errors[i].count < UINT16_MAX) {
+                batch->errors[i].count++;
+            }
+            return;
+        }
+    }
+
+    if (batch->used < SCPI_ERROR_COALESCE_SIZE) {
+        batch->errors[batch->used].error_code = err;
+        batch->errors[batch->used].count = 1;
+        batch->used++;
+    } else if (batch->suppressed < UINT16_MAX) {
+        batch->suppressed++;
+    }
+}
+
+/**
+ * Start collecting error callbacks instead of calling them immediately
+ * @param context
+ */
+void SCPI_ErrorBatchBegin(scpi_t * context) {
+    context->error_batch.used = 0;
+    context->error_batch.suppressed = 0;
+    context->error_batch.empty = FALSE;
+    context->error_batch.active = TRUE;
+}
+
+/**
+ * Deliver collected errors in one error_batch callback. Empty queue is
+ * reported last if the queue is still empty.
+ * @param context
+ */
+void SCPI_ErrorBatchEnd(scpi_t * context) {
+    scpi_error_batch_t * batch = &context->error_batch;
+
+    if (!batch->active) {
+        return;
+    }
+    batch->active = FALSE;
+
+    if (context->interface && context->interface->error_batch) {
+        if (batch->used || batch->suppressed) {
+            context->interface->error_batch(context, batch->errors, batch->used, batch->suppressed);
+        }
+    }
+
+    if (batch->empty && (SCPI_ErrorCount(context) == 0)) {
+        if (context->interface && context->interface->error) {
+            context->interface->error(context, 0);
+        }
+    }
+
+    batch->used = 0;
+    batch->suppressed = 0;
+    batch->empty = FALSE;
+}
+
+/**
+ * Check if error callbacks are collected. Without error_batch callback,
+ * errors are reported immediately, once per occurrence.
+ * @param context
+ * @return TRUE if errors are collected till SCPI_ErrorBatchEnd
+ */
+static scpi_bool_t isErrorBatchActive(scpi_t * context) {
+    return context->error_batch.active && context->interface && context->interface->error_batch;
+}
+#endif /* USE_ERROR_COALESCING */
+
 /**
  * Emit no error
  * @param context scpi context
@@ -64,6 +159,13 @@ static void SCPI_ErrorEmitEmpty(scpi_t * context) {
     if ((SCPI_ErrorCount(context) == 0) && (SCPI_RegGet(context, SCPI_REG_STB) & STB_QMA)) {
         SCPI_RegClearBits(context, SCPI_REG_STB, STB_QMA);
 
+#if USE_ERROR_COALESCING
+        if (isErrorBatchActive(context)) {
+            context->error_batch.empty = TRUE;
+            return;
+        }
+#endif
+
         if (context->interface && context->interface->error) {
             context->interface->error(context, 0);
         }
@@ -78,6 +180,13 @@ static void SCPI_ErrorEmitEmpty(scpi_t * context) {
 static void SCPI_ErrorEmit(scpi_t * context, int16_t err) {
     SCPI_RegSetBits(context, SCPI_REG_STB, STB_QMA);
 
+#if USE_ERROR_COALESCING
+    if (isErrorBatchActive(context)) {
+        SCPI_ErrorBatchAdd(&context->error_batch, err);
+        return;
+    }
+#endif
+
     if (context->interface && context->interface->error) {
         context->interface->error(context, err);
     }
@@ -88,11 +197,17 @@ static void SCPI_ErrorEmit(scpi_t * context, int16_t err) {
  * @param context - scpi context
  */
 void SCPI_ErrorClear(scpi_t * context) {
+#if USE_ATOMIC_ERROR_QUEUE
+    SCPI_ErrorAsyncApply(context);
+#endif
 #if USE_DEVICE_DEPENDENT_ERROR_INFORMATION
     scpi_error_t error;
     while (fifo_remove(&context->error_queue, &error)) {
         SCPIDEFINE_free(&context->error_info_heap, error.device_dependent_info, false);
     }
+#endif
+#if USE_LAZY_ERROR_INFO
+    context->error_info_pending = 0;
 #endif
     fifo_clear(&context->error_queue);
 
@@ -107,8 +222,24 @@ void SCPI_ErrorClear(scpi_t * context) {
  */
 scpi_bool_t SCPI_ErrorPop(scpi_t * context, scpi_error_t * error) {
     if (!error || !context) return FALSE;
+#if USE_ATOMIC_ERROR_QUEUE
+    SCPI_ErrorAsyncApply(context);
+#endif
     SCPI_ERROR_SETVAL(error, 0, NULL);
     fifo_remove(&context->error_queue, error);
+#if USE_LAZY_ERROR_INFO
+    /* pending info of popped error is still valid until SCPI_Parse returns */
+    if (error->pending_info) {
+        context->error_info_pending--;
+    }
+#endif
+#if USE_ATOMIC_ERROR_QUEUE && USE_DEVICE_DEPENDENT_ERROR_INFORMATION
+    /* entry replaced by overflow still holds its original info */
+    if (error->error_code == SCPI_ERROR_QUEUE_OVERFLOW) {
+        SCPIDEFINE_free(&context->error_info_heap, error->device_dependent_info, false);
+        error->device_dependent_info = NULL;
+    }
+#endif
 
     SCPI_ErrorEmitEmpty(context);
 
@@ -123,85 +254,336 @@ scpi_bool_t SCPI_ErrorPop(scpi_t * context, scpi_error_t * error) {
 int32_t SCPI_ErrorCount(scpi_t * context) {
     int16_t result = 0;
 
+#if USE_ATOMIC_ERROR_QUEUE
+    SCPI_ErrorAsyncApply(context);
+#endif
     fifo_count(&context->error_queue, &result);
 
     return result;
 }
 
-static scpi_bool_t SCPI_ErrorAddInternal(scpi_t * context, int16_t err, char * info, size_t info_len) {
-    scpi_error_t error_value;
-    /* SCPIDEFINE_strndup is sometimes a dumy that does not reference it's arguments. 
-       Since info_len is not referenced elsewhere caoing to void prevents unusd argument warnings */
-    (void) info_len;
-    char * info_ptr = NULL;
-    if (info) {
-        info_ptr = SCPIDEFINE_strndup(&context->error_info_heap, info, info_len);
-    }
-    SCPI_ERROR_SETVAL(&error_value, err, info_ptr);
-    if (!fifo_add(&context->error_queue, &error_value)) {
-        SCPIDEFINE_free(&context->error_info_heap, error_value.device_dependent_info, true);
-        fifo_remove_last(&context->error_queue, &error_value);
-        SCPIDEFINE_free(&context->error_info_heap, error_value.device_dependent_info, true);
-        SCPI_ERROR_SETVAL(&error_value, SCPI_ERROR_QUEUE_OVERFLOW, NULL);
-        fifo_add(&context->error_queue, &error_value);
+static scpi_bool_t SCPI_ErrorAddInternal(scpi_t * context, scpi_error_t * error_value) {
+    if (!fifo_add(&context->error_queue, error_value)) {
+        SCPIDEFINE_free(&context->error_info_heap, error_value->device_dependent_info, true);
+#if USE_ATOMIC_ERROR_QUEUE
+        /* last entry is already marked as overflow by fifo_add */
+#else
+        fifo_remove_last(&context->error_queue, error_value);
+        SCPIDEFINE_free(&context->error_info_heap, error_value->device_dependent_info, true);
+#if USE_LAZY_ERROR_INFO
+        if (error_value->pending_info) {
+            context->error_info_pending--;
+        }
+#endif
+        SCPI_ERROR_SETVAL(error_value, SCPI_ERROR_QUEUE_OVERFLOW, NULL);
+        fifo_add(&context->error_queue, error_value);
+#endif
         return FALSE;
     }
+#if USE_LAZY_ERROR_INFO
+    if (error_value->pending_info) {
+        context->error_info_pending++;
+    }
+#endif
     return TRUE;
 }
 
-struct error_reg {
-    int16_t from;
-    int16_t to;
-    scpi_reg_val_t esrBit;
+/* ESR bit of errors -100 to -899 indexed by hundreds */
+static const scpi_reg_val_t esr_bits[8] = {
+    ESR_CER, /* Command error (e.g. syntax error) ch 21.8.9    */
+    ESR_EER, /* Execution Error (e.g. range error) ch 21.8.10  */
+    ESR_DER, /* Device specific error -300, -399 ch 21.8.11    */
+    ESR_QER, /* Query error -400, -499 ch 21.8.12              */
+    ESR_PON, /* Power on event -500, -599 ch 21.8.13           */
+    ESR_URQ, /* User Request Event -600, -699 ch 21.8.14       */
+    ESR_REQ, /* Request Control Event -700, -799 ch 21.8.15    */
+    ESR_OPC, /* Operation Complete Event -800, -899 ch 21.8.16 */
 };
 
-#define ERROR_DEFS_N 9
-
-static const struct error_reg errs[ERROR_DEFS_N] = {
-    {-100, -199, ESR_CER}, /* Command error (e.g. syntax error) ch 21.8.9    */
-    {-200, -299, ESR_EER}, /* Execution Error (e.g. range error) ch 21.8.10  */
-    {-300, -399, ESR_DER}, /* Device specific error -300, -399 ch 21.8.11    */
-    { 1, 32767, ESR_DER}, /* Device designer provided specific error 1, 32767 ch 21.8.11    */
-    {-400, -499, ESR_QER}, /* Query error -400, -499 ch 21.8.12              */
-    {-500, -599, ESR_PON}, /* Power on event -500, -599 ch 21.8.13           */
-    {-600, -699, ESR_URQ}, /* User Request Event -600, -699 ch 21.8.14       */
-    {-700, -799, ESR_REQ}, /* Request Control Event -700, -799 ch 21.8.15    */
-    {-800, -899, ESR_OPC}, /* Operation Complete Event -800, -899 ch 21.8.16 */
+/**
+ * Get ESR bit of error
+ * @param err - error number
+ * @return ESR bit or 0
+ */
+static scpi_reg_val_t errorEsrBit(int16_t err) {
+    if (err > 0) {
+        /* Device designer provided specific error 1, 32767 ch 21.8.11 */
+        return ESR_DER;
+    }
+    if ((err <= -100) && (err >= -899)) {
+        return esr_bits[(-err) / 100 - 1];
+    }
+    return 0;
+}
+
+/* position of error counter */
+enum {
+#define X(def, val, str) def##_COUNTER,
+#if USE_FULL_ERROR_LIST
+#define XE X
+#else
+#define XE(def, val, str)
+#endif
+    LIST_OF_ERRORS
+
+#if USE_USER_ERROR_LIST
+    LIST_OF_USER_ERRORS
+#endif
+#undef X
+#undef XE
+    OTHER_ERRORS_COUNTER
 };
 
 /**
- * Push error to queue
- * @param context
+ * Get position of error counter
  * @param err - error number
- * @param info - additional text information or NULL for no text
- * @param info_len - length of text or 0 for automatic length
+ * @return index to counters
  */
-void SCPI_ErrorPushEx(scpi_t * context, int16_t err, char * info, size_t info_len) {
-    int i;
-    /* automatic calculation of length */
-    if (info && info_len == 0) {
-        info_len = SCPIDEFINE_strnlen(info, SCPI_STD_ERROR_DESC_MAX_STRING_LENGTH);
+static size_t errorCounterIndex(int16_t err) {
+    switch (err) {
+#define X(def, val, str) case def: return def##_COUNTER;
+#if USE_FULL_ERROR_LIST
+#define XE X
+#else
+#define XE(def, val, str)
+#endif
+        LIST_OF_ERRORS
+
+#if USE_USER_ERROR_LIST
+        LIST_OF_USER_ERRORS
+#endif
+#undef X
+#undef XE
+        default: return OTHER_ERRORS_COUNTER;
     }
-    scpi_bool_t queue_overflow = !SCPI_ErrorAddInternal(context, err, info, info_len);
+}
 
-    for (i = 0; i < ERROR_DEFS_N; i++) {
-        if ((err <= errs[i].from) && (err >= errs[i].to)) {
-            SCPI_RegSetBits(context, SCPI_REG_ESR, errs[i].esrBit);
+/**
+ * Count error occurrence
+ * @param context
+ * @param err - error number
+ */
+static void errorCount(scpi_t * context, int16_t err) {
+    size_t i;
+
+    if (context->error_counters) {
+        i = errorCounterIndex(err);
+        if (i < context->error_counters_size) {
+            context->error_counters[i]++;
         }
     }
+}
+
+/**
+ * Initialize per error code counters. Errors not in the error lists share
+ * the last counter, which is read by SCPI_ErrorCounterOtherGet.
+ * @param context
+ * @param counters - storage for SCPI_ERROR_COUNTERS_SIZE counters
+ * @param size - number of counters
+ */
+void SCPI_ErrorCountersInit(scpi_t * context, uint32_t * counters, size_t size) {
+    context->error_counters = counters;
+    context->error_counters_size = counters ? size : 0;
+    SCPI_ErrorCountersClear(context);
+}
+
+/**
+ * Reset all error counters to zero
+ * @param context
+ */
+void SCPI_ErrorCountersClear(scpi_t * context) {
+    size_t i;
+
+    for (i = 0; i < context->error_counters_size; i++) {
+        context->error_counters[i] = 0;
+    }
+}
+
+/**
+ * Get number of occurrences of error since initialization or last clear
+ * @param context
+ * @param err - error number
+ * @return number of occurrences, 0 for errors not in the error lists
+ */
+uint32_t SCPI_ErrorCounterGet(scpi_t * context, int16_t err) {
+    size_t i = errorCounterIndex(err);
+
+    if ((i != OTHER_ERRORS_COUNTER) && (i < context->error_counters_size)) {
+        return context->error_counters[i];
+    }
+    return 0;
+}
+
+/**
+ * Get number of occurrences of all errors not in the error lists since
+ * initialization or last clear
+ * @param context
+ * @return number of occurrences
+ */
+uint32_t SCPI_ErrorCounterOtherGet(scpi_t * context) {
+    if (OTHER_ERRORS_COUNTER < context->error_counters_size) {
+        return context->error_counters[OTHER_ERRORS_COUNTER];
+    }
+    return 0;
+}
+
+/**
+ * Add prepared error value to queue and update status, counters and
+ * callbacks
+ * @param context
+ * @param error_value
+ */
+static void SCPI_ErrorQueueValue(scpi_t * context, scpi_error_t * error_value) {
+    int16_t err = error_value->error_code;
+    scpi_reg_val_t esr_bit = errorEsrBit(err);
+    scpi_bool_t queue_overflow = !SCPI_ErrorAddInternal(context, error_value);
+
+    if (esr_bit) {
+        SCPI_RegSetBits(context, SCPI_REG_ESR, esr_bit);
+    }
 
+    errorCount(context, err);
     SCPI_ErrorEmit(context, err);
     if (queue_overflow) {
+        errorCount(context, SCPI_ERROR_QUEUE_OVERFLOW);
         SCPI_ErrorEmit(context, SCPI_ERROR_QUEUE_OVERFLOW);
     }
+}
+
+/**
+ * Push prepared error value to queue and mark the current command as failed
+ * @param context
+ * @param error_value
+ */
+static void SCPI_ErrorPushValue(scpi_t * context, scpi_error_t * error_value) {
+    SCPI_ErrorQueueValue(context, error_value);
 
     if (context) {
         context->cmd_error = TRUE;
     }
 }
 
+#if USE_ATOMIC_ERROR_QUEUE
+/**
+ * Push error from other thread or interrupt handler. The error is only
+ * queued, it is moved to the error queue together with ESR, STB, counters
+ * and callbacks by the parser thread in SCPI_ErrorAsyncApply. If the queue
+ * of SCPI_ErrorAsyncInit is full, its last entry is replaced by
+ * SCPI_ERROR_QUEUE_OVERFLOW.
+ * @param context - scpi context
+ * @param err - error number
+ * @return FALSE - error was not queued
+ */
+scpi_bool_t SCPI_ErrorPushAsync(scpi_t * context, int16_t err) {
+    scpi_error_t error_value;
+    scpi_bool_t result;
+
+    if (!context->error_async_queue.data) {
+        return FALSE;
+    }
+
+    SCPI_ERROR_SETVAL(&error_value, err, NULL);
+    result = fifo_add(&context->error_async_queue, &error_value);
+    atomic_store_explicit(&context->error_async_pending, true, memory_order_release);
+    return result;
+}
+
+/**
+ * Move errors pushed by SCPI_ErrorPushAsync to the error queue. Called by
+ * SCPI_Parse, SCPI_ErrorPop, SCPI_ErrorCount and SCPI_ErrorClear, it can be
+ * called by the application to update status byte while the parser is idle.
+ * Must be called by the parser thread.
+ * @param context - scpi context
+ */
+void SCPI_ErrorAsyncApply(scpi_t * context) {
+    scpi_error_t error_value;
+    int16_t err;
+
+    if (!atomic_exchange_explicit(&context->error_async_pending, false, memory_order_acquire)) {
+        return;
+    }
+
+    while (fifo_remove(&context->error_async_queue, &error_value)) {
+        err = error_value.error_code;
+        SCPI_ERROR_SETVAL(&error_value, err, NULL);
+        SCPI_ErrorQueueValue(context, &error_value);
+    }
+}
+#endif
+
+/**
+ * Push error to queue, must be called by the parser thread
+ * @param context
+ * @param err - error number
+ * @param info - additional text information or NULL for no text
+ * @param info_len - length of text or 0 for automatic length
+ */
+void SCPI_ErrorPushEx(scpi_t * context, int16_t err, char * info, size_t info_len) {
+    scpi_error_t error_value;
+    char * info_ptr = NULL;
+    /* automatic calculation of length */
+    if (info && info_len == 0) {
+        info_len = SCPIDEFINE_strnlen(info, SCPI_STD_ERROR_DESC_MAX_STRING_LENGTH);
+    }
+    /* SCPIDEFINE_strndup is sometimes a dumy that does not reference it's arguments. 
+       Since info_len is not referenced elsewhere caoing to void prevents unusd argument warnings */
+    (void) info_len;
+    if (info) {
+        info_ptr = SCPIDEFINE_strndup(&context->error_info_heap, info, info_len);
+    }
+    SCPI_ERROR_SETVAL(&error_value, err, info_ptr);
+    SCPI_ErrorPushValue(context, &error_value);
+}
+
+#if USE_LAZY_ERROR_INFO
+/**
+ * Push error to queue with info referencing the parsed input. The info is
+ * copied by scpiError_materialize before the input can be reused.
+ * @param context
+ * @param err - error number
+ * @param info - text in the input buffer
+ * @param info_len - length of text
+ */
+void scpiError_pushLazy(scpi_t * context, int16_t err, const char * info, size_t info_len) {
+    scpi_error_t error_value;
+
+    if (info_len > SCPI_STD_ERROR_DESC_MAX_STRING_LENGTH) {
+        info_len = SCPI_STD_ERROR_DESC_MAX_STRING_LENGTH;
+    }
+    SCPI_ERROR_SETVAL(&error_value, err, NULL);
+    if (info && info_len > 0) {
+        error_value.pending_info = info;
+        error_value.pending_info_len = (uint16_t) info_len;
+    }
+    SCPI_ErrorPushValue(context, &error_value);
+}
+
+/**
+ * Copy info of all queued errors that still reference the input
+ * @param context
+ */
+void scpiError_materialize(scpi_t * context) {
+    int16_t i;
+    scpi_error_t * error;
+
+    for (i = 0; context->error_info_pending > 0; i++) {
+        error = fifo_peek_ptr(&context->error_queue, i);
+        if (!error) {
+            break;
+        }
+        if (error->pending_info) {
+            error->device_dependent_info = SCPIDEFINE_strndup(&context->error_info_heap, error->pending_info, error->pending_info_len);
+            error->pending_info = NULL;
+            error->pending_info_len = 0;
+            context->error_info_pending--;
+        }
+    }
+    context->error_info_pending = 0;
+}
+#endif /* USE_LAZY_ERROR_INFO */
+
 /**
- * Push error to queue
+ * Push error to queue, must be called by the parser thread
  * @param context - scpi context
  * @param err - error number
  */
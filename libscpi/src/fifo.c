@@ -28,6 +28,214 @@
 
 #include "fifo_private.h"
 
+#if USE_ATOMIC_ERROR_QUEUE
+#include "scpi/error.h"
+
+/*
+ * Bounded multi-producer single-consumer ring. Every slot has a sequence
+ * number: position p is free for writing when sequence == p and ready for
+ * reading when sequence == p + 1. Producers claim positions by CAS on wr,
+ * only the consumer moves rd. When the ring is full, the producer moves the
+ * last entry to the overflow state p - 2 * size or p + 1 - 2 * size by CAS
+ * on its sequence, so the mark can not be lost while the consumer takes the
+ * entry. The consumer reads marked entry as SCPI_ERROR_QUEUE_OVERFLOW, so
+ * the overflow replaces the last entry as in the single thread variant.
+ *
+ * Size is rounded down to power of two, so slot index stays continuous
+ * when the positions wrap around.
+ */
+
+#define FIFO_INDEX(fifo, pos) ((pos) & ((unsigned) (fifo)->size - 1))
+#define FIFO_OVERFLOW(fifo) (2 * (unsigned) (fifo)->size)
+
+/**
+ * Initialize fifo
+ * @param fifo
+ */
+void fifo_init(scpi_fifo_t * fifo, scpi_error_t * data, int16_t size) {
+    int16_t i;
+
+    while (size & (size - 1)) {
+        size &= size - 1;
+    }
+
+    fifo->data = data;
+    fifo->size = size;
+    for (i = 0; i < size; i++) {
+        atomic_init(&data[i].sequence, (unsigned) i);
+    }
+    atomic_init(&fifo->wr, 0);
+    atomic_init(&fifo->rd, 0);
+}
+
+/**
+ * Empty fifo, must be called by the consumer
+ * @param fifo
+ */
+void fifo_clear(scpi_fifo_t * fifo) {
+    while (fifo_remove(fifo, NULL)) {
+    }
+}
+
+/**
+ * Test if fifo is empty
+ * @param fifo
+ * @return
+ */
+scpi_bool_t fifo_is_empty(scpi_fifo_t * fifo) {
+    int16_t count;
+    fifo_count(fifo, &count);
+    return count == 0;
+}
+
+/**
+ * Test if fifo is full
+ * @param fifo
+ * @return
+ */
+scpi_bool_t fifo_is_full(scpi_fifo_t * fifo) {
+    int16_t count;
+    fifo_count(fifo, &count);
+    return count == fifo->size;
+}
+
+/**
+ * Mark entry at position pos as replaced by overflow
+ * @param fifo
+ * @param pos - position of the last entry
+ * @return FALSE - entry was already taken by the consumer
+ */
+static scpi_bool_t fifo_mark_overflow(scpi_fifo_t * fifo, unsigned pos) {
+    scpi_error_t * slot = &fifo->data[FIFO_INDEX(fifo, pos)];
+    unsigned seq = atomic_load_explicit(&slot->sequence, memory_order_acquire);
+
+    for (;;) {
+        if ((seq == pos - FIFO_OVERFLOW(fifo)) || (seq == pos + 1 - FIFO_OVERFLOW(fifo))) {
+            return TRUE;
+        }
+        if ((seq != pos) && (seq != pos + 1)) {
+            return FALSE;
+        }
+        /* still being written or ready */
+        if (atomic_compare_exchange_weak_explicit(&slot->sequence, &seq, seq - FIFO_OVERFLOW(fifo), memory_order_acq_rel, memory_order_acquire)) {
+            return TRUE;
+        }
+    }
+}
+
+/**
+ * Add element to fifo, can be called from any thread. If fifo is full, the
+ * last entry is marked to be read as SCPI_ERROR_QUEUE_OVERFLOW.
+ * @param fifo
+ * @param value
+ * @return FALSE - fifo is full
+ */
+scpi_bool_t fifo_add(scpi_fifo_t * fifo, const scpi_error_t * value) {
+    unsigned pos;
+    unsigned seq;
+    scpi_error_t * slot;
+
+    if (!value) {
+        return FALSE;
+    }
+
+    pos = atomic_load_explicit(&fifo->wr, memory_order_relaxed);
+    for (;;) {
+        slot = &fifo->data[FIFO_INDEX(fifo, pos)];
+        seq = atomic_load_explicit(&slot->sequence, memory_order_acquire);
+        if (seq == pos) {
+            if (atomic_compare_exchange_weak_explicit(&fifo->wr, &pos, pos + 1, memory_order_relaxed, memory_order_relaxed)) {
+                break;
+            }
+        } else if (((int) (seq - pos) < 0) && (atomic_load_explicit(&fifo->wr, memory_order_relaxed) == pos)) {
+            if (fifo_mark_overflow(fifo, pos - 1)) {
+                return FALSE;
+            }
+            /* consumer made space meanwhile */
+            pos = atomic_load_explicit(&fifo->wr, memory_order_relaxed);
+        } else {
+            pos = atomic_load_explicit(&fifo->wr, memory_order_relaxed);
+        }
+    }
+
+    slot->error_code = value->error_code;
+#if USE_DEVICE_DEPENDENT_ERROR_INFORMATION
+    slot->device_dependent_info = value->device_dependent_info;
+#endif
+    seq = pos;
+    if (!atomic_compare_exchange_strong_explicit(&slot->sequence, &seq, pos + 1, memory_order_release, memory_order_relaxed)) {
+        /* marked by other producer while written */
+        atomic_store_explicit(&slot->sequence, pos + 1 - FIFO_OVERFLOW(fifo), memory_order_release);
+    }
+    return TRUE;
+}
+
+/**
+ * Remove element form fifo, must be called by the consumer
+ * @param fifo
+ * @param value
+ * @return FALSE - fifo is empty
+ */
+scpi_bool_t fifo_remove(scpi_fifo_t * fifo, scpi_error_t * value) {
+    unsigned pos = atomic_load_explicit(&fifo->rd, memory_order_relaxed);
+    scpi_error_t * slot = &fifo->data[FIFO_INDEX(fifo, pos)];
+    unsigned seq = atomic_load_explicit(&slot->sequence, memory_order_acquire);
+
+    if ((seq != pos + 1) && (seq != pos + 1 - FIFO_OVERFLOW(fifo))) {
+        return FALSE;
+    }
+
+    if (value) {
+        value->error_code = slot->error_code;
+#if USE_DEVICE_DEPENDENT_ERROR_INFORMATION
+        value->device_dependent_info = slot->device_dependent_info;
+#endif
+    }
+
+    if (!atomic_compare_exchange_strong_explicit(&slot->sequence, &seq, pos + (unsigned) fifo->size, memory_order_acq_rel, memory_order_acquire)) {
+        /* marked by producer while read, the mark is the only change */
+        atomic_store_explicit(&slot->sequence, pos + (unsigned) fifo->size, memory_order_release);
+    }
+
+    /* info of the replaced entry is left for the caller to free */
+    if (value && (seq == pos + 1 - FIFO_OVERFLOW(fifo))) {
+        value->error_code = SCPI_ERROR_QUEUE_OVERFLOW;
+    }
+
+    atomic_store_explicit(&fifo->rd, pos + 1, memory_order_release);
+    return TRUE;
+}
+
+/**
+ * Remove last element from fifo, not supported with concurrent producers
+ * @param fifo
+ * @param value
+ * @return FALSE
+ */
+scpi_bool_t fifo_remove_last(scpi_fifo_t * fifo, scpi_error_t * value) {
+    (void) fifo;
+    (void) value;
+    return FALSE;
+}
+
+/**
+ * Retrive number of elements in fifo, entries being written by producers
+ * are included
+ * @param fifo
+ * @param value
+ * @return
+ */
+scpi_bool_t fifo_count(scpi_fifo_t * fifo, int16_t * value) {
+    unsigned rd = atomic_load_explicit(&fifo->rd, memory_order_acquire);
+    unsigned wr = atomic_load_explicit(&fifo->wr, memory_order_acquire);
+    unsigned count = wr - rd;
+
+    *value = (int16_t) (count > (unsigned) fifo->size ? (unsigned) fifo->size : count);
+    return TRUE;
+}
+
+#else /* USE_ATOMIC_ERROR_QUEUE */
+
 /**
  * Initialize fifo
  * @param fifo
@@ -144,3 +352,19 @@ scpi_bool_t fifo_count(scpi_fifo_t * fifo, int16_t * value) {
     *value = fifo->count;
     return TRUE;
 }
+
+/**
+ * Get pointer to element in fifo
+ * @param fifo
+ * @param index - position counted from the oldest element
+ * @return NULL if there is no such element
+ */
+scpi_error_t * fifo_peek_ptr(scpi_fifo_t * fifo, int16_t index) {
+    if (index < 0 || index >= fifo->count) {
+        return NULL;
+    }
+
+    return &fifo->data[(fifo->rd + index) % (fifo->size)];
+}
+
+#endif /* USE_ATOMIC_ERROR_QUEUE */
@@ -53,6 +53,9 @@ extern "C" {
     scpi_bool_t fifo_remove(scpi_fifo_t * fifo, scpi_error_t * value) LOCAL;
     scpi_bool_t fifo_remove_last(scpi_fifo_t * fifo, scpi_error_t * value) LOCAL;
     scpi_bool_t fifo_count(scpi_fifo_t * fifo, int16_t * value) LOCAL;
+#if !USE_ATOMIC_ERROR_QUEUE
+    scpi_error_t * fifo_peek_ptr(scpi_fifo_t * fifo, int16_t index) LOCAL;
+#endif
 
 #ifdef	__cplusplus
 }
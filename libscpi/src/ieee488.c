@@ -39,6 +39,7 @@
 #include "scpi/ieee488.h"
 #include "scpi/error.h"
 #include "scpi/constants.h"
+#include "scpi/status.h"
 
 #include <stdio.h>
 
@@ -53,6 +54,10 @@ static const scpi_reg_info_t scpi_reg_details[SCPI_REG_COUNT] = {
     { SCPI_REG_CLASS_EVEN, SCPI_REG_GROUP_QUES },
     { SCPI_REG_CLASS_ENAB, SCPI_REG_GROUP_QUES },
     { SCPI_REG_CLASS_COND, SCPI_REG_GROUP_QUES },
+    { SCPI_REG_CLASS_PTR, SCPI_REG_GROUP_OPER },
+    { SCPI_REG_CLASS_NTR, SCPI_REG_GROUP_OPER },
+    { SCPI_REG_CLASS_PTR, SCPI_REG_GROUP_QUES },
+    { SCPI_REG_CLASS_NTR, SCPI_REG_GROUP_QUES },
 
 #if USE_CUSTOM_REGISTERS
 #ifndef USER_REGISTER_DETAILS
@@ -87,8 +92,8 @@ static const scpi_reg_group_info_t scpi_reg_group_details[SCPI_REG_GROUP_COUNT]
         SCPI_REG_OPER,
         SCPI_REG_OPERE,
         SCPI_REG_OPERC,
-        SCPI_REG_NONE,
-        SCPI_REG_NONE,
+        SCPI_REG_OPERP,
+        SCPI_REG_OPERN,
         SCPI_REG_STB,
         STB_OPS
     }, /* SCPI_REG_GROUP_OPER */
@@ -96,8 +101,8 @@ static const scpi_reg_group_info_t scpi_reg_group_details[SCPI_REG_GROUP_COUNT]
         SCPI_REG_QUES,
         SCPI_REG_QUESE,
         SCPI_REG_QUESC,
-        SCPI_REG_NONE,
-        SCPI_REG_NONE,
+        SCPI_REG_QUESP,
+        SCPI_REG_QUESN,
         SCPI_REG_STB,
         STB_QES
     }, /* SCPI_REG_GROUP_QUES */
@@ -119,12 +124,29 @@ static const scpi_reg_group_info_t scpi_reg_group_details[SCPI_REG_GROUP_COUNT]
  */
 scpi_reg_val_t SCPI_RegGet(scpi_t * context, scpi_reg_name_t name) {
     if ((name < SCPI_REG_COUNT) && context) {
+#if USE_ATOMIC_REGISTERS
+        return atomic_load(&context->registers[name]);
+#else
         return context->registers[name];
+#endif
     } else {
         return 0;
     }
 }
 
+/**
+ * Get register class
+ * @param name - register name
+ * @return class of register, e.g. SCPI_REG_CLASS_EVEN for event registers
+ */
+scpi_reg_class_t SCPI_RegClass(scpi_reg_name_t name) {
+    if (name < SCPI_REG_COUNT) {
+        return scpi_reg_details[name].type;
+    } else {
+        return SCPI_REG_CLASS_ENAB;
+    }
+}
+
 /**
  * Wrapper function to control interface from context
  * @param context
@@ -139,6 +161,216 @@ static size_t writeControl(scpi_t * context, scpi_ctrl_name_t ctrl, scpi_reg_val
     }
 }
 
+/**
+ * Request service by control callback or mark it pending
+ * @param context
+ * @param stb - value of status byte
+ */
+static void regServiceRequestNotify(scpi_t * context, scpi_reg_val_t stb) {
+#if USE_SRQ_COALESCING && USE_ATOMIC_REGISTERS
+    (void) stb;
+    atomic_store(&context->srq_pending, TRUE);
+#elif USE_SRQ_COALESCING
+    (void) stb;
+    context->srq_pending = TRUE;
+#else
+    writeControl(context, SCPI_CTRL_SRQ, stb);
+#endif
+}
+
+/**
+ * Deliver pending service request. Service is requested at least once for
+ * each rising request service since the last call.
+ * @param context
+ * @return TRUE if service was requested
+ */
+scpi_bool_t SCPI_RegServiceRequestFlush(scpi_t * context) {
+#if USE_SRQ_COALESCING
+    scpi_bool_t pending;
+
+    if (context == NULL) {
+        return FALSE;
+    }
+
+#if USE_ATOMIC_REGISTERS
+    pending = atomic_exchange(&context->srq_pending, FALSE);
+#else
+    pending = context->srq_pending;
+    context->srq_pending = FALSE;
+#endif
+
+    if (pending) {
+        writeControl(context, SCPI_CTRL_SRQ, SCPI_RegGet(context, SCPI_REG_STB));
+    }
+
+    return pending;
+#else
+    (void) context;
+    return FALSE;
+#endif
+}
+
+#if USE_ATOMIC_REGISTERS
+static void regPropagate(scpi_t * context, scpi_reg_name_t name, scpi_reg_val_t old_val, scpi_reg_val_t val, scpi_reg_val_t * deferred);
+
+/**
+ * Get summary of event register masked by enable register
+ * @param context
+ * @param register_group
+ * @return TRUE if any enabled event is set
+ */
+static scpi_bool_t regGroupSummary(scpi_t * context, const scpi_reg_group_info_t * register_group) {
+    scpi_reg_val_t enable = 0xFFFF;
+
+    if (register_group->enable != SCPI_REG_NONE) {
+        enable = atomic_load(&context->registers[register_group->enable]);
+    }
+
+    return (atomic_load(&context->registers[register_group->event]) & enable) ? TRUE : FALSE;
+}
+
+/**
+ * Update summary bit in parent register. Summary is evaluated again after
+ * the update, so concurrent change of the event register is never lost.
+ * @param context
+ * @param register_group
+ * @param deferred - accumulator of deferred service request or NULL
+ */
+static void regUpdateSummary(scpi_t * context, const scpi_reg_group_info_t * register_group, scpi_reg_val_t * deferred) {
+    _Atomic scpi_reg_val_t * parent;
+    scpi_reg_val_t old_val;
+    scpi_bool_t summary;
+
+    if (register_group->parent_reg == SCPI_REG_NONE) {
+        return;
+    }
+    parent = &context->registers[register_group->parent_reg];
+
+    do {
+        summary = regGroupSummary(context, register_group);
+        if (summary) {
+            old_val = atomic_fetch_or(parent, register_group->parent_bit);
+            regPropagate(context, register_group->parent_reg, old_val, old_val | register_group->parent_bit, deferred);
+        } else {
+            old_val = atomic_fetch_and(parent, (scpi_reg_val_t) ~register_group->parent_bit);
+            regPropagate(context, register_group->parent_reg, old_val, old_val & ~register_group->parent_bit, deferred);
+        }
+    } while (summary != regGroupSummary(context, register_group));
+}
+
+/**
+ * Get request service summary of status byte
+ * @param context
+ * @return TRUE if any bit of STB is enabled by SRE
+ */
+static scpi_bool_t regServiceRequest(scpi_t * context) {
+    scpi_reg_val_t stb = atomic_load(&context->registers[SCPI_REG_STB]) & ~STB_SRQ;
+    scpi_reg_val_t sre = atomic_load(&context->registers[SCPI_REG_SRE]) & ~STB_SRQ;
+
+    return (stb & sre) ? TRUE : FALSE;
+}
+
+/**
+ * Update SRQ bit of status byte and request service. Each positive
+ * transition of STB or SRE requests service once.
+ * @param context
+ * @param ptrans - bits changed from 0 to 1 by this update
+ */
+static void regUpdateServiceRequest(scpi_t * context, scpi_reg_val_t ptrans) {
+    _Atomic scpi_reg_val_t * stb = &context->registers[SCPI_REG_STB];
+    scpi_bool_t summary;
+
+    do {
+        summary = regServiceRequest(context);
+        if (summary) {
+            atomic_fetch_or(stb, STB_SRQ);
+            if (ptrans) {
+                regServiceRequestNotify(context, atomic_load(stb));
+                ptrans = 0;
+            }
+        } else {
+            atomic_fetch_and(stb, (scpi_reg_val_t) ~STB_SRQ);
+        }
+    } while (summary != regServiceRequest(context));
+}
+
+/**
+ * Propagate change of register value to related registers
+ * @param context
+ * @param name - register name
+ * @param old_val - value before atomic update
+ * @param val - value after atomic update
+ * @param deferred - accumulator of deferred service request or NULL
+ */
+static void regPropagate(scpi_t * context, scpi_reg_name_t name, scpi_reg_val_t old_val, scpi_reg_val_t val, scpi_reg_val_t * deferred) {
+    const scpi_reg_group_info_t * register_group = &scpi_reg_group_details[scpi_reg_details[name].group];
+    scpi_reg_val_t transitions = old_val ^ val;
+    scpi_reg_val_t ptrans = transitions & val;
+    scpi_reg_val_t ntrans = transitions & ~ptrans;
+    scpi_reg_val_t events;
+
+    if (transitions == 0) {
+        return;
+    }
+
+    switch (scpi_reg_details[name].type) {
+        case SCPI_REG_CLASS_STB:
+        case SCPI_REG_CLASS_SRE:
+            /* SRQ bit itself doesn't request service */
+            if (deferred) {
+                *deferred |= ptrans & ~STB_SRQ;
+                regUpdateServiceRequest(context, 0);
+            } else {
+                regUpdateServiceRequest(context, ptrans & ~STB_SRQ);
+            }
+            break;
+        case SCPI_REG_CLASS_EVEN:
+            regUpdateSummary(context, register_group, deferred);
+            break;
+        case SCPI_REG_CLASS_COND:
+            if (register_group->ptfilt == SCPI_REG_NONE && register_group->ntfilt == SCPI_REG_NONE) {
+                events = ptrans;
+            } else {
+                events = 0;
+                if (register_group->ptfilt != SCPI_REG_NONE) {
+                    events |= ptrans & atomic_load(&context->registers[register_group->ptfilt]);
+                }
+                if (register_group->ntfilt != SCPI_REG_NONE) {
+                    events |= ntrans & atomic_load(&context->registers[register_group->ntfilt]);
+                }
+            }
+            if (events) {
+                old_val = atomic_fetch_or(&context->registers[register_group->event], events);
+                regPropagate(context, register_group->event, old_val, old_val | events, deferred);
+            }
+            break;
+        case SCPI_REG_CLASS_ENAB:
+        case SCPI_REG_CLASS_NTR:
+        case SCPI_REG_CLASS_PTR:
+            break;
+    }
+}
+
+/**
+ * Set register value and propagate the change
+ * @param context
+ * @param name - register name
+ * @param val - new value
+ * @param deferred - accumulator of deferred service request or NULL
+ */
+static void regSet(scpi_t * context, scpi_reg_name_t name, scpi_reg_val_t val, scpi_reg_val_t * deferred) {
+    regPropagate(context, name, atomic_exchange(&context->registers[name], val), val, deferred);
+}
+
+/**
+ * Request service deferred by regSet
+ * @param context
+ * @param ptrans - accumulated positive transitions of STB and SRE
+ */
+static void regRequestService(scpi_t * context, scpi_reg_val_t ptrans) {
+    regUpdateServiceRequest(context, ptrans);
+}
+
 /**
  * Set register value
  * @param name - register name
@@ -149,6 +381,51 @@ void SCPI_RegSet(scpi_t * context, scpi_reg_name_t name, scpi_reg_val_t val) {
         return;
     }
 
+    regSet(context, name, val, NULL);
+}
+
+/**
+ * Set register bits
+ * @param name - register name
+ * @param bits bit mask
+ */
+void SCPI_RegSetBits(scpi_t * context, scpi_reg_name_t name, scpi_reg_val_t bits) {
+    scpi_reg_val_t old_val;
+
+    if ((name >= SCPI_REG_COUNT) || (context == NULL)) {
+        return;
+    }
+
+    old_val = atomic_fetch_or(&context->registers[name], bits);
+    regPropagate(context, name, old_val, old_val | bits, NULL);
+}
+
+/**
+ * Clear register bits
+ * @param name - register name
+ * @param bits bit mask
+ */
+void SCPI_RegClearBits(scpi_t * context, scpi_reg_name_t name, scpi_reg_val_t bits) {
+    scpi_reg_val_t old_val;
+
+    if ((name >= SCPI_REG_COUNT) || (context == NULL)) {
+        return;
+    }
+
+    old_val = atomic_fetch_and(&context->registers[name], (scpi_reg_val_t) ~bits);
+    regPropagate(context, name, old_val, old_val & ~bits, NULL);
+}
+
+#else /* USE_ATOMIC_REGISTERS */
+
+/**
+ * Set register value and propagate the change
+ * @param context
+ * @param name - register name
+ * @param val - new value
+ * @param deferred - accumulator of deferred service request or NULL
+ */
+static void regSet(scpi_t * context, scpi_reg_name_t name, scpi_reg_val_t val, scpi_reg_val_t * deferred) {
     scpi_reg_group_info_t register_group;
 
     do {
@@ -176,8 +453,10 @@ void SCPI_RegSet(scpi_t * context, scpi_reg_name_t name, scpi_reg_val_t val) {
                 if (stb & sre) {
                     ptrans = ((old_val ^ val) & val);
                     context->registers[SCPI_REG_STB] |= STB_SRQ;
-                    if (ptrans & val) {
-                        writeControl(context, SCPI_CTRL_SRQ, context->registers[SCPI_REG_STB]);
+                    if (deferred) {
+                        *deferred |= ptrans & val;
+                    } else if (ptrans & val) {
+                        regServiceRequestNotify(context, context->registers[SCPI_REG_STB]);
                     }
                 } else {
                     context->registers[SCPI_REG_STB] &= ~STB_SRQ;
@@ -239,6 +518,30 @@ void SCPI_RegSet(scpi_t * context, scpi_reg_name_t name, scpi_reg_val_t val) {
     } while(register_group.parent_reg != SCPI_REG_NONE);
 }
 
+/**
+ * Request service deferred by regSet
+ * @param context
+ * @param ptrans - accumulated positive transitions of STB and SRE
+ */
+static void regRequestService(scpi_t * context, scpi_reg_val_t ptrans) {
+    if (ptrans && (context->registers[SCPI_REG_STB] & STB_SRQ)) {
+        regServiceRequestNotify(context, context->registers[SCPI_REG_STB]);
+    }
+}
+
+/**
+ * Set register value
+ * @param name - register name
+ * @param val - new value
+ */
+void SCPI_RegSet(scpi_t * context, scpi_reg_name_t name, scpi_reg_val_t val) {
+    if ((name >= SCPI_REG_COUNT) || (context == NULL)) {
+        return;
+    }
+
+    regSet(context, name, val, NULL);
+}
+
 /**
  * Set register bits
  * @param name - register name
@@ -257,6 +560,50 @@ void SCPI_RegClearBits(scpi_t * context, scpi_reg_name_t name, scpi_reg_val_t bi
     SCPI_RegSet(context, name, SCPI_RegGet(context, name) & ~bits);
 }
 
+#endif /* USE_ATOMIC_REGISTERS */
+
+/**
+ * Set several registers at once, typically a snapshot of condition
+ * registers. Transitions of each register are filtered and propagated as
+ * by SCPI_RegSet, but service is requested at most once for whole snapshot.
+ * @param context
+ * @param conditions - array of register values
+ * @param count - number of items in conditions
+ */
+void SCPI_RegSetConditions(scpi_t * context, const scpi_reg_condition_t * conditions, size_t count) {
+    scpi_reg_val_t deferred = 0;
+    size_t i;
+
+    if ((context == NULL) || (conditions == NULL)) {
+        return;
+    }
+
+    for (i = 0; i < count; i++) {
+        if (conditions[i].name < SCPI_REG_COUNT) {
+            regSet(context, conditions[i].name, conditions[i].val, &deferred);
+        }
+    }
+
+    regRequestService(context, deferred);
+}
+
+/**
+ * Preset transition filters of all register groups. Positive transition
+ * filters pass all bits, negative transition filters pass none.
+ * @param context
+ */
+void SCPI_RegPresetFilters(scpi_t * context) {
+    int i;
+    for (i = 0; i < SCPI_REG_GROUP_COUNT; ++i) {
+        if (scpi_reg_group_details[i].ptfilt != SCPI_REG_NONE) {
+            SCPI_RegSet(context, scpi_reg_group_details[i].ptfilt, 0x7FFF);
+        }
+        if (scpi_reg_group_details[i].ntfilt != SCPI_REG_NONE) {
+            SCPI_RegSet(context, scpi_reg_group_details[i].ntfilt, 0);
+        }
+    }
+}
+
 /**
  * *CLS - This command clears all status data structures in a device. 
  *        For a device which minimally complies with SCPI. (SCPI std 4.1.3.2)
@@ -272,6 +619,9 @@ scpi_result_t SCPI_CoreCls(scpi_t * context) {
             SCPI_RegSet(context, event_reg, 0);
         }
     }
+    SCPI_StatusTreeClear(context);
+    /* operation complete command idle state */
+    context->operations.opc = FALSE;
     return SCPI_RES_OK;
 }
 
@@ -339,7 +689,12 @@ scpi_result_t SCPI_CoreIdnQ(scpi_t * context) {
  * @return 
  */
 scpi_result_t SCPI_CoreOpc(scpi_t * context) {
-    SCPI_RegSetBits(context, SCPI_REG_ESR, ESR_OPC);
+    if (SCPI_OperationPending(context)) {
+        /* ESR OPC is set by completion of the last operation */
+        context->operations.opc = TRUE;
+    } else {
+        SCPI_RegSetBits(context, SCPI_REG_ESR, ESR_OPC);
+    }
     return SCPI_RES_OK;
 }
 
@@ -349,8 +704,13 @@ scpi_result_t SCPI_CoreOpc(scpi_t * context) {
  * @return 
  */
 scpi_result_t SCPI_CoreOpcQ(scpi_t * context) {
-    /* Operation is always completed */
-    SCPI_ResultInt32(context, 1);
+    if (SCPI_OperationPending(context)) {
+        /* response is written by completion of the last operation */
+        context->operations.opc_query = TRUE;
+        context->operations.wait = TRUE;
+    } else {
+        SCPI_ResultInt32(context, 1);
+    }
     return SCPI_RES_OK;
 }
 
@@ -360,6 +720,11 @@ scpi_result_t SCPI_CoreOpcQ(scpi_t * context) {
  * @return 
  */
 scpi_result_t SCPI_CoreRst(scpi_t * context) {
+    if (context) {
+        context->data_format.type = SCPI_DATA_ASCII;
+        context->data_format.length = 0;
+        context->data_format.swapped = FALSE;
+    }
     if (context && context->interface && context->interface->reset) {
         return context->interface->reset(context);
     }
@@ -417,8 +782,10 @@ scpi_result_t SCPI_CoreTstQ(scpi_t * context) {
  * @return 
  */
 scpi_result_t SCPI_CoreWai(scpi_t * context) {
-    (void) context;
-    /* NOP */
+    if (SCPI_OperationPending(context)) {
+        /* parsing continues by completion of the last operation */
+        context->operations.wait = TRUE;
+    }
     return SCPI_RES_OK;
 }
 
@@ -328,7 +328,7 @@ static int skipProgramMnemonic(lex_state_t * state) {
  * @param token
  * @return 
  */
-int scpiLex_WhiteSpace(lex_state_t * state, scpi_token_t * token) {
+size_t scpiLex_WhiteSpace(lex_state_t * state, scpi_token_t * token) {
     token->ptr = state->pos;
 
     skipWs(state);
@@ -403,7 +403,7 @@ static int skipCompoundProgramHeader(lex_state_t * state) {
  * @param token
  * @return 
  */
-int scpiLex_ProgramHeader(lex_state_t * state, scpi_token_t * token) {
+size_t scpiLex_ProgramHeader(lex_state_t * state, scpi_token_t * token) {
     int res;
     token->ptr = state->pos;
     token->type = SCPI_TOKEN_UNKNOWN;
@@ -449,7 +449,7 @@ int scpiLex_ProgramHeader(lex_state_t * state, scpi_token_t * token) {
  * @param token
  * @return 
  */
-int scpiLex_CharacterProgramData(lex_state_t * state, scpi_token_t * token) {
+size_t scpiLex_CharacterProgramData(lex_state_t * state, scpi_token_t * token) {
     token->ptr = state->pos;
 
     if (!iseos(state) && isalpha((uint8_t)(state->pos[0]))) {
@@ -506,7 +506,7 @@ static int skipExponent(lex_state_t * state) {
  * @param token
  * @return 
  */
-int scpiLex_DecimalNumericProgramData(lex_state_t * state, scpi_token_t * token) {
+size_t scpiLex_DecimalNumericProgramData(lex_state_t * state, scpi_token_t * token) {
     char * rollback;
     token->ptr = state->pos;
 
@@ -531,7 +531,7 @@ int scpiLex_DecimalNumericProgramData(lex_state_t * state, scpi_token_t * token)
 }
 
 /* 7.7.3 <SUFFIX PROGRAM DATA> */
-int scpiLex_SuffixProgramData(lex_state_t * state, scpi_token_t * token) {
+size_t scpiLex_SuffixProgramData(lex_state_t * state, scpi_token_t * token) {
     token->ptr = state->pos;
 
     skipChr(state, '/');
@@ -594,7 +594,7 @@ static int skipBinNum(lex_state_t * state) {
  * @param token
  * @return 
  */
-int scpiLex_NondecimalNumericData(lex_state_t * state, scpi_token_t * token) {
+size_t scpiLex_NondecimalNumericData(lex_state_t * state, scpi_token_t * token) {
     int someNumbers = 0;
     token->ptr = state->pos;
     if (skipChr(state, '#')) {
@@ -663,7 +663,7 @@ static void skipSingleQuoteProgramData(lex_state_t * state) {
  * @param token
  * @return 
  */
-int scpiLex_StringProgramData(lex_state_t * state, scpi_token_t * token) {
+size_t scpiLex_StringProgramData(lex_state_t * state, scpi_token_t * token) {
     token->ptr = state->pos;
 
     if (!iseos(state)) {
@@ -715,9 +715,9 @@ static int isNonzeroDigit(int c) {
  * @param token
  * @return 
  */
-int scpiLex_ArbitraryBlockProgramData(lex_state_t * state, scpi_token_t * token) {
+size_t scpiLex_ArbitraryBlockProgramData(lex_state_t * state, scpi_token_t * token) {
     int i;
-    int arbitraryBlockLength = 0;
+    size_t arbitraryBlockLength = 0;
     const char * ptr = state->pos;
     int validData = -1;
     token->ptr = state->pos;
@@ -730,6 +730,10 @@ int scpiLex_ArbitraryBlockProgramData(lex_state_t * state, scpi_token_t * token)
 
             for (; i > 0; i--) {
                 if (!iseos(state) && isdigit((uint8_t)(state->pos[0]))) {
+                    if (arbitraryBlockLength > (SIZE_MAX - 9) / 10) {
+                        /* length not addressable on this platform */
+                        break;
+                    }
                     arbitraryBlockLength *= 10;
                     arbitraryBlockLength += (state->pos[0] - '0');
                     state->pos++;
@@ -739,10 +743,10 @@ int scpiLex_ArbitraryBlockProgramData(lex_state_t * state, scpi_token_t * token)
             }
 
             if (i == 0) {
-                state->pos += arbitraryBlockLength;
-                if ((state->buffer + state->len) >= (state->pos)) {
-                    token->ptr = state->pos - arbitraryBlockLength;
+                if ((size_t) (state->buffer + state->len - state->pos) >= arbitraryBlockLength) {
+                    token->ptr = state->pos;
                     token->len = arbitraryBlockLength;
+                    state->pos += arbitraryBlockLength;
                     validData = 1;
                 } else {
                     validData = 0;
@@ -803,7 +807,7 @@ static void skipProgramExpression(lex_state_t * state) {
  * @param token
  * @return 
  */
-int scpiLex_ProgramExpression(lex_state_t * state, scpi_token_t * token) {
+size_t scpiLex_ProgramExpression(lex_state_t * state, scpi_token_t * token) {
     token->ptr = state->pos;
 
     if (!iseos(state) && ischr(state, '(')) {
@@ -835,7 +839,7 @@ int scpiLex_ProgramExpression(lex_state_t * state, scpi_token_t * token) {
  * @param token
  * @return 
  */
-int scpiLex_Comma(lex_state_t * state, scpi_token_t * token) {
+size_t scpiLex_Comma(lex_state_t * state, scpi_token_t * token) {
     token->ptr = state->pos;
 
     if (skipChr(state, ',')) {
@@ -855,7 +859,7 @@ int scpiLex_Comma(lex_state_t * state, scpi_token_t * token) {
  * @param token
  * @return 
  */
-int scpiLex_Semicolon(lex_state_t * state, scpi_token_t * token) {
+size_t scpiLex_Semicolon(lex_state_t * state, scpi_token_t * token) {
     token->ptr = state->pos;
 
     if (skipChr(state, ';')) {
@@ -875,7 +879,7 @@ int scpiLex_Semicolon(lex_state_t * state, scpi_token_t * token) {
  * @param token
  * @return 
  */
-int scpiLex_Colon(lex_state_t * state, scpi_token_t * token) {
+size_t scpiLex_Colon(lex_state_t * state, scpi_token_t * token) {
     token->ptr = state->pos;
 
     if (skipChr(state, ':')) {
@@ -895,7 +899,7 @@ int scpiLex_Colon(lex_state_t * state, scpi_token_t * token) {
  * @param token
  * @return 
  */
-int scpiLex_SpecificCharacter(lex_state_t * state, scpi_token_t * token, char chr) {
+size_t scpiLex_SpecificCharacter(lex_state_t * state, scpi_token_t * token, char chr) {
     token->ptr = state->pos;
 
     if (skipChr(state, chr)) {
@@ -915,7 +919,7 @@ int scpiLex_SpecificCharacter(lex_state_t * state, scpi_token_t * token, char ch
  * @param token
  * @return 
  */
-int scpiLex_NewLine(lex_state_t * state, scpi_token_t * token) {
+size_t scpiLex_NewLine(lex_state_t * state, scpi_token_t * token) {
     token->ptr = state->pos;
 
     skipChr(state, '\r');
@@ -46,20 +46,20 @@ extern "C" {
 #endif
 
     int scpiLex_IsEos(lex_state_t * state) LOCAL;
-    int scpiLex_WhiteSpace(lex_state_t * state, scpi_token_t * token) LOCAL;
-    int scpiLex_ProgramHeader(lex_state_t * state, scpi_token_t * token) LOCAL;
-    int scpiLex_CharacterProgramData(lex_state_t * state, scpi_token_t * token) LOCAL;
-    int scpiLex_DecimalNumericProgramData(lex_state_t * state, scpi_token_t * token) LOCAL;
-    int scpiLex_SuffixProgramData(lex_state_t * state, scpi_token_t * token) LOCAL;
-    int scpiLex_NondecimalNumericData(lex_state_t * state, scpi_token_t * token) LOCAL;
-    int scpiLex_StringProgramData(lex_state_t * state, scpi_token_t * token) LOCAL;
-    int scpiLex_ArbitraryBlockProgramData(lex_state_t * state, scpi_token_t * token) LOCAL;
-    int scpiLex_ProgramExpression(lex_state_t * state, scpi_token_t * token) LOCAL;
-    int scpiLex_Comma(lex_state_t * state, scpi_token_t * token) LOCAL;
-    int scpiLex_Semicolon(lex_state_t * state, scpi_token_t * token) LOCAL;
-    int scpiLex_Colon(lex_state_t * state, scpi_token_t * token) LOCAL;
-    int scpiLex_NewLine(lex_state_t * state, scpi_token_t * token) LOCAL;
-    int scpiLex_SpecificCharacter(lex_state_t * state, scpi_token_t * token, char chr) LOCAL;
+    size_t scpiLex_WhiteSpace(lex_state_t * state, scpi_token_t * token) LOCAL;
+    size_t scpiLex_ProgramHeader(lex_state_t * state, scpi_token_t * token) LOCAL;
+    size_t scpiLex_CharacterProgramData(lex_state_t * state, scpi_token_t * token) LOCAL;
+    size_t scpiLex_DecimalNumericProgramData(lex_state_t * state, scpi_token_t * token) LOCAL;
+    size_t scpiLex_SuffixProgramData(lex_state_t * state, scpi_token_t * token) LOCAL;
+    size_t scpiLex_NondecimalNumericData(lex_state_t * state, scpi_token_t * token) LOCAL;
+    size_t scpiLex_StringProgramData(lex_state_t * state, scpi_token_t * token) LOCAL;
+    size_t scpiLex_ArbitraryBlockProgramData(lex_state_t * state, scpi_token_t * token) LOCAL;
+    size_t scpiLex_ProgramExpression(lex_state_t * state, scpi_token_t * token) LOCAL;
+    size_t scpiLex_Comma(lex_state_t * state, scpi_token_t * token) LOCAL;
+    size_t scpiLex_Semicolon(lex_state_t * state, scpi_token_t * token) LOCAL;
+    size_t scpiLex_Colon(lex_state_t * state, scpi_token_t * token) LOCAL;
+    size_t scpiLex_NewLine(lex_state_t * state, scpi_token_t * token) LOCAL;
+    size_t scpiLex_SpecificCharacter(lex_state_t * state, scpi_token_t * token, char chr) LOCAL;
 
 #ifdef	__cplusplus
 }
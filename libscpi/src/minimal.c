@@ -41,6 +41,7 @@
 #include "scpi/constants.h"
 #include "scpi/error.h"
 #include "scpi/ieee488.h"
+#include "scpi/status.h"
 #include "utils_private.h"
 
 /**
@@ -88,6 +89,31 @@ scpi_result_t SCPI_SystemErrorNextQ(scpi_t * context) {
     return SCPI_RES_OK;
 }
 
+/**
+ * SYSTem:ERRor:ALL?
+ * Remove all errors from the queue and return them as one comma separated
+ * response. With output buffer (SCPI_InitOutputBuffer), the response is
+ * passed to the interface in one piece. Only errors queued when the query
+ * starts are returned, errors pushed while it is answered (e.g. by the
+ * output) stay in the queue.
+ * @param context
+ * @return
+ */
+scpi_result_t SCPI_SystemErrorAllQ(scpi_t * context) {
+    scpi_error_t error;
+    int32_t count = SCPI_ErrorCount(context);
+
+    do {
+        SCPI_ErrorPop(context, &error);
+        SCPI_ResultError(context, &error);
+#if USE_DEVICE_DEPENDENT_ERROR_INFORMATION
+        SCPIDEFINE_free(&context->error_info_heap, error.device_dependent_info, false);
+#endif
+    } while ((--count > 0) && (SCPI_ErrorCount(context) > 0));
+
+    return SCPI_RES_OK;
+}
+
 /**
  * SYSTem:ERRor:COUNt?
  * @param context
@@ -99,6 +125,55 @@ scpi_result_t SCPI_SystemErrorCountQ(scpi_t * context) {
     return SCPI_RES_OK;
 }
 
+/**
+ * SYSTem:ERRor:STATistics? [<error>]
+ * Return number of occurrences of the error (0 if it is not in the error
+ * lists), or <error>,<count> pairs of all listed errors which occurred
+ * (0,0 if there was none). Counters are enabled by SCPI_ErrorCountersInit.
+ * @param context
+ * @return
+ */
+scpi_result_t SCPI_SystemErrorStatisticsQ(scpi_t * context) {
+    int32_t err;
+    uint32_t count;
+    scpi_bool_t found = FALSE;
+
+    if (SCPI_ParamInt32(context, &err, FALSE)) {
+        SCPI_ResultUInt32(context, SCPI_ErrorCounterGet(context, (int16_t) err));
+        return SCPI_RES_OK;
+    }
+    if (SCPI_ParamErrorOccurred(context)) {
+        return SCPI_RES_ERR;
+    }
+
+#define X(def, val, str)                                \
+    count = SCPI_ErrorCounterGet(context, def);         \
+    if (count > 0) {                                    \
+        SCPI_ResultInt32(context, def);                 \
+        SCPI_ResultUInt32(context, count);              \
+        found = TRUE;                                   \
+    }
+#if USE_FULL_ERROR_LIST
+#define XE X
+#else
+#define XE(def, val, str)
+#endif
+    LIST_OF_ERRORS
+
+#if USE_USER_ERROR_LIST
+    LIST_OF_USER_ERRORS
+#endif
+#undef X
+#undef XE
+
+    if (!found) {
+        SCPI_ResultInt32(context, 0);
+        SCPI_ResultUInt32(context, 0);
+    }
+
+    return SCPI_RES_OK;
+}
+
 /**
  * STATus:QUEStionable:CONDition?
  * @param context
@@ -151,6 +226,56 @@ scpi_result_t SCPI_StatusQuestionableEnable(scpi_t * context) {
     return SCPI_RES_OK;
 }
 
+/**
+ * STATus:QUEStionable:PTRansition?
+ * @param context
+ * @return
+ */
+scpi_result_t SCPI_StatusQuestionablePtransitionQ(scpi_t * context) {
+    /* return value */
+    SCPI_ResultInt32(context, SCPI_RegGet(context, SCPI_REG_QUESP));
+
+    return SCPI_RES_OK;
+}
+
+/**
+ * STATus:QUEStionable:PTRansition
+ * @param context
+ * @return
+ */
+scpi_result_t SCPI_StatusQuestionablePtransition(scpi_t * context) {
+    int32_t new_QUESP;
+    if (SCPI_ParamInt32(context, &new_QUESP, TRUE)) {
+        SCPI_RegSet(context, SCPI_REG_QUESP, (scpi_reg_val_t) new_QUESP);
+    }
+    return SCPI_RES_OK;
+}
+
+/**
+ * STATus:QUEStionable:NTRansition?
+ * @param context
+ * @return
+ */
+scpi_result_t SCPI_StatusQuestionableNtransitionQ(scpi_t * context) {
+    /* return value */
+    SCPI_ResultInt32(context, SCPI_RegGet(context, SCPI_REG_QUESN));
+
+    return SCPI_RES_OK;
+}
+
+/**
+ * STATus:QUEStionable:NTRansition
+ * @param context
+ * @return
+ */
+scpi_result_t SCPI_StatusQuestionableNtransition(scpi_t * context) {
+    int32_t new_QUESN;
+    if (SCPI_ParamInt32(context, &new_QUESN, TRUE)) {
+        SCPI_RegSet(context, SCPI_REG_QUESN, (scpi_reg_val_t) new_QUESN);
+    }
+    return SCPI_RES_OK;
+}
+
 /**
  * STATus:OPERation:CONDition?
  * @param context
@@ -203,6 +328,56 @@ scpi_result_t SCPI_StatusOperationEnable(scpi_t * context) {
     return SCPI_RES_OK;
 }
 
+/**
+ * STATus:OPERation:PTRansition?
+ * @param context
+ * @return
+ */
+scpi_result_t SCPI_StatusOperationPtransitionQ(scpi_t * context) {
+    /* return value */
+    SCPI_ResultInt32(context, SCPI_RegGet(context, SCPI_REG_OPERP));
+
+    return SCPI_RES_OK;
+}
+
+/**
+ * STATus:OPERation:PTRansition
+ * @param context
+ * @return
+ */
+scpi_result_t SCPI_StatusOperationPtransition(scpi_t * context) {
+    int32_t new_OPERP;
+    if (SCPI_ParamInt32(context, &new_OPERP, TRUE)) {
+        SCPI_RegSet(context, SCPI_REG_OPERP, (scpi_reg_val_t) new_OPERP);
+    }
+    return SCPI_RES_OK;
+}
+
+/**
+ * STATus:OPERation:NTRansition?
+ * @param context
+ * @return
+ */
+scpi_result_t SCPI_StatusOperationNtransitionQ(scpi_t * context) {
+    /* return value */
+    SCPI_ResultInt32(context, SCPI_RegGet(context, SCPI_REG_OPERN));
+
+    return SCPI_RES_OK;
+}
+
+/**
+ * STATus:OPERation:NTRansition
+ * @param context
+ * @return
+ */
+scpi_result_t SCPI_StatusOperationNtransition(scpi_t * context) {
+    int32_t new_OPERN;
+    if (SCPI_ParamInt32(context, &new_OPERN, TRUE)) {
+        SCPI_RegSet(context, SCPI_REG_OPERN, (scpi_reg_val_t) new_OPERN);
+    }
+    return SCPI_RES_OK;
+}
+
 /**
  * STATus:PRESet
  * @param context
@@ -211,5 +386,143 @@ scpi_result_t SCPI_StatusOperationEnable(scpi_t * context) {
 scpi_result_t SCPI_StatusPreset(scpi_t * context) {
     /* clear STATUS:... */
     SCPI_RegSet(context, SCPI_REG_QUES, 0);
+    SCPI_RegPresetFilters(context);
+    SCPI_StatusTreePreset(context);
+    return SCPI_RES_OK;
+}
+
+/**
+ * STATus:SNAPshot? [<clear>]
+ * 
+ * Return values of all registers in order of scpi_reg_name_t, custom
+ * registers included: STB, SRE, ESR, ESE, OPER, OPERE, OPERC, QUES, QUESE,
+ * QUESC, OPERP, OPERN, QUESP, QUESN, ...
+ * 
+ * Reading doesn't modify any register. With <clear> ON, event registers
+ * are cleared as by their queries, only bits returned in the response are
+ * cleared, so event set meanwhile is not lost.
+ * @param context
+ * @return
+ */
+scpi_result_t SCPI_StatusSnapshotQ(scpi_t * context) {
+    scpi_bool_t clear = FALSE;
+    scpi_reg_val_t val;
+    int i;
+
+    if (!SCPI_ParamBool(context, &clear, FALSE)) {
+        if (SCPI_ParamErrorOccurred(context)) {
+            return SCPI_RES_ERR;
+        }
+    }
+
+    for (i = 0; i < SCPI_REG_COUNT; i++) {
+        val = SCPI_RegGet(context, (scpi_reg_name_t) i);
+        SCPI_ResultUInt32(context, val);
+        if (clear && SCPI_RegClass((scpi_reg_name_t) i) == SCPI_REG_CLASS_EVEN) {
+            SCPI_RegClearBits(context, (scpi_reg_name_t) i, val);
+        }
+    }
+
+    return SCPI_RES_OK;
+}
+
+static const scpi_choice_def_t data_types[] = {
+    {"ASCii", SCPI_DATA_ASCII},
+    {"INTeger", SCPI_DATA_INTEGER},
+    {"REAL", SCPI_DATA_REAL},
+    {"COMPressed", SCPI_DATA_COMPRESSED},
+    SCPI_CHOICE_LIST_END
+};
+
+static const scpi_choice_def_t byte_orders[] = {
+    {"NORMal", FALSE},
+    {"SWAPped", TRUE},
+    SCPI_CHOICE_LIST_END
+};
+
+/**
+ * FORMat[:DATA] ASCii|INTeger[,8|16|32|64]|REAL[,16|32|64]|COMPressed
+ * @param context
+ * @return
+ */
+scpi_result_t SCPI_FormatData(scpi_t * context) {
+    int32_t type;
+    int32_t length;
+    scpi_bool_t valid;
+
+    if (!SCPI_ParamChoice(context, data_types, &type, TRUE)) {
+        return SCPI_RES_ERR;
+    }
+
+    if (!SCPI_ParamInt32(context, &length, FALSE)) {
+        if (SCPI_ParamErrorOccurred(context)) {
+            return SCPI_RES_ERR;
+        }
+        length = (type == SCPI_DATA_INTEGER) ? 16 : (type == SCPI_DATA_REAL) ? 32 : 0;
+    }
+
+    switch (type) {
+        case SCPI_DATA_INTEGER:
+            valid = (length == 8) || (length == 16) || (length == 32) || (length == 64);
+            break;
+        case SCPI_DATA_REAL:
+            valid = (length == 16) || (length == 32) || (length == 64);
+            break;
+        default:
+            valid = (length == 0);
+            break;
+    }
+
+    if (!valid) {
+        SCPI_ErrorPush(context, SCPI_ERROR_ILLEGAL_PARAMETER_VALUE);
+        return SCPI_RES_ERR;
+    }
+
+    context->data_format.type = (scpi_data_type_t) type;
+    context->data_format.length = (uint8_t) length;
+    return SCPI_RES_OK;
+}
+
+/**
+ * FORMat[:DATA]?
+ * @param context
+ * @return
+ */
+scpi_result_t SCPI_FormatDataQ(scpi_t * context) {
+    static const char * const names[] = {"ASC", "INT", "REAL", "COMP"};
+
+    if ((size_t) context->data_format.type >= sizeof (names) / sizeof (*names)) {
+        SCPI_ErrorPush(context, SCPI_ERROR_SYSTEM_ERROR);
+        return SCPI_RES_ERR;
+    }
+
+    SCPI_ResultMnemonic(context, names[context->data_format.type]);
+    SCPI_ResultInt32(context, context->data_format.length);
+    return SCPI_RES_OK;
+}
+
+/**
+ * FORMat:BORDer NORMal|SWAPped
+ * @param context
+ * @return
+ */
+scpi_result_t SCPI_FormatBorder(scpi_t * context) {
+    int32_t swapped;
+
+    if (!SCPI_ParamChoice(context, byte_orders, &swapped, TRUE)) {
+        return SCPI_RES_ERR;
+    }
+
+    context->data_format.swapped = swapped ? TRUE : FALSE;
+    return SCPI_RES_OK;
+}
+
+/**
+ * FORMat:BORDer?
+ * @param context
+ * @return
+ */
+scpi_result_t SCPI_FormatBorderQ(scpi_t * context) {
+    SCPI_ResultMnemonic(context, context->data_format.swapped ? "SWAP" : "NORM");
     return SCPI_RES_OK;
 }
@@ -43,9 +43,199 @@
 #include "parser_private.h"
 #include "lexer_private.h"
 #include "scpi/error.h"
+#include "scpi/ieee488.h"
 #include "scpi/constants.h"
 #include "scpi/utils.h"
 
+#if USE_PARALLEL_ARRAY_CONVERSION
+#include <pthread.h>
+#endif
+
+#if HAVE_PREAD
+#include <unistd.h>
+#endif
+
+static size_t writeData(scpi_t * context, const char * data, size_t len);
+
+/**
+ * Pass buffered output to the interface. While arbitrary block stream is
+ * pending, only data preceding the block are passed.
+ * @param context
+ * @return number of bytes accepted by the interface
+ */
+static size_t drainOutputBuffer(scpi_t * context) {
+    scpi_buffer_t * out = &context->output_buffer;
+    size_t limit = (context->stream.producer != NULL) ? context->stream.head : out->position;
+    size_t written = 0;
+    size_t len;
+
+    while (limit > written) {
+        len = context->interface->write(context, out->data + written, limit - written);
+        if (len == 0) {
+            break;
+        }
+        written += len;
+    }
+
+    if (written > limit) {
+        written = limit;
+    }
+    if (written > 0) {
+        memmove(out->data, out->data + written, out->position - written);
+        out->position -= written;
+        if (context->stream.producer != NULL) {
+            context->stream.head -= written;
+        }
+    }
+
+    return written;
+}
+
+/**
+ * Check if the input buffer can't accept any more data
+ * @param context
+ * @return TRUE if the controller is blocked sending next data
+ */
+static scpi_bool_t isInputBlocked(scpi_t * context) {
+    return (context->buffer.position + 1) >= context->buffer.length ? TRUE : FALSE;
+}
+
+/**
+ * Wait until the interface accepts more data from the full output buffer.
+ * The interface flush callback is used to wait for the transport, e.g. on
+ * non-blocking socket returning EAGAIN, it has to block until the transport
+ * accepts data or fail. If the input buffer is full too, neither side can
+ * continue, the output is cleared and "Query DEADLOCKED" is reported. If the
+ * transport can't accept data now (no flush callback or flush fails), data
+ * in the buffer stay queued for SCPI_OutputFlush ended by the terminator,
+ * rest of the response is discarded and "Query INTERRUPTED" is reported.
+ * @param context
+ * @return TRUE if there is free space in the output buffer
+ */
+static scpi_bool_t waitOutputBuffer(scpi_t * context) {
+    scpi_buffer_t * out = &context->output_buffer;
+    size_t len;
+
+    while (drainOutputBuffer(context) == 0) {
+        if ((context->stream.producer != NULL) && (context->stream.head == 0)) {
+            /* rest of the response waits for the stream */
+            context->output_discard = TRUE;
+            SCPI_ErrorPush(context, SCPI_ERROR_QUERY_INTERRUPTED);
+            return FALSE;
+        }
+        if (isInputBlocked(context)) {
+            /* IEEE 488.2 6.3.1.7: clear output and report deadlock */
+            out->position = 0;
+            context->output_discard = TRUE;
+            SCPI_ErrorPush(context, SCPI_ERROR_QUERY_DEADLOCKED);
+            return FALSE;
+        }
+        if ((context->interface->flush == NULL) || (context->interface->flush(context) != SCPI_RES_OK)) {
+            /* terminate queued part of the response */
+            len = strlen(SCPI_LINE_ENDING);
+            if (len <= out->position) {
+                memcpy(out->data + out->position - len, SCPI_LINE_ENDING, len);
+            }
+            context->output_discard = TRUE;
+            SCPI_ErrorPush(context, SCPI_ERROR_QUERY_INTERRUPTED);
+            return FALSE;
+        }
+    }
+
+    return TRUE;
+}
+
+/**
+ * Write data through the output buffer. Data which doesn't fit to the buffer
+ * is passed to the interface directly. If the buffer is full and the
+ * interface doesn't accept any more data, it waits by waitOutputBuffer.
+ * @param context
+ * @param data
+ * @param len - length of data to be written
+ * @return number of bytes written
+ */
+static size_t writeBufferedData(scpi_t * context, const char * data, size_t len) {
+    scpi_buffer_t * out = &context->output_buffer;
+    size_t written = 0;
+    size_t space;
+    size_t chunk;
+
+    if (context->output_discard) {
+        return 0;
+    }
+
+    while (written < len) {
+        space = out->length - out->position;
+        if (space == 0) {
+            if (!waitOutputBuffer(context)) {
+                break;
+            }
+            continue;
+        }
+
+        chunk = 0;
+        if ((out->position == 0) && ((len - written) > space) && (context->stream.producer == NULL)) {
+            /* bypass the buffer for large data */
+            chunk = context->interface->write(context, data + written, len - written);
+        }
+
+        if (chunk == 0) {
+            chunk = (len - written) < space ? (len - written) : space;
+            memcpy(out->data + out->position, data + written, chunk);
+            out->position += chunk;
+        }
+
+        written += chunk;
+    }
+
+    return written;
+}
+
+/**
+ * Write data to the output buffer or to the interface
+ * @param context
+ * @param data
+ * @param len - length of data to be written
+ * @return number of bytes written
+ */
+static size_t writeOutput(scpi_t * context, const char * data, size_t len) {
+    if ((len > 0) && (data != NULL)) {
+        if (context->output_buffer.data != NULL) {
+            return writeBufferedData(context, data, len);
+        }
+        return context->interface->write(context, data, len);
+    } else {
+        return 0;
+    }
+}
+
+/**
+ * Check if more data can follow in the response. After indefinite length
+ * block, or after streamed block without output buffer to keep the data,
+ * the rest of the response is discarded and error is reported once.
+ * @param context
+ * @return TRUE if data can be written
+ */
+static scpi_bool_t isOutputOpen(scpi_t * context) {
+    int16_t err;
+
+    if (context->output_indefinite || (context->stream.producer && context->stream.indefinite)) {
+        /* nothing can follow indefinite length block in the same message */
+        err = SCPI_ERROR_QUERY_UNTERM_INDEF_RESP;
+    } else if (context->stream.producer && (context->output_buffer.data == NULL)) {
+        /* data following the stream can be kept only in output buffer */
+        err = SCPI_ERROR_QUERY_INTERRUPTED;
+    } else {
+        return TRUE;
+    }
+
+    if (!context->output_discard) {
+        context->output_discard = TRUE;
+        SCPI_ErrorPush(context, err);
+    }
+    return FALSE;
+}
+
 /**
  * Write data to SCPI output
  * @param context
@@ -55,18 +245,107 @@
  */
 static size_t writeData(scpi_t * context, const char * data, size_t len) {
     if ((len > 0) && (data != NULL)) {
-        return context->interface->write(context, data, len);
+        if (!isOutputOpen(context)) {
+            return 0;
+        }
+        return writeOutput(context, data, len);
     } else {
         return 0;
     }
 }
 
+/**
+ * Write several pieces of data to SCPI output. If the interface supports
+ * writev, data waiting in the output buffer and all pieces are passed to the
+ * interface in one call, part not accepted by the interface is queued in
+ * the output buffer. Without output buffer, writev is repeated with the
+ * rest until the interface doesn't accept anything.
+ * @param context
+ * @param iov - pieces of data
+ * @param iovcnt - number of pieces, up to 3
+ * @return number of bytes written
+ */
+static size_t writeDataV(scpi_t * context, const scpi_iovec_t * iov, size_t iovcnt) {
+    scpi_buffer_t * out = &context->output_buffer;
+    scpi_iovec_t vec[4];
+    size_t total = 0;
+    size_t written;
+    size_t result;
+    size_t chunk;
+    size_t first;
+    size_t n = 0;
+    size_t i;
+
+    for (i = 0; i < iovcnt; i++) {
+        total += iov[i].len;
+    }
+
+    if ((context->interface->writev == NULL) || (context->stream.producer != NULL) || context->output_indefinite || context->output_discard
+            || ((out->data != NULL) && (total <= (out->length - out->position)))) {
+        written = 0;
+        for (i = 0; i < iovcnt; i++) {
+            written += writeData(context, iov[i].data, iov[i].len);
+        }
+        return written;
+    }
+
+    if (out->position > 0) {
+        vec[n].data = out->data;
+        vec[n].len = out->position;
+        n++;
+    }
+    memcpy(&vec[n], iov, iovcnt * sizeof (*iov));
+    first = n;
+    n += iovcnt;
+
+    written = context->interface->writev(context, vec, n);
+
+    if (out->data == NULL) {
+        /* send the rest */
+        result = written;
+        first = 0;
+        while ((written > 0) && (result < total)) {
+            while ((first < n) && (written >= vec[first].len)) {
+                written -= vec[first].len;
+                first++;
+            }
+            vec[first].data += written;
+            vec[first].len -= written;
+            written = context->interface->writev(context, &vec[first], n - first);
+            result += written;
+        }
+        return result;
+    }
+
+    chunk = written < out->position ? written : out->position;
+    memmove(out->data, out->data + chunk, out->position - chunk);
+    out->position -= chunk;
+    written -= chunk;
+
+    /* queue the rest */
+    for (i = first; i < n; i++) {
+        chunk = written < vec[i].len ? written : vec[i].len;
+        written -= chunk;
+        writeBufferedData(context, vec[i].data + chunk, vec[i].len - chunk);
+    }
+
+    return total;
+}
+
 /**
  * Flush data to SCPI output
  * @param context
  * @return
  */
 static int flushData(scpi_t * context) {
+    if (context && (context->output_buffer.position > 0)) {
+        drainOutputBuffer(context);
+        if (context->output_buffer.position > 0) {
+            /* rest is sent by SCPI_OutputFlush */
+            return SCPI_RES_OK;
+        }
+    }
+
     if (context && context->interface && context->interface->flush) {
         return context->interface->flush(context);
     } else {
@@ -93,6 +372,23 @@ static size_t writeDelimiter(scpi_t * context) {
  * @return number of characters written
  */
 static size_t writeNewLine(scpi_t * context) {
+    if (context->output_indefinite) {
+        /* IEEE 488.2 8.7.10: indefinite length block ends with NL^END */
+        size_t len;
+        context->output_indefinite = FALSE;
+        context->output_discard = FALSE;
+        len = writeOutput(context, "\n", 1);
+        flushData(context);
+        return len;
+    }
+    if (context->output_discard) {
+        context->output_discard = FALSE;
+        return 0;
+    }
+    if (context->stream.producer != NULL) {
+        /* terminator is added by SCPI_OutputPull */
+        return 0;
+    }
     if (!context->first_output) {
         size_t len;
 #ifndef SCPI_LINE_ENDING
@@ -141,7 +437,8 @@ static scpi_bool_t processCommand(scpi_t * context) {
 
     /* if callback exists - call command callback */
     if (cmd->callback != NULL) {
-        if ((cmd->callback(context) != SCPI_RES_OK)) {
+        scpi_result_t res = cmd->callback(context);
+        if ((res != SCPI_RES_OK) && (res != SCPI_RES_PENDING)) {
             if (!context->cmd_error) {
                 SCPI_ErrorPush(context, SCPI_ERROR_EXECUTION_ERROR);
             }
@@ -171,7 +468,7 @@ static scpi_bool_t processCommand(scpi_t * context) {
  * @param context
  * @result TRUE if context->paramlist is filled with correct values
  */
-static scpi_bool_t findCommandHeader(scpi_t * context, const char * header, int len) {
+static scpi_bool_t findCommandHeader(scpi_t * context, const char * header, size_t len) {
     int32_t i;
     const scpi_command_t * cmd;
 
@@ -186,25 +483,47 @@ static scpi_bool_t findCommandHeader(scpi_t * context, const char * header, int
 }
 
 /**
- * Parse one command line
+ * Finish processing of the message or its part before parsing is paused
  * @param context
- * @param data - complete command line
- * @param len - command line length
- * @return FALSE if there was some error during evaluation of commands
+ * @param complete - TRUE if whole message was processed
  */
-scpi_bool_t SCPI_Parse(scpi_t * context, char * data, int len) {
-    scpi_bool_t result = TRUE;
-    scpi_parser_state_t * state;
-    int r;
-    scpi_token_t cmd_prev = {SCPI_TOKEN_UNKNOWN, NULL, 0};
+static void parseEnd(scpi_t * context, scpi_bool_t complete) {
+#if USE_LAZY_ERROR_INFO
+    /* input can be reused after return, copy info of errors still in queue */
+    if (context->error_info_pending) {
+        scpiError_materialize(context);
+    }
+#endif
 
-    if (context == NULL) {
-        return FALSE;
+    /* conditionally write new line */
+    if (complete) {
+        writeNewLine(context);
     }
 
-    state = &context->parser_state;
-    context->output_count = 0;
-    context->first_output = TRUE;
+#if USE_ERROR_COALESCING
+    SCPI_ErrorBatchEnd(context);
+#endif
+
+#if USE_SRQ_COALESCING
+    SCPI_RegServiceRequestFlush(context);
+#endif
+}
+
+/**
+ * Process program message units of one message. Processing is paused
+ * after a unit which waits for pending operations (*WAI, *OPC?) and the
+ * rest of the message is kept in context->operations.
+ * @param context
+ * @param data - rest of the message
+ * @param len - length of the rest
+ * @param cmd_prev - previous header for compound commands
+ * @param result - result of already processed units
+ * @return FALSE if there was some error during evaluation of commands
+ */
+static scpi_bool_t parseMessage(scpi_t * context, char * data, size_t len, scpi_token_t cmd_prev, scpi_bool_t result) {
+    scpi_parser_state_t * state = &context->parser_state;
+    scpi_bool_t done;
+    size_t r;
 
     while (1) {
         r = scpiParser_detectProgramMessageUnit(state, data, len);
@@ -232,26 +551,71 @@ scpi_bool_t SCPI_Parse(scpi_t * context, char * data, int len) {
                 /* calculate length of errorenous header and trim \r\n */
                 size_t r2 = r;
                 while (r2 > 0 && (data[r2 - 1] == '\r' || data[r2 - 1] == '\n')) r2--;
+#if USE_LAZY_ERROR_INFO
+                scpiError_pushLazy(context, SCPI_ERROR_UNDEFINED_HEADER, data, r2);
+#else
                 SCPI_ErrorPushEx(context, SCPI_ERROR_UNDEFINED_HEADER, data, r2);
+#endif
                 result = FALSE;
             }
         }
 
-        if (r < len) {
-            data += r;
-            len -= r;
-        } else {
-            break;
+        done = (r < len) ? FALSE : TRUE;
+        data += done ? len : r;
+        len -= done ? len : r;
+
+        if (context->operations.wait) {
+            context->operations.data = data;
+            context->operations.len = len;
+            context->operations.cmd_prev = cmd_prev;
+            context->operations.result = result;
+            parseEnd(context, FALSE);
+            return result;
         }
 
+        if (done) {
+            break;
+        }
     }
 
-    /* conditionally write new line */
-    writeNewLine(context);
+    parseEnd(context, TRUE);
 
     return result;
 }
 
+/**
+ * Parse one command line
+ * 
+ * If parsing is paused by *WAI or *OPC? while operations are pending, rest
+ * of the message is parsed by SCPI_OperationComplete, so data have to stay
+ * valid until then. Messages passed by SCPI_Input are kept in the input
+ * buffer automatically.
+ * @param context
+ * @param data - complete command line
+ * @param len - command line length
+ * @return FALSE if there was some error during evaluation of commands
+ */
+scpi_bool_t SCPI_Parse(scpi_t * context, char * data, size_t len) {
+    scpi_token_t cmd_prev = {SCPI_TOKEN_UNKNOWN, NULL, 0};
+
+    if (context == NULL) {
+        return FALSE;
+    }
+
+    context->output_count = 0;
+    context->first_output = TRUE;
+    context->operations.input_len = 0;
+#if USE_ERROR_COALESCING
+    SCPI_ErrorBatchBegin(context);
+#endif
+#if USE_ATOMIC_ERROR_QUEUE
+    SCPI_ErrorAsyncApply(context);
+#endif
+
+    return parseMessage(context, data, len, cmd_prev, TRUE);
+}
+
+
 /**
  * Initialize SCPI context structure
  * @param context
@@ -286,6 +650,7 @@ void SCPI_Init(scpi_t * context,
     context->buffer.length = input_buffer_length;
     context->buffer.position = 0;
     SCPI_ErrorInit(context, error_queue_data, error_queue_size);
+    SCPI_RegPresetFilters(context);
 }
 
 #if USE_DEVICE_DEPENDENT_ERROR_INFORMATION && !USE_MEMORY_ALLOCATION_FREE
@@ -303,32 +668,138 @@ void SCPI_InitHeap(scpi_t * context,
 }
 #endif
 
+/**
+ * Initialize output buffer. Responses are then collected in the buffer and
+ * passed to the interface at the end of each message or when the buffer is
+ * full. Data not accepted by the interface stay in the buffer and parsing
+ * of further messages is paused until they are sent by SCPI_OutputFlush.
+ * If the buffer gets full while a response is generated, the interface
+ * flush callback is called to wait until the transport accepts more data.
+ * Flush callback is required for non-blocking transports, it has to block
+ * until the transport is writable (e.g. by poll) or return error. Without
+ * it, response longer than the buffer is cut and "Query INTERRUPTED" is
+ * reported.
+ * @param context
+ * @param output_buffer
+ * @param output_buffer_length
+ */
+void SCPI_InitOutputBuffer(scpi_t * context,
+        char * output_buffer, size_t output_buffer_length) {
+    context->output_buffer.data = output_buffer;
+    context->output_buffer.length = output_buffer_length;
+    context->output_buffer.position = 0;
+    context->output_discard = FALSE;
+    context->output_indefinite = FALSE;
+}
+
+/**
+ * Check if parsing is paused by *WAI or *OPC? or output is blocked by data
+ * not yet accepted by the interface
+ * @param context
+ * @return TRUE if parsing of next message should wait
+ */
+static scpi_bool_t isParsingBlocked(scpi_t * context) {
+    if (context->operations.wait) {
+        return TRUE;
+    }
+    if (context->stream.producer != NULL) {
+        return TRUE;
+    }
+    if (context->output_buffer.position > 0) {
+        flushData(context);
+    }
+    return context->output_buffer.position > 0 ? TRUE : FALSE;
+}
+
+/**
+ * Parse whole input buffer as one message, e.g. on END without terminator
+ * @param context
+ * @return
+ */
+static scpi_bool_t flushInput(scpi_t * context) {
+    scpi_bool_t result;
+
+    context->operations.input_flush = FALSE;
+    context->buffer.data[context->buffer.position] = 0;
+    result = SCPI_Parse(context, context->buffer.data, context->buffer.position);
+    if (context->operations.wait) {
+        context->operations.input_len = context->buffer.position;
+    } else {
+        context->buffer.position = 0;
+    }
+
+    return result;
+}
+
+/**
+ * Parse all complete messages in the input buffer, then the rest if
+ * SCPI_Input with len=0 was requested while parsing was paused
+ * @param context
+ * @return
+ */
+static scpi_bool_t processInput(scpi_t * context) {
+    scpi_bool_t result = TRUE;
+    size_t totcmdlen = 0;
+    size_t cmdlen = 0;
+
+    while (1) {
+        cmdlen = scpiParser_detectProgramMessageUnit(&context->parser_state, context->buffer.data + totcmdlen, context->buffer.position - totcmdlen);
+        totcmdlen += cmdlen;
+
+        if (context->parser_state.termination == SCPI_MESSAGE_TERMINATION_NL) {
+            if (isParsingBlocked(context)) break;
+            result = SCPI_Parse(context, context->buffer.data, totcmdlen);
+            if (context->operations.wait) {
+                /* keep the message until SCPI_OperationComplete */
+                context->operations.input_len = totcmdlen;
+                break;
+            }
+            memmove(context->buffer.data, context->buffer.data + totcmdlen, context->buffer.position - totcmdlen);
+            context->buffer.position -= totcmdlen;
+            totcmdlen = 0;
+        } else {
+            if (context->parser_state.programHeader.type == SCPI_TOKEN_UNKNOWN
+                    && context->parser_state.termination == SCPI_MESSAGE_TERMINATION_NONE) break;
+            if (totcmdlen >= context->buffer.position) break;
+        }
+    }
+
+    if (context->operations.input_flush && !isParsingBlocked(context)) {
+        result = flushInput(context);
+    }
+
+    return result;
+}
+
 /**
  * Interface to the application. Adds data to system buffer and try to search
  * command line termination. If the termination is found or if len=0, command
- * parser is called.
+ * parser is called. If parsing is paused, len=0 is remembered and the rest
+ * of the input is parsed when parsing continues.
  *
  * @param context
  * @param data - data to process
  * @param len - length of data
  * @return
  */
-scpi_bool_t SCPI_Input(scpi_t * context, const char * data, int len) {
+scpi_bool_t SCPI_Input(scpi_t * context, const char * data, size_t len) {
     scpi_bool_t result = TRUE;
-    size_t totcmdlen = 0;
-    int cmdlen = 0;
 
     if (len == 0) {
-        context->buffer.data[context->buffer.position] = 0;
-        result = SCPI_Parse(context, context->buffer.data, context->buffer.position);
-        context->buffer.position = 0;
+        if (isParsingBlocked(context)) {
+            /* done when parsing continues */
+            context->operations.input_flush = TRUE;
+            return TRUE;
+        }
+        result = flushInput(context);
     } else {
-        int buffer_free;
+        size_t buffer_free;
 
         buffer_free = context->buffer.length - context->buffer.position;
-        if (len > (buffer_free - 1)) {
-            /* Input buffer overrun - invalidate buffer */
-            context->buffer.position = 0;
+        if (len >= buffer_free) {
+            /* Input buffer overrun - invalidate buffer, message paused by
+             * *WAI or *OPC? is kept until SCPI_OperationComplete */
+            context->buffer.position = context->operations.wait ? context->operations.input_len : 0;
             context->buffer.data[context->buffer.position] = 0;
             SCPI_ErrorPush(context, SCPI_ERROR_INPUT_BUFFER_OVERRUN);
             return FALSE;
@@ -337,60 +808,238 @@ scpi_bool_t SCPI_Input(scpi_t * context, const char * data, int len) {
         context->buffer.position += len;
         context->buffer.data[context->buffer.position] = 0;
 
-
-        while (1) {
-            cmdlen = scpiParser_detectProgramMessageUnit(&context->parser_state, context->buffer.data + totcmdlen, context->buffer.position - totcmdlen);
-            totcmdlen += cmdlen;
-
-            if (context->parser_state.termination == SCPI_MESSAGE_TERMINATION_NL) {
-                result = SCPI_Parse(context, context->buffer.data, totcmdlen);
-                memmove(context->buffer.data, context->buffer.data + totcmdlen, context->buffer.position - totcmdlen);
-                context->buffer.position -= totcmdlen;
-                totcmdlen = 0;
-            } else {
-                if (context->parser_state.programHeader.type == SCPI_TOKEN_UNKNOWN
-                        && context->parser_state.termination == SCPI_MESSAGE_TERMINATION_NONE) break;
-                if (totcmdlen >= context->buffer.position) break;
-            }
-        }
+        result = processInput(context);
     }
 
     return result;
 }
 
-/* writing results */
-
 /**
- * Write raw string result to the output
+ * Send data remaining in the output buffer, e.g. when the transport becomes
+ * writable again. Paused messages from the input buffer are parsed as soon
+ * as the output buffer is empty.
  * @param context
- * @param data
- * @return
+ * @return number of bytes still waiting in the output buffer
  */
-size_t SCPI_ResultCharacters(scpi_t * context, const char * data, size_t len) {
-    size_t result = 0;
-    result += writeDelimiter(context);
-    result += writeData(context, data, len);
-    context->output_count++;
-    return result;
+size_t SCPI_OutputFlush(scpi_t * context) {
+    if (!isParsingBlocked(context) && ((context->buffer.position > 0) || context->operations.input_flush)) {
+        processInput(context);
+    }
+    return context->output_buffer.position;
 }
 
 /**
- * Return prefix of nondecimal base
- * @param base
- * @return
+ * Pull next part of the response. Data waiting in the output buffer are
+ * returned first, then data of streamed arbitrary block followed by values
+ * buffered after the block and the message terminator. Parsing of paused messages continues when the
+ * stream is finished.
+ * @param context
+ * @param buffer - destination
+ * @param len - size of the destination
+ * @return number of bytes stored to the buffer
  */
-static const char * getBasePrefix(int8_t base) {
-    switch (base) {
-        case 2: return "#B";
-        case 8: return "#Q";
-        case 16: return "#H";
-        default: return NULL;
+size_t SCPI_OutputPull(scpi_t * context, char * buffer, size_t len) {
+    scpi_buffer_t * out = &context->output_buffer;
+    scpi_stream_t * stream = &context->stream;
+    size_t result = 0;
+    size_t chunk;
+
+    chunk = (stream->producer != NULL) ? stream->head : out->position;
+    if (chunk > 0) {
+        chunk = chunk < len ? chunk : len;
+        memcpy(buffer, out->data, chunk);
+        memmove(out->data, out->data + chunk, out->position - chunk);
+        out->position -= chunk;
+        result += chunk;
+        if (stream->producer != NULL) {
+            stream->head -= chunk;
+        }
     }
-}
 
-/**
- * Write signed/unsigned 32 bit integer value in specific base to the result
- * @param context
+    if ((stream->producer == NULL) || (stream->head > 0)) {
+        return result;
+    }
+
+    if (stream->remaining > 0) {
+        chunk = len - result;
+        if (chunk > stream->remaining) {
+            chunk = stream->remaining;
+        }
+        if (chunk > 0) {
+            chunk = stream->producer(context, stream->user_data, buffer + result, chunk);
+            result += chunk;
+            if (stream->remaining != SCPI_BLOCK_LENGTH_UNKNOWN) {
+                stream->remaining -= chunk;
+            } else if (chunk == 0) {
+                /* end of indefinite length block */
+                stream->remaining = 0;
+            }
+        }
+    }
+
+    if ((stream->remaining == 0) && (out->position > 0)) {
+        /* values following the block */
+        chunk = out->position < (len - result) ? out->position : (len - result);
+        memcpy(buffer + result, out->data, chunk);
+        memmove(out->data, out->data + chunk, out->position - chunk);
+        out->position -= chunk;
+        result += chunk;
+        if (out->position > 0) {
+            return result;
+        }
+    }
+
+    if (stream->remaining == 0) {
+        /* indefinite length block is terminated by NL^END */
+        const char * terminator = stream->indefinite ? "\n" : SCPI_LINE_ENDING;
+        size_t terminator_len = strlen(terminator);
+        chunk = terminator_len - stream->terminator;
+        if (chunk > len - result) {
+            chunk = len - result;
+        }
+        memcpy(buffer + result, terminator + stream->terminator, chunk);
+        stream->terminator += chunk;
+        result += chunk;
+
+        if (stream->terminator == terminator_len) {
+            memset(stream, 0, sizeof (*stream));
+            flushData(context);
+            if ((context->buffer.position > 0) || context->operations.input_flush) {
+                processInput(context);
+            }
+        }
+    }
+
+    return result;
+}
+
+/**
+ * Start overlapped operation. Command callback which leaves the operation
+ * running returns SCPI_RES_PENDING and the application reports its end by
+ * SCPI_OperationComplete.
+ * @param context
+ * @return handle of the operation or -1 if too many operations are pending
+ */
+int32_t SCPI_OperationBegin(scpi_t * context) {
+    int32_t handle;
+
+    for (handle = 0; handle < 32; handle++) {
+        if (!(context->operations.pending & ((uint32_t) 1 << handle))) {
+            context->operations.pending |= (uint32_t) 1 << handle;
+            return handle;
+        }
+    }
+
+    return -1;
+}
+
+/**
+ * Finish overlapped operation. When the last pending operation finishes,
+ * ESR OPC is set for preceding *OPC, *OPC? responds and parsing paused by
+ * *WAI or *OPC? continues. Must be called by the parser thread, the one
+ * calling SCPI_Input, never from interrupt handler or other thread, as the
+ * rest of the input is parsed from here.
+ * @param context
+ * @param handle - value returned by SCPI_OperationBegin
+ */
+void SCPI_OperationComplete(scpi_t * context, int32_t handle) {
+    scpi_operations_t * ops = &context->operations;
+    size_t input_len;
+
+    if ((handle < 0) || (handle >= 32)) {
+        return;
+    }
+
+    ops->pending &= ~((uint32_t) 1 << handle);
+    if (ops->pending) {
+        return;
+    }
+
+    if (ops->opc) {
+        ops->opc = FALSE;
+        SCPI_RegSetBits(context, SCPI_REG_ESR, ESR_OPC);
+    }
+
+    if (!ops->wait) {
+        return;
+    }
+
+    ops->wait = FALSE;
+    input_len = ops->input_len;
+#if USE_ERROR_COALESCING
+    SCPI_ErrorBatchBegin(context);
+#endif
+
+    if (ops->opc_query) {
+        ops->opc_query = FALSE;
+        SCPI_ResultInt32(context, 1);
+    }
+
+    parseMessage(context, ops->data, ops->len, ops->cmd_prev, ops->result);
+    if (ops->wait || (input_len == 0) || (input_len > context->buffer.position)) {
+        return;
+    }
+
+    /* remove the message from the input buffer and parse next ones */
+    memmove(context->buffer.data, context->buffer.data + input_len, context->buffer.position - input_len);
+    context->buffer.position -= input_len;
+    ops->input_len = 0;
+    if (!isParsingBlocked(context) && ((context->buffer.position > 0) || ops->input_flush)) {
+        processInput(context);
+    }
+}
+
+/**
+ * Check for pending overlapped operations
+ * @param context
+ * @return TRUE if any operation is pending
+ */
+scpi_bool_t SCPI_OperationPending(scpi_t * context) {
+    return context->operations.pending ? TRUE : FALSE;
+}
+
+/**
+ * Get number of bytes waiting in the output buffer
+ * @param context
+ * @return
+ */
+size_t SCPI_OutputPending(scpi_t * context) {
+    return context->output_buffer.position;
+}
+
+/* writing results */
+
+/**
+ * Write raw string result to the output
+ * @param context
+ * @param data
+ * @return
+ */
+size_t SCPI_ResultCharacters(scpi_t * context, const char * data, size_t len) {
+    size_t result = 0;
+    result += writeDelimiter(context);
+    result += writeData(context, data, len);
+    context->output_count++;
+    return result;
+}
+
+/**
+ * Return prefix of nondecimal base
+ * @param base
+ * @return
+ */
+static const char * getBasePrefix(int8_t base) {
+    switch (base) {
+        case 2: return "#B";
+        case 8: return "#Q";
+        case 16: return "#H";
+        default: return NULL;
+    }
+}
+
+/**
+ * Write signed/unsigned 32 bit integer value in specific base to the result
+ * @param context
  * @param val
  * @param base
  * @param sign
@@ -562,12 +1211,25 @@ size_t SCPI_ResultError(scpi_t * context, scpi_error_t * error) {
     len[0] = strlen(data[0]);
 
 #if USE_DEVICE_DEPENDENT_ERROR_INFORMATION
-    data[1] = error->device_dependent_info;
+#if USE_LAZY_ERROR_INFO
+    if (error->pending_info) {
+        /* info not copied yet, still referencing the input */
+        data[1] = error->pending_info;
+        len[1] = error->pending_info_len;
+#if SCPIDEFINE_DESCRIPTION_MAX_PARTS > 2
+        data[2] = NULL;
+        len[2] = 0;
+#endif
+    } else
+#endif
+    {
+        data[1] = error->device_dependent_info;
 #if USE_MEMORY_ALLOCATION_FREE
-    len[1] = error->device_dependent_info ? strlen(data[1]) : 0;
+        len[1] = error->device_dependent_info ? strlen(data[1]) : 0;
 #else
-    SCPIDEFINE_get_parts(&context->error_info_heap, data[1], &len[1], &data[2], &len[2]);
+        SCPIDEFINE_get_parts(&context->error_info_heap, data[1], &len[1], &data[2], &len[2]);
 #endif
+    }
 #endif
 
     result += SCPI_ResultInt32(context, error->error_code);
@@ -608,7 +1270,25 @@ size_t SCPI_ResultError(scpi_t * context, scpi_error_t * error) {
 }
 
 /**
- * Write arbitrary block header with length
+ * Format arbitrary block header
+ * @param block_header - buffer for at least 12 characters
+ * @param len - length of the block, up to SCPI_BLOCK_LENGTH_MAX
+ * @return length of the header
+ */
+static size_t formatBlockHeader(char * block_header, size_t len) {
+    size_t header_len;
+    block_header[0] = '#';
+    SCPI_UInt64ToStrBase((uint64_t) len, block_header + 2, 10, 10);
+
+    header_len = strlen(block_header + 2);
+    block_header[1] = (char) (header_len + '0');
+    return header_len + 2;
+}
+
+/**
+ * Write arbitrary block header with length. Blocks longer than
+ * SCPI_BLOCK_LENGTH_MAX can't have definite length header, they are sent
+ * as indefinite length block (#0) terminated by the end of the response.
  * @param context
  * @param len
  * @return
@@ -617,15 +1297,19 @@ size_t SCPI_ResultArbitraryBlockHeader(scpi_t * context, size_t len) {
     size_t result = 0;
     char block_header[12];
     size_t header_len;
-    block_header[0] = '#';
-    SCPI_UInt32ToStrBase((uint32_t) len, block_header + 2, 10, 10);
-
-    header_len = strlen(block_header + 2);
-    block_header[1] = (char) (header_len + '0');
 
     context->arbitrary_remaining = len;
     result  = writeDelimiter(context);
-    result += writeData(context, block_header, header_len + 2);
+
+    if (len > SCPI_BLOCK_LENGTH_MAX) {
+        /* #N header has at most 9 digits, send indefinite length block */
+        result += writeData(context, "#0", 2);
+        context->output_indefinite = TRUE;
+        return result;
+    }
+
+    header_len = formatBlockHeader(block_header, len);
+    result += writeData(context, block_header, header_len);
     return result;
 }
 
@@ -649,9 +1333,181 @@ size_t SCPI_ResultArbitraryBlockData(scpi_t * context, const void * data, size_t
         context->output_count++;
     }
 
+    if (context->output_indefinite) {
+        return context->output_discard ? 0 : writeOutput(context, (const char *) data, len);
+    }
     return writeData(context, (const char *) data, len);
 }
 
+/**
+ * Reserve space for arbitrary block data directly in the output path. The
+ * memory is taken from the output buffer or supplied by the interface
+ * (reserve callback). Data written there are sent by
+ * SCPI_ResultArbitraryBlockCommit without further copying. If no block is
+ * open, block header for len bytes is written first.
+ * @param context
+ * @param len - number of bytes to reserve
+ * @return pointer to writable memory or NULL if the space is not available
+ *         and SCPI_ResultArbitraryBlockData has to be used instead
+ */
+void * SCPI_ResultArbitraryBlockReserve(scpi_t * context, size_t len) {
+    scpi_buffer_t * out = &context->output_buffer;
+    char * reserved = NULL;
+
+    if (!isOutputOpen(context)) {
+        return NULL;
+    }
+
+    if (context->arbitrary_remaining == 0) {
+        if ((out->data == NULL) && ((context->interface->reserve == NULL) || (context->interface->commit == NULL))) {
+            return NULL;
+        }
+        SCPI_ResultArbitraryBlockHeader(context, len);
+    }
+
+    if (context->arbitrary_remaining < len) {
+        SCPI_ErrorPush(context, SCPI_ERROR_SYSTEM_ERROR);
+        return NULL;
+    }
+
+    if (out->data != NULL) {
+        if ((out->length - out->position) < len) {
+            drainOutputBuffer(context);
+        }
+        if (!context->output_discard && ((out->length - out->position) >= len)) {
+            reserved = out->data + out->position;
+        }
+    } else if ((context->interface->reserve != NULL) && (context->interface->commit != NULL)) {
+        reserved = context->interface->reserve(context, len);
+    }
+
+    context->output_reserved = reserved;
+    context->output_reserved_len = reserved ? len : 0;
+    return reserved;
+}
+
+/**
+ * Send data written to memory obtained by SCPI_ResultArbitraryBlockReserve
+ * @param context
+ * @param len - number of bytes written, up to the reserved length
+ * @return number of bytes written
+ */
+size_t SCPI_ResultArbitraryBlockCommit(scpi_t * context, size_t len) {
+    size_t result;
+
+    if ((context->output_reserved == NULL) || (context->output_reserved_len < len)) {
+        SCPI_ErrorPush(context, SCPI_ERROR_SYSTEM_ERROR);
+        return 0;
+    }
+
+    if (context->output_buffer.data != NULL) {
+        context->output_buffer.position += len;
+        result = len;
+    } else {
+        result = context->interface->commit(context, context->output_reserved, len);
+    }
+
+    context->output_reserved = NULL;
+    context->output_reserved_len = 0;
+
+    context->arbitrary_remaining -= len;
+    if (context->arbitrary_remaining == 0) {
+        context->output_count++;
+    }
+
+    return result;
+}
+
+/**
+ * Start indefinite length arbitrary block (#0). Data are then written by
+ * SCPI_ResultArbitraryBlockIndefiniteData as they become available and the
+ * block is terminated by newline at the end of the response message.
+ * Nothing else can follow the block in the same response, any other result
+ * is discarded and "Query UNTERMINATED after indefinite response" is
+ * reported.
+ * @param context
+ * @return number of bytes written
+ */
+size_t SCPI_ResultArbitraryBlockIndefiniteHeader(scpi_t * context) {
+    size_t result;
+
+    if ((context->stream.producer != NULL) || context->output_indefinite) {
+        SCPI_ErrorPush(context, SCPI_ERROR_SYSTEM_ERROR);
+        return 0;
+    }
+
+    result = writeDelimiter(context);
+    result += writeData(context, "#0", 2);
+    context->output_count++;
+    context->output_indefinite = TRUE;
+    return result;
+}
+
+/**
+ * Add data to indefinite length arbitrary block
+ * @param context
+ * @param data
+ * @param len
+ * @return number of bytes written
+ */
+size_t SCPI_ResultArbitraryBlockIndefiniteData(scpi_t * context, const void * data, size_t len) {
+    if (!context->output_indefinite) {
+        SCPI_ErrorPush(context, SCPI_ERROR_SYSTEM_ERROR);
+        return 0;
+    }
+    if (context->output_discard) {
+        return 0;
+    }
+
+    return writeOutput(context, (const char *) data, len);
+}
+
+/**
+ * Write arbitrary block whose data are produced later. The callback only
+ * registers the producer and returns, the transport then calls
+ * SCPI_OutputPull whenever it can send more data. Parsing of further
+ * messages waits until the whole block is sent. Other values can follow
+ * block of known length in the same response if output buffer is used,
+ * they are sent after the block.
+ * @param context
+ * @param len - length of the block or SCPI_BLOCK_LENGTH_UNKNOWN for
+ *              indefinite length block (#0). Blocks longer than
+ *              SCPI_BLOCK_LENGTH_MAX are also sent as indefinite length.
+ * @param producer - fills the buffer with next data and returns their
+ *                   length. Return value 0 means no data available at the
+ *                   moment for known length and end of the data for
+ *                   SCPI_BLOCK_LENGTH_UNKNOWN.
+ * @param user_data - passed to the producer
+ * @return number of bytes written
+ */
+size_t SCPI_ResultArbitraryBlockStream(scpi_t * context, size_t len, scpi_stream_producer_t producer, void * user_data) {
+    size_t result;
+
+    if ((producer == NULL) || (context->stream.producer != NULL)) {
+        SCPI_ErrorPush(context, SCPI_ERROR_SYSTEM_ERROR);
+        return 0;
+    }
+
+    if (len > SCPI_BLOCK_LENGTH_MAX) {
+        /* unknown length or too long for #N header */
+        result = writeDelimiter(context);
+        result += writeData(context, "#0", 2);
+    } else {
+        result = SCPI_ResultArbitraryBlockHeader(context, len);
+        context->arbitrary_remaining = 0;
+    }
+    context->output_count++;
+
+    context->stream.producer = producer;
+    context->stream.user_data = user_data;
+    context->stream.remaining = len;
+    context->stream.indefinite = (len > SCPI_BLOCK_LENGTH_MAX) ? TRUE : FALSE;
+    context->stream.terminator = 0;
+    context->stream.head = context->output_buffer.position;
+
+    return result;
+}
+
 /**
  * Write arbitrary block program data to the result
  * @param context
@@ -661,11 +1517,110 @@ size_t SCPI_ResultArbitraryBlockData(scpi_t * context, const void * data, size_t
  */
 size_t SCPI_ResultArbitraryBlock(scpi_t * context, const void * data, size_t len) {
     size_t result = 0;
+
+    if ((context->interface->writev != NULL) && (len <= SCPI_BLOCK_LENGTH_MAX)) {
+        /* delimiter, header and data in one batch */
+        char block_header[1 + 12];
+        size_t header_len = 0;
+        scpi_iovec_t iov[2];
+
+        if (context->output_count > 0) {
+            block_header[header_len++] = ',';
+        }
+        header_len += formatBlockHeader(block_header + header_len, len);
+
+        iov[0].data = block_header;
+        iov[0].len = header_len;
+        iov[1].data = (const char *) data;
+        iov[1].len = len;
+
+        context->arbitrary_remaining = 0;
+        context->output_count++;
+        return writeDataV(context, iov, 2);
+    }
+
     result += SCPI_ResultArbitraryBlockHeader(context, len);
     result += SCPI_ResultArbitraryBlockData(context, data, len);
     return result;
 }
 
+#if HAVE_PREAD
+/**
+ * Write arbitrary block with data from a file descriptor range. After the
+ * header, the data are passed to the sendfile callback of the interface so
+ * the transport can send them without copying through user memory (e.g. by
+ * sendfile or splice). Without the callback, or for the part the callback
+ * doesn't send, the data are read by pread and written in chunks of
+ * SCPI_FILE_BLOCK_CHUNK_SIZE. If the data can't be read, rest of the block
+ * is filled with zeros and "Mass storage error" is reported. Available
+ * only with pread (HAVE_PREAD).
+ * @param context
+ * @param fd - file descriptor
+ * @param offset - offset of the data in the file
+ * @param len - length of the data
+ * @return number of bytes written
+ */
+size_t SCPI_ResultArbitraryBlockFile(scpi_t * context, int fd, int64_t offset, size_t len) {
+    char chunk[SCPI_FILE_BLOCK_CHUNK_SIZE];
+    size_t result;
+    size_t sent = 0;
+    size_t n;
+    ssize_t rd;
+
+    if (len == 0) {
+        return SCPI_ResultArbitraryBlock(context, NULL, 0);
+    }
+
+    result = SCPI_ResultArbitraryBlockHeader(context, len);
+
+    if ((context->interface->sendfile != NULL) && (context->stream.producer == NULL) && !context->output_discard) {
+        /* header and everything before it has to be sent first */
+        drainOutputBuffer(context);
+        if (context->output_buffer.position == 0) {
+            sent = context->interface->sendfile(context, fd, offset, len);
+            if (sent > len) {
+                sent = len;
+            }
+            context->arbitrary_remaining -= sent;
+            if (context->arbitrary_remaining == 0) {
+                context->output_count++;
+            }
+            result += sent;
+        }
+    }
+
+    while (sent < len) {
+        n = len - sent;
+        if (n > sizeof (chunk)) {
+            n = sizeof (chunk);
+        }
+        rd = pread(fd, chunk, n, (off_t) (offset + sent));
+        if (rd <= 0) {
+            break;
+        }
+        n = (size_t) rd;
+        result += SCPI_ResultArbitraryBlockData(context, chunk, n);
+        sent += n;
+    }
+
+    if (sent < len) {
+        /* keep the block length valid */
+        SCPI_ErrorPush(context, SCPI_ERROR_MASS_STORAGE_ERROR);
+        memset(chunk, 0, sizeof (chunk));
+        while (sent < len) {
+            n = len - sent;
+            if (n > sizeof (chunk)) {
+                n = sizeof (chunk);
+            }
+            result += SCPI_ResultArbitraryBlockData(context, chunk, n);
+            sent += n;
+        }
+    }
+
+    return result;
+}
+#endif /* HAVE_PREAD */
+
 /**
  * Write boolean value to the result
  * @param context
@@ -1357,12 +2312,12 @@ scpi_bool_t SCPI_ParamChoice(scpi_t * context, const scpi_choice_def_t * options
  * @param token
  * @return
  */
-int scpiParser_parseProgramData(lex_state_t * state, scpi_token_t * token) {
+size_t scpiParser_parseProgramData(lex_state_t * state, scpi_token_t * token) {
     scpi_token_t tmp;
-    int result = 0;
-    int wsLen;
-    int suffixLen;
-    int realLen = 0;
+    size_t result = 0;
+    size_t wsLen;
+    size_t suffixLen;
+    size_t realLen = 0;
     realLen += scpiLex_WhiteSpace(state, &tmp);
 
     if (result == 0) result = scpiLex_NondecimalNumericData(state, token);
@@ -1396,20 +2351,17 @@ int scpiParser_parseProgramData(lex_state_t * state, scpi_token_t * token) {
  * @param numberOfParameters
  * @return
  */
-int scpiParser_parseAllProgramData(lex_state_t * state, scpi_token_t * token, int * numberOfParameters) {
+size_t scpiParser_parseAllProgramData(lex_state_t * state, scpi_token_t * token, int * numberOfParameters) {
 
-    int result;
+    size_t result;
     scpi_token_t tmp;
     int paramCount = 0;
 
-    token->len = -1;
+    token->len = 0;
     token->type = SCPI_TOKEN_ALL_PROGRAM_DATA;
     token->ptr = state->pos;
 
-
-    for (result = 1; result != 0; result = scpiLex_Comma(state, &tmp)) {
-        token->len += result;
-
+    while (1) {
         result = scpiParser_parseProgramData(state, &tmp);
         if (tmp.type != SCPI_TOKEN_UNKNOWN) {
             token->len += result;
@@ -1420,6 +2372,12 @@ int scpiParser_parseAllProgramData(lex_state_t * state, scpi_token_t * token, in
             break;
         }
         paramCount++;
+
+        result = scpiLex_Comma(state, &tmp);
+        if (result == 0) {
+            break;
+        }
+        token->len += result;
     }
 
     if (numberOfParameters != NULL) {
@@ -1435,10 +2393,10 @@ int scpiParser_parseAllProgramData(lex_state_t * state, scpi_token_t * token, in
  * @param len
  * @return
  */
-int scpiParser_detectProgramMessageUnit(scpi_parser_state_t * state, char * buffer, int len) {
+size_t scpiParser_detectProgramMessageUnit(scpi_parser_state_t * state, char * buffer, size_t len) {
     lex_state_t lex_state;
     scpi_token_t tmp;
-    int result = 0;
+    size_t result = 0;
 
     lex_state.buffer = lex_state.pos = buffer;
     lex_state.len = len;
@@ -1447,15 +2405,11 @@ int scpiParser_detectProgramMessageUnit(scpi_parser_state_t * state, char * buff
     /* ignore whitespace at the begginig */
     scpiLex_WhiteSpace(&lex_state, &tmp);
 
-    if (scpiLex_ProgramHeader(&lex_state, &state->programHeader) >= 0) {
-        if (scpiLex_WhiteSpace(&lex_state, &tmp) > 0) {
-            scpiParser_parseAllProgramData(&lex_state, &state->programData, &state->numberOfParameters);
-        } else {
-            invalidateToken(&state->programData, lex_state.pos);
-        }
+    scpiLex_ProgramHeader(&lex_state, &state->programHeader);
+    if (scpiLex_WhiteSpace(&lex_state, &tmp) > 0) {
+        scpiParser_parseAllProgramData(&lex_state, &state->programData, &state->numberOfParameters);
     } else {
-        invalidateToken(&state->programHeader, lex_state.buffer);
-        invalidateToken(&state->programData, lex_state.buffer);
+        invalidateToken(&state->programData, lex_state.pos);
     }
 
     if (result == 0) result = scpiLex_NewLine(&lex_state, &tmp);
@@ -1542,81 +2496,619 @@ scpi_bool_t SCPI_ParamErrorOccurred(scpi_t * context) {
     return context->cmd_error;
 }
 
+#if USE_PARALLEL_ARRAY_CONVERSION
+typedef size_t (*array_format_t)(const void * array, size_t index, char * buffer, size_t len);
+
+/* part of ASCII array parameter converted by one thread */
+typedef struct {
+    size_t first;
+    size_t count;
+    scpi_bool_t ok;
+    size_t (*convert)(const char * str, void * array, size_t index);
+    void * data;
+    const char * ptr;
+    const char * end;
+} parallel_chunk_t;
+
+/* delimiter and the longest formatted item */
+#define PARALLEL_ITEM_MAX           (1 + 32)
+#define PARALLEL_BLOCK_ITEMS        128
+/* formatted blocks waiting to be written, two per thread */
+#define PARALLEL_SLOTS              (2 * SCPI_PARALLEL_ARRAY_THREADS)
+
 /**
- * Result binary array and swap bytes if needed (native endiannes != required endiannes)
- * @param context
- * @param array
- * @param count
- * @param item_size
- * @param format
- * @return
+ * Run worker for every chunk, first chunk on the calling thread
+ * @param worker
+ * @param chunks
+ * @param n - number of chunks
  */
-static size_t produceResultArrayBinary(scpi_t * context, const void * array, size_t count, size_t item_size, scpi_array_format_t format) {
+static void parallelRun(void * (*worker)(void *), parallel_chunk_t * chunks, size_t n) {
+    pthread_t threads[SCPI_PARALLEL_ARRAY_THREADS];
+    scpi_bool_t started[SCPI_PARALLEL_ARRAY_THREADS];
+    size_t i;
 
-    if (SCPI_GetNativeFormat() == format) {
-        switch (item_size) {
-            case 1:
-            case 2:
-            case 4:
-            case 8:
-                return SCPI_ResultArbitraryBlock(context, array, count * item_size);
-            default:
-                SCPI_ErrorPush(context, SCPI_ERROR_SYSTEM_ERROR);
-                return 0;
+    for (i = 1; i < n; i++) {
+        started[i] = pthread_create(&threads[i], NULL, worker, &chunks[i]) == 0 ? TRUE : FALSE;
+    }
+
+    worker(&chunks[0]);
+
+    for (i = 1; i < n; i++) {
+        if (started[i]) {
+            pthread_join(threads[i], NULL);
+        } else {
+            worker(&chunks[i]);
         }
-    } else {
-        size_t result = 0;
-        size_t i;
-        switch (item_size) {
-            case 1:
-            case 2:
-            case 4:
-            case 8:
-                result += SCPI_ResultArbitraryBlockHeader(context, count * item_size);
-                break;
-            default:
-                SCPI_ErrorPush(context, SCPI_ERROR_SYSTEM_ERROR);
-                return 0;
+    }
+}
+
+/* ASCII array result formatted by worker threads */
+typedef struct {
+    pthread_mutex_t mutex;
+    pthread_cond_t cond;
+    array_format_t format;
+    const void * array;
+    size_t count;
+    size_t blocks;
+    /* next block to be formatted */
+    size_t next;
+    /* number of blocks already written */
+    size_t done;
+    scpi_bool_t ready[PARALLEL_SLOTS];
+    size_t len[PARALLEL_SLOTS];
+    char buffer[PARALLEL_SLOTS][PARALLEL_BLOCK_ITEMS * PARALLEL_ITEM_MAX];
+} parallel_result_t;
+
+/**
+ * Format blocks of ASCII array result, executed by worker thread. Blocks
+ * are taken in order and stored to the slot freed by the writing thread.
+ * Every item is preceded by delimiter.
+ * @param arg - parallel_result_t
+ * @return NULL
+ */
+static void * resultArrayParallelWorker(void * arg) {
+    parallel_result_t * job = (parallel_result_t *) arg;
+    size_t block;
+    size_t first;
+    size_t last;
+    size_t slot;
+    size_t len;
+    size_t i;
+
+    pthread_mutex_lock(&job->mutex);
+    while (job->next < job->blocks) {
+        block = job->next++;
+        while (block >= job->done + PARALLEL_SLOTS) {
+            pthread_cond_wait(&job->cond, &job->mutex);
+        }
+        pthread_mutex_unlock(&job->mutex);
+
+        slot = block % PARALLEL_SLOTS;
+        first = block * PARALLEL_BLOCK_ITEMS;
+        last = (job->count - first) < PARALLEL_BLOCK_ITEMS ? job->count : first + PARALLEL_BLOCK_ITEMS;
+        len = 0;
+        for (i = first; i < last; i++) {
+            job->buffer[slot][len++] = ',';
+            len += job->format(job->array, i, job->buffer[slot] + len, PARALLEL_ITEM_MAX - 1);
         }
 
-        switch (item_size) {
-            case 1:
-                result += SCPI_ResultArbitraryBlockData(context, array, count);
-                break;
-            case 2:
-                for (i = 0; i < count; i++) {
-                    uint16_t val = SCPI_Swap16(((uint16_t*) array)[i]);
-                    result += SCPI_ResultArbitraryBlockData(context, &val, item_size);
-                }
-                break;
-            case 4:
-                for (i = 0; i < count; i++) {
-                    uint32_t val = SCPI_Swap32(((uint32_t*) array)[i]);
-                    result += SCPI_ResultArbitraryBlockData(context, &val, item_size);
-                }
-                break;
-            case 8:
-                for (i = 0; i < count; i++) {
-                    uint64_t val = SCPI_Swap64(((uint64_t*) array)[i]);
-                    result += SCPI_ResultArbitraryBlockData(context, &val, item_size);
-                }
-                break;
+        pthread_mutex_lock(&job->mutex);
+        job->len[slot] = len;
+        job->ready[slot] = TRUE;
+        pthread_cond_broadcast(&job->cond);
+    }
+    pthread_mutex_unlock(&job->mutex);
+    return NULL;
+}
+
+/**
+ * Format ASCII array result on several threads. Worker threads are started
+ * once per call and format blocks of PARALLEL_BLOCK_ITEMS items, the calling
+ * thread writes the blocks in order as soon as they are ready.
+ * @param context
+ * @param array
+ * @param count
+ * @param format - item formatter
+ * @param result - number of bytes written
+ * @return TRUE if the array was written, FALSE to use sequential path
+ */
+static scpi_bool_t resultArrayParallel(scpi_t * context, const void * array, size_t count, array_format_t format, size_t * result) {
+    parallel_result_t job;
+    pthread_t threads[SCPI_PARALLEL_ARRAY_THREADS];
+    size_t started = 0;
+    size_t block;
+    size_t slot;
+    size_t i;
+
+    if (count < SCPI_PARALLEL_ARRAY_THRESHOLD) {
+        return FALSE;
+    }
+
+    job.format = format;
+    job.array = array;
+    job.count = count;
+    job.blocks = (count + PARALLEL_BLOCK_ITEMS - 1) / PARALLEL_BLOCK_ITEMS;
+    job.next = 0;
+    job.done = 0;
+    for (i = 0; i < PARALLEL_SLOTS; i++) {
+        job.ready[i] = FALSE;
+    }
+    pthread_mutex_init(&job.mutex, NULL);
+    pthread_cond_init(&job.cond, NULL);
+
+    for (i = 0; i < SCPI_PARALLEL_ARRAY_THREADS; i++) {
+        if (pthread_create(&threads[started], NULL, resultArrayParallelWorker, &job) == 0) {
+            started++;
         }
+    }
 
-        return result;
+    if (started == 0) {
+        pthread_cond_destroy(&job.cond);
+        pthread_mutex_destroy(&job.mutex);
+        return FALSE;
+    }
+
+    *result = 0;
+    for (block = 0; block < job.blocks; block++) {
+        const char * data;
+        size_t len;
+
+        slot = block % PARALLEL_SLOTS;
+        pthread_mutex_lock(&job.mutex);
+        while (!job.ready[slot]) {
+            pthread_cond_wait(&job.cond, &job.mutex);
+        }
+        pthread_mutex_unlock(&job.mutex);
+
+        data = job.buffer[slot];
+        len = job.len[slot];
+        if ((block == 0) && (context->output_count == 0)) {
+            data++;
+            len--;
+        }
+        *result += writeData(context, data, len);
+
+        pthread_mutex_lock(&job.mutex);
+        job.ready[slot] = FALSE;
+        job.done++;
+        pthread_cond_broadcast(&job.cond);
+        pthread_mutex_unlock(&job.mutex);
+    }
+
+    for (i = 0; i < started; i++) {
+        pthread_join(threads[i], NULL);
+    }
+    pthread_cond_destroy(&job.cond);
+    pthread_mutex_destroy(&job.mutex);
+
+    context->output_count += count;
+    return TRUE;
+}
+
+#define ARRAY_FORMAT_INTEGER(name, type, conv, sign) \
+static size_t name(const void * array, size_t index, char * buffer, size_t len) {\
+    return conv(((const type *) array)[index], buffer, len, 10, sign);\
+}
+
+ARRAY_FORMAT_INTEGER(formatInt8, int8_t, UInt32ToStrBaseSign, TRUE)
+ARRAY_FORMAT_INTEGER(formatUInt8, uint8_t, UInt32ToStrBaseSign, FALSE)
+ARRAY_FORMAT_INTEGER(formatInt16, int16_t, UInt32ToStrBaseSign, TRUE)
+ARRAY_FORMAT_INTEGER(formatUInt16, uint16_t, UInt32ToStrBaseSign, FALSE)
+ARRAY_FORMAT_INTEGER(formatInt32, int32_t, UInt32ToStrBaseSign, TRUE)
+ARRAY_FORMAT_INTEGER(formatUInt32, uint32_t, UInt32ToStrBaseSign, FALSE)
+ARRAY_FORMAT_INTEGER(formatInt64, int64_t, UInt64ToStrBaseSign, TRUE)
+ARRAY_FORMAT_INTEGER(formatUInt64, uint64_t, UInt64ToStrBaseSign, FALSE)
+
+static size_t formatFloat(const void * array, size_t index, char * buffer, size_t len) {
+    return SCPI_FloatToStr(((const float *) array)[index], buffer, len);
+}
+
+static size_t formatDouble(const void * array, size_t index, char * buffer, size_t len) {
+    return SCPI_DoubleToStr(((const double *) array)[index], buffer, len);
+}
+
+#define RESULT_ARRAY_PARALLEL(formatter) do {\
+    if (resultArrayParallel(context, array, count, formatter, &result)) return result;\
+} while(0)
+#else
+#define RESULT_ARRAY_PARALLEL(formatter)
+#endif /* USE_PARALLEL_ARRAY_CONVERSION */
+
+/* items gathered on stack when output memory can't be reserved */
+#define ARRAY_GATHER_BUFFER_SIZE    256
+
+/**
+ * Gather items from strided source to contiguous destination and swap
+ * bytes if needed. Loops are kept simple so the compiler can vectorize them.
+ * @param dst
+ * @param src
+ * @param stride - distance of items in bytes
+ * @param count - number of items
+ * @param item_size - 1, 2, 4 or 8
+ * @param swap - swap bytes of every item
+ */
+static void gatherArrayItems(char * dst, const char * src, size_t stride, size_t count, size_t item_size, scpi_bool_t swap) {
+    size_t i;
+    uint16_t val16;
+    uint32_t val32;
+    uint64_t val64;
+
+    switch (item_size) {
+        case 1:
+            for (i = 0; i < count; i++) {
+                dst[i] = src[i * stride];
+            }
+            break;
+        case 2:
+            for (i = 0; i < count; i++) {
+                memcpy(&val16, src + i * stride, sizeof (val16));
+                if (swap) val16 = SCPI_Swap16(val16);
+                memcpy(dst + i * sizeof (val16), &val16, sizeof (val16));
+            }
+            break;
+        case 4:
+            for (i = 0; i < count; i++) {
+                memcpy(&val32, src + i * stride, sizeof (val32));
+                if (swap) val32 = SCPI_Swap32(val32);
+                memcpy(dst + i * sizeof (val32), &val32, sizeof (val32));
+            }
+            break;
+        case 8:
+            for (i = 0; i < count; i++) {
+                memcpy(&val64, src + i * stride, sizeof (val64));
+                if (swap) val64 = SCPI_Swap64(val64);
+                memcpy(dst + i * sizeof (val64), &val64, sizeof (val64));
+            }
+            break;
+    }
+}
+
+/**
+ * Result binary array and swap bytes if needed (native endiannes != required endiannes).
+ * Items which are not contiguous or have to be swapped are gathered directly
+ * to the memory reserved in the output path or by chunks on the stack.
+ * @param context
+ * @param array
+ * @param stride - distance of items in bytes
+ * @param count
+ * @param item_size
+ * @param format
+ * @return
+ */
+static size_t produceResultArrayBinary(scpi_t * context, const void * array, size_t stride, size_t count, size_t item_size, scpi_array_format_t format) {
+    char buffer[ARRAY_GATHER_BUFFER_SIZE];
+    const char * src = (const char *) array;
+    scpi_bool_t swap = (SCPI_GetNativeFormat() != format) ? TRUE : FALSE;
+    size_t result;
+    size_t chunk;
+    char * dst;
+
+    switch (item_size) {
+        case 1:
+        case 2:
+        case 4:
+        case 8:
+            break;
+        default:
+            SCPI_ErrorPush(context, SCPI_ERROR_SYSTEM_ERROR);
+            return 0;
+    }
+
+    if ((item_size == 1 || !swap) && (stride == item_size || count <= 1)) {
+        return SCPI_ResultArbitraryBlock(context, array, count * item_size);
+    }
+
+    result = SCPI_ResultArbitraryBlockHeader(context, count * item_size);
+    while (count > 0) {
+        chunk = sizeof (buffer) / item_size;
+        if (chunk > count) {
+            chunk = count;
+        }
+
+        dst = (char *) SCPI_ResultArbitraryBlockReserve(context, chunk * item_size);
+        if (dst != NULL) {
+            gatherArrayItems(dst, src, stride, chunk, item_size, swap);
+            result += SCPI_ResultArbitraryBlockCommit(context, chunk * item_size);
+        } else {
+            gatherArrayItems(buffer, src, stride, chunk, item_size, swap);
+            result += SCPI_ResultArbitraryBlockData(context, buffer, chunk * item_size);
+        }
+
+        src += chunk * stride;
+        count -= chunk;
+    }
+
+    return result;
+}
+
+
+/*
+ * Compressed array format (SCPI_FORMAT_COMPRESSED) - self-describing
+ * arbitrary block: item type (1 byte, item size in bytes and type flags),
+ * number of items and then difference of every item to the previous one
+ * (first to zero). Numbers are LEB128 varints, differences are zigzag coded
+ * so small negative steps are small too. Differences are computed modulo
+ * 2^64 on sign extended integers or on bit patterns of floating point items,
+ * so the coding is lossless.
+ */
+
+/* maximal length of 64bit LEB128 varint */
+#define VARINT_LENGTH_MAX           10
+
+/* item type flags of compressed array, ored with item size */
+#define COMPRESSED_TYPE_UNSIGNED    0x00
+#define COMPRESSED_TYPE_SIGNED      0x10
+#define COMPRESSED_TYPE_FLOAT       0x20
+
+static uint64_t loadArrayItem(const char * src, size_t item_size, scpi_bool_t sign) {
+    int8_t s8;
+    int16_t s16;
+    int32_t s32;
+    uint8_t u8;
+    uint16_t u16;
+    uint32_t u32;
+    uint64_t u64;
+
+    switch (item_size) {
+        case 1:
+            if (sign) {
+                memcpy(&s8, src, sizeof (s8));
+                return (uint64_t) (int64_t) s8;
+            }
+            memcpy(&u8, src, sizeof (u8));
+            return u8;
+        case 2:
+            if (sign) {
+                memcpy(&s16, src, sizeof (s16));
+                return (uint64_t) (int64_t) s16;
+            }
+            memcpy(&u16, src, sizeof (u16));
+            return u16;
+        case 4:
+            if (sign) {
+                memcpy(&s32, src, sizeof (s32));
+                return (uint64_t) (int64_t) s32;
+            }
+            memcpy(&u32, src, sizeof (u32));
+            return u32;
+        default:
+            memcpy(&u64, src, sizeof (u64));
+            return u64;
+    }
+}
+
+static void storeArrayItem(char * dst, size_t item_size, uint64_t val) {
+    uint8_t u8 = (uint8_t) val;
+    uint16_t u16 = (uint16_t) val;
+    uint32_t u32 = (uint32_t) val;
+
+    switch (item_size) {
+        case 1:
+            memcpy(dst, &u8, sizeof (u8));
+            break;
+        case 2:
+            memcpy(dst, &u16, sizeof (u16));
+            break;
+        case 4:
+            memcpy(dst, &u32, sizeof (u32));
+            break;
+        default:
+            memcpy(dst, &val, sizeof (val));
+            break;
+    }
+}
+
+static uint64_t zigzagEncode(uint64_t val) {
+    return (val << 1) ^ (0 - (val >> 63));
+}
+
+static uint64_t zigzagDecode(uint64_t val) {
+    return (val >> 1) ^ (0 - (val & 1));
+}
+
+static size_t varintLength(uint64_t val) {
+    size_t len = 1;
+    while (val >= 0x80) {
+        val >>= 7;
+        len++;
+    }
+    return len;
+}
+
+static size_t varintEncode(uint8_t * dst, uint64_t val) {
+    size_t len = 0;
+    while (val >= 0x80) {
+        dst[len++] = (uint8_t) (val | 0x80);
+        val >>= 7;
+    }
+    dst[len++] = (uint8_t) val;
+    return len;
+}
+
+static scpi_bool_t varintDecode(const uint8_t ** src, const uint8_t * end, uint64_t * val) {
+    const uint8_t * ptr = *src;
+    unsigned shift = 0;
+
+    *val = 0;
+    while (ptr < end && shift < 64) {
+        *val |= (uint64_t) (*ptr & 0x7F) << shift;
+        if ((*ptr++ & 0x80) == 0) {
+            *src = ptr;
+            return TRUE;
+        }
+        shift += 7;
+    }
+    return FALSE;
+}
+
+/**
+ * Result array in compressed format. Length of the block is computed in the
+ * first pass, so the block has definite length, the second pass encodes the
+ * items by chunks directly to the memory reserved in the output path or on
+ * the stack. Memory usage does not depend on the number of items.
+ * @param context
+ * @param array
+ * @param stride - distance of items in bytes
+ * @param count
+ * @param item_size - 1, 2, 4 or 8
+ * @param type - COMPRESSED_TYPE_UNSIGNED, COMPRESSED_TYPE_SIGNED or COMPRESSED_TYPE_FLOAT
+ * @return
+ */
+static size_t produceResultArrayCompressed(scpi_t * context, const void * array, size_t stride, size_t count, size_t item_size, uint8_t type) {
+    scpi_bool_t sign = (type == COMPRESSED_TYPE_SIGNED) ? TRUE : FALSE;
+    uint8_t buffer[ARRAY_GATHER_BUFFER_SIZE];
+    const char * src = (const char *) array;
+    uint64_t prev = 0;
+    uint64_t val;
+    uint64_t diff;
+    size_t remaining;
+    size_t result;
+    size_t chunk;
+    size_t pos;
+    size_t i;
+    uint8_t * dst;
+    uint8_t * out;
+
+    remaining = 1 + varintLength(count);
+    for (i = 0; i < count; i++) {
+        val = loadArrayItem(src + i * stride, item_size, sign);
+        remaining += varintLength(zigzagEncode(val - prev));
+        prev = val;
+    }
+
+    result = SCPI_ResultArbitraryBlockHeader(context, remaining);
+
+    chunk = remaining < sizeof (buffer) ? remaining : sizeof (buffer);
+    dst = (uint8_t *) SCPI_ResultArbitraryBlockReserve(context, chunk);
+    out = dst ? dst : buffer;
+    pos = 0;
+    out[pos++] = (uint8_t) (item_size | type);
+    pos += varintEncode(out + pos, count);
+
+    prev = 0;
+    for (i = 0; i < count; i++) {
+        val = loadArrayItem(src + i * stride, item_size, sign);
+        diff = zigzagEncode(val - prev);
+        prev = val;
+
+        if (pos + varintLength(diff) > chunk) {
+            if (dst != NULL) {
+                result += SCPI_ResultArbitraryBlockCommit(context, pos);
+            } else {
+                result += SCPI_ResultArbitraryBlockData(context, buffer, pos);
+            }
+            remaining -= pos;
+            chunk = remaining < sizeof (buffer) ? remaining : sizeof (buffer);
+            dst = (uint8_t *) SCPI_ResultArbitraryBlockReserve(context, chunk);
+            out = dst ? dst : buffer;
+            pos = 0;
+        }
+
+        pos += varintEncode(out + pos, diff);
+    }
+
+    if (dst != NULL) {
+        result += SCPI_ResultArbitraryBlockCommit(context, pos);
+    } else {
+        result += SCPI_ResultArbitraryBlockData(context, buffer, pos);
     }
+
+    return result;
 }
 
+/**
+ * Read array in compressed format from arbitrary block parameter. Item type
+ * of the block must match the array, all items must fit to the array and
+ * the block must not contain anything after the last item.
+ * @param context
+ * @param data - array to fill
+ * @param item_size - size of items of data
+ * @param type - COMPRESSED_TYPE_UNSIGNED, COMPRESSED_TYPE_SIGNED or COMPRESSED_TYPE_FLOAT
+ * @param i_count - number of elements of data
+ * @param o_count - real number of filled elements
+ * @param mandatory
+ * @return TRUE on success
+ */
+static scpi_bool_t paramArrayCompressed(scpi_t * context, void * data, size_t item_size, uint8_t type, size_t i_count, size_t *o_count, scpi_bool_t mandatory) {
+    const char * ptr;
+    const uint8_t * src;
+    const uint8_t * end;
+    uint64_t count;
+    uint64_t prev = 0;
+    uint64_t val;
+    size_t len;
+    size_t i;
+
+    *o_count = 0;
+    if (!SCPI_ParamArbitraryBlock(context, &ptr, &len, mandatory)) {
+        return mandatory ? FALSE : TRUE;
+    }
+
+    src = (const uint8_t *) ptr;
+    end = src + len;
+    if (len == 0) {
+        SCPI_ErrorPush(context, SCPI_ERROR_INVALID_BLOCK_DATA);
+        return FALSE;
+    }
+    if (*src++ != (item_size | type)) {
+        SCPI_ErrorPush(context, SCPI_ERROR_ILLEGAL_PARAMETER_VALUE);
+        return FALSE;
+    }
+    if (!varintDecode(&src, end, &count)) {
+        SCPI_ErrorPush(context, SCPI_ERROR_INVALID_BLOCK_DATA);
+        return FALSE;
+    }
+    if (count > i_count) {
+        SCPI_ErrorPush(context, SCPI_ERROR_ILLEGAL_PARAMETER_VALUE);
+        return FALSE;
+    }
+
+    for (i = 0; i < count; i++) {
+        if (!varintDecode(&src, end, &val)) {
+            SCPI_ErrorPush(context, SCPI_ERROR_INVALID_BLOCK_DATA);
+            return FALSE;
+        }
+        prev += zigzagDecode(val);
+        storeArrayItem((char *) data + i * item_size, item_size, prev);
+    }
+
+    if (src != end) {
+        SCPI_ErrorPush(context, SCPI_ERROR_INVALID_BLOCK_DATA);
+        return FALSE;
+    }
+
+    *o_count = i;
+    return TRUE;
+}
 
-#define RESULT_ARRAY(func) do {\
+#define RESULT_ARRAY(func, formatter, type) do {\
     size_t result = 0;\
     if (format == SCPI_FORMAT_ASCII) {\
         size_t i;\
+        RESULT_ARRAY_PARALLEL(formatter);\
         for (i = 0; i < count; i++) {\
             result += func(context, array[i]);\
         }\
+    } else if (format == SCPI_FORMAT_COMPRESSED) {\
+        result = produceResultArrayCompressed(context, array, sizeof(*array), count, sizeof(*array), type);\
+    } else {\
+        result = produceResultArrayBinary(context, array, sizeof(*array), count, sizeof(*array), format);\
+    }\
+    return result;\
+} while(0)
+
+#define RESULT_ARRAY_STRIDED(func, type) do {\
+    size_t result = 0;\
+    array += offset;\
+    if (format == SCPI_FORMAT_ASCII) {\
+        size_t i;\
+        for (i = 0; i < count; i++) {\
+            result += func(context, array[i * stride]);\
+        }\
+    } else if (format == SCPI_FORMAT_COMPRESSED) {\
+        result = produceResultArrayCompressed(context, array, stride * sizeof(*array), count, sizeof(*array), type);\
     } else {\
-        result = produceResultArrayBinary(context, array, count, sizeof(*array), format);\
+        result = produceResultArrayBinary(context, array, stride * sizeof(*array), count, sizeof(*array), format);\
     }\
     return result;\
 } while(0)
@@ -1630,7 +3122,7 @@ static size_t produceResultArrayBinary(scpi_t * context, const void * array, siz
  * @return
  */
 size_t SCPI_ResultArrayInt8(scpi_t * context, const int8_t * array, size_t count, scpi_array_format_t format) {
-    RESULT_ARRAY(SCPI_ResultInt8);
+    RESULT_ARRAY(SCPI_ResultInt8, formatInt8, COMPRESSED_TYPE_SIGNED);
 }
 
 /**
@@ -1642,7 +3134,7 @@ size_t SCPI_ResultArrayInt8(scpi_t * context, const int8_t * array, size_t count
  * @return
  */
 size_t SCPI_ResultArrayUInt8(scpi_t * context, const uint8_t * array, size_t count, scpi_array_format_t format) {
-    RESULT_ARRAY(SCPI_ResultUInt8);
+    RESULT_ARRAY(SCPI_ResultUInt8, formatUInt8, COMPRESSED_TYPE_UNSIGNED);
 }
 
 /**
@@ -1654,7 +3146,7 @@ size_t SCPI_ResultArrayUInt8(scpi_t * context, const uint8_t * array, size_t cou
  * @return
  */
 size_t SCPI_ResultArrayInt16(scpi_t * context, const int16_t * array, size_t count, scpi_array_format_t format) {
-    RESULT_ARRAY(SCPI_ResultInt16);
+    RESULT_ARRAY(SCPI_ResultInt16, formatInt16, COMPRESSED_TYPE_SIGNED);
 }
 
 /**
@@ -1666,7 +3158,7 @@ size_t SCPI_ResultArrayInt16(scpi_t * context, const int16_t * array, size_t cou
  * @return
  */
 size_t SCPI_ResultArrayUInt16(scpi_t * context, const uint16_t * array, size_t count, scpi_array_format_t format) {
-    RESULT_ARRAY(SCPI_ResultUInt16);
+    RESULT_ARRAY(SCPI_ResultUInt16, formatUInt16, COMPRESSED_TYPE_UNSIGNED);
 }
 
 /**
@@ -1678,7 +3170,7 @@ size_t SCPI_ResultArrayUInt16(scpi_t * context, const uint16_t * array, size_t c
  * @return
  */
 size_t SCPI_ResultArrayInt32(scpi_t * context, const int32_t * array, size_t count, scpi_array_format_t format) {
-    RESULT_ARRAY(SCPI_ResultInt32);
+    RESULT_ARRAY(SCPI_ResultInt32, formatInt32, COMPRESSED_TYPE_SIGNED);
 }
 
 /**
@@ -1690,7 +3182,7 @@ size_t SCPI_ResultArrayInt32(scpi_t * context, const int32_t * array, size_t cou
  * @return
  */
 size_t SCPI_ResultArrayUInt32(scpi_t * context, const uint32_t * array, size_t count, scpi_array_format_t format) {
-    RESULT_ARRAY(SCPI_ResultUInt32);
+    RESULT_ARRAY(SCPI_ResultUInt32, formatUInt32, COMPRESSED_TYPE_UNSIGNED);
 }
 
 /**
@@ -1702,7 +3194,7 @@ size_t SCPI_ResultArrayUInt32(scpi_t * context, const uint32_t * array, size_t c
  * @return
  */
 size_t SCPI_ResultArrayInt64(scpi_t * context, const int64_t * array, size_t count, scpi_array_format_t format) {
-    RESULT_ARRAY(SCPI_ResultInt64);
+    RESULT_ARRAY(SCPI_ResultInt64, formatInt64, COMPRESSED_TYPE_SIGNED);
 }
 
 /**
@@ -1714,7 +3206,7 @@ size_t SCPI_ResultArrayInt64(scpi_t * context, const int64_t * array, size_t cou
  * @return
  */
 size_t SCPI_ResultArrayUInt64(scpi_t * context, const uint64_t * array, size_t count, scpi_array_format_t format) {
-    RESULT_ARRAY(SCPI_ResultUInt64);
+    RESULT_ARRAY(SCPI_ResultUInt64, formatUInt64, COMPRESSED_TYPE_UNSIGNED);
 }
 
 /**
@@ -1726,7 +3218,7 @@ size_t SCPI_ResultArrayUInt64(scpi_t * context, const uint64_t * array, size_t c
  * @return
  */
 size_t SCPI_ResultArrayFloat(scpi_t * context, const float * array, size_t count, scpi_array_format_t format) {
-    RESULT_ARRAY(SCPI_ResultFloat);
+    RESULT_ARRAY(SCPI_ResultFloat, formatFloat, COMPRESSED_TYPE_FLOAT);
 }
 
 /**
@@ -1738,64 +3230,1005 @@ size_t SCPI_ResultArrayFloat(scpi_t * context, const float * array, size_t count
  * @return
  */
 size_t SCPI_ResultArrayDouble(scpi_t * context, const double * array, size_t count, scpi_array_format_t format) {
-    RESULT_ARRAY(SCPI_ResultDouble);
+    RESULT_ARRAY(SCPI_ResultDouble, formatDouble, COMPRESSED_TYPE_FLOAT);
 }
 
-/*
- * Template macro to generate all SCPI_ParamArrayXYZ function
+/**
+ * Result every stride-th item of array of signed 8bit integers, e.g. one channel of
+ * interleaved samples
+ * @param context
+ * @param array
+ * @param offset - index of the first item
+ * @param stride - distance of items, 1 for contiguous array
+ * @param count - number of items
+ * @param format
+ * @return
  */
-#define PARAM_ARRAY_TEMPLATE(func) do{\
-    if (format != SCPI_FORMAT_ASCII) return FALSE;\
-    for (*o_count = 0; *o_count < i_count; (*o_count)++) {\
-        if (!func(context, &data[*o_count], mandatory)) {\
-            break;\
-        }\
-        mandatory = FALSE;\
-    }\
-    return mandatory ? FALSE : TRUE;\
-}while(0)
+size_t SCPI_ResultArrayStridedInt8(scpi_t * context, const int8_t * array, size_t offset, size_t stride, size_t count, scpi_array_format_t format) {
+    RESULT_ARRAY_STRIDED(SCPI_ResultInt8, COMPRESSED_TYPE_SIGNED);
+}
 
 /**
- * Read list of values up to i_count
+ * Result every stride-th item of array of unsigned 8bit integers, e.g. one channel of
+ * interleaved samples
  * @param context
- * @param data - array to fill
- * @param i_count - number of elements of data
- * @param o_count - real number of filled elements
- * @param mandatory
- * @return TRUE on success
+ * @param array
+ * @param offset - index of the first item
+ * @param stride - distance of items, 1 for contiguous array
+ * @param count - number of items
+ * @param format
+ * @return
  */
-scpi_bool_t SCPI_ParamArrayInt32(scpi_t * context, int32_t *data, size_t i_count, size_t *o_count, scpi_array_format_t format, scpi_bool_t mandatory) {
-    PARAM_ARRAY_TEMPLATE(SCPI_ParamInt32);
+size_t SCPI_ResultArrayStridedUInt8(scpi_t * context, const uint8_t * array, size_t offset, size_t stride, size_t count, scpi_array_format_t format) {
+    RESULT_ARRAY_STRIDED(SCPI_ResultUInt8, COMPRESSED_TYPE_UNSIGNED);
 }
 
 /**
- * Read list of values up to i_count
+ * Result every stride-th item of array of signed 16bit integers, e.g. one channel of
+ * interleaved samples
  * @param context
- * @param data - array to fill
- * @param i_count - number of elements of data
- * @param o_count - real number of filled elements
- * @param mandatory
- * @return TRUE on success
+ * @param array
+ * @param offset - index of the first item
+ * @param stride - distance of items, 1 for contiguous array
+ * @param count - number of items
+ * @param format
+ * @return
  */
-scpi_bool_t SCPI_ParamArrayUInt32(scpi_t * context, uint32_t *data, size_t i_count, size_t *o_count, scpi_array_format_t format, scpi_bool_t mandatory) {
-    PARAM_ARRAY_TEMPLATE(SCPI_ParamUInt32);
+size_t SCPI_ResultArrayStridedInt16(scpi_t * context, const int16_t * array, size_t offset, size_t stride, size_t count, scpi_array_format_t format) {
+    RESULT_ARRAY_STRIDED(SCPI_ResultInt16, COMPRESSED_TYPE_SIGNED);
 }
 
 /**
- * Read list of values up to i_count
+ * Result every stride-th item of array of unsigned 16bit integers, e.g. one channel of
+ * interleaved samples
  * @param context
- * @param data - array to fill
- * @param i_count - number of elements of data
- * @param o_count - real number of filled elements
- * @param mandatory
- * @return TRUE on success
+ * @param array
+ * @param offset - index of the first item
+ * @param stride - distance of items, 1 for contiguous array
+ * @param count - number of items
+ * @param format
+ * @return
  */
-scpi_bool_t SCPI_ParamArrayInt64(scpi_t * context, int64_t *data, size_t i_count, size_t *o_count, scpi_array_format_t format, scpi_bool_t mandatory) {
-    PARAM_ARRAY_TEMPLATE(SCPI_ParamInt64);
+size_t SCPI_ResultArrayStridedUInt16(scpi_t * context, const uint16_t * array, size_t offset, size_t stride, size_t count, scpi_array_format_t format) {
+    RESULT_ARRAY_STRIDED(SCPI_ResultUInt16, COMPRESSED_TYPE_UNSIGNED);
 }
 
 /**
- * Read list of values up to i_count
+ * Result every stride-th item of array of signed 32bit integers, e.g. one channel of
+ * interleaved samples
+ * @param context
+ * @param array
+ * @param offset - index of the first item
+ * @param stride - distance of items, 1 for contiguous array
+ * @param count - number of items
+ * @param format
+ * @return
+ */
+size_t SCPI_ResultArrayStridedInt32(scpi_t * context, const int32_t * array, size_t offset, size_t stride, size_t count, scpi_array_format_t format) {
+    RESULT_ARRAY_STRIDED(SCPI_ResultInt32, COMPRESSED_TYPE_SIGNED);
+}
+
+/**
+ * Result every stride-th item of array of unsigned 32bit integers, e.g. one channel of
+ * interleaved samples
+ * @param context
+ * @param array
+ * @param offset - index of the first item
+ * @param stride - distance of items, 1 for contiguous array
+ * @param count - number of items
+ * @param format
+ * @return
+ */
+size_t SCPI_ResultArrayStridedUInt32(scpi_t * context, const uint32_t * array, size_t offset, size_t stride, size_t count, scpi_array_format_t format) {
+    RESULT_ARRAY_STRIDED(SCPI_ResultUInt32, COMPRESSED_TYPE_UNSIGNED);
+}
+
+/**
+ * Result every stride-th item of array of signed 64bit integers, e.g. one channel of
+ * interleaved samples
+ * @param context
+ * @param array
+ * @param offset - index of the first item
+ * @param stride - distance of items, 1 for contiguous array
+ * @param count - number of items
+ * @param format
+ * @return
+ */
+size_t SCPI_ResultArrayStridedInt64(scpi_t * context, const int64_t * array, size_t offset, size_t stride, size_t count, scpi_array_format_t format) {
+    RESULT_ARRAY_STRIDED(SCPI_ResultInt64, COMPRESSED_TYPE_SIGNED);
+}
+
+/**
+ * Result every stride-th item of array of unsigned 64bit integers, e.g. one channel of
+ * interleaved samples
+ * @param context
+ * @param array
+ * @param offset - index of the first item
+ * @param stride - distance of items, 1 for contiguous array
+ * @param count - number of items
+ * @param format
+ * @return
+ */
+size_t SCPI_ResultArrayStridedUInt64(scpi_t * context, const uint64_t * array, size_t offset, size_t stride, size_t count, scpi_array_format_t format) {
+    RESULT_ARRAY_STRIDED(SCPI_ResultUInt64, COMPRESSED_TYPE_UNSIGNED);
+}
+
+/**
+ * Result every stride-th item of array of floats, e.g. one channel of
+ * interleaved samples
+ * @param context
+ * @param array
+ * @param offset - index of the first item
+ * @param stride - distance of items, 1 for contiguous array
+ * @param count - number of items
+ * @param format
+ * @return
+ */
+size_t SCPI_ResultArrayStridedFloat(scpi_t * context, const float * array, size_t offset, size_t stride, size_t count, scpi_array_format_t format) {
+    RESULT_ARRAY_STRIDED(SCPI_ResultFloat, COMPRESSED_TYPE_FLOAT);
+}
+
+/**
+ * Result every stride-th item of array of doubles, e.g. one channel of
+ * interleaved samples
+ * @param context
+ * @param array
+ * @param offset - index of the first item
+ * @param stride - distance of items, 1 for contiguous array
+ * @param count - number of items
+ * @param format
+ * @return
+ */
+size_t SCPI_ResultArrayStridedDouble(scpi_t * context, const double * array, size_t offset, size_t stride, size_t count, scpi_array_format_t format) {
+    RESULT_ARRAY_STRIDED(SCPI_ResultDouble, COMPRESSED_TYPE_FLOAT);
+}
+
+/*
+ * Packed array formats - items are stored with less bits than their type.
+ * SCPI_FORMAT_NORMAL sends most significant bits first (big endian),
+ * SCPI_FORMAT_SWAPPED least significant first (little endian).
+ */
+
+typedef void (*array_pack_t)(uint8_t * dst, const void * array, size_t first, size_t count, scpi_bool_t little);
+typedef void (*array_unpack_t)(void * array, size_t first, const uint8_t * src, size_t count, scpi_bool_t little, scpi_bool_t sign);
+
+static void packHalf(uint8_t * dst, const void * array, size_t first, size_t count, scpi_bool_t little) {
+    const float * src = (const float *) array + first;
+    uint16_t val;
+    size_t i;
+
+    for (i = 0; i < count; i++) {
+        val = SCPI_FloatToHalf(src[i]);
+        dst[2 * i + (little ? 0 : 1)] = (uint8_t) val;
+        dst[2 * i + (little ? 1 : 0)] = (uint8_t) (val >> 8);
+    }
+}
+
+static void unpackHalf(void * array, size_t first, const uint8_t * src, size_t count, scpi_bool_t little, scpi_bool_t sign) {
+    float * dst = (float *) array + first;
+    size_t i;
+
+    (void) sign;
+    for (i = 0; i < count; i++) {
+        dst[i] = SCPI_HalfToFloat(little
+                ? (uint16_t) (src[2 * i] | (src[2 * i + 1] << 8))
+                : (uint16_t) ((src[2 * i] << 8) | src[2 * i + 1]));
+    }
+}
+
+static void pack12(uint8_t * dst, const void * array, size_t first, size_t count, scpi_bool_t little) {
+    const uint32_t * src = (const uint32_t *) array + first;
+    uint32_t a;
+    uint32_t b;
+    size_t i;
+
+    for (i = 0; i + 1 < count; i += 2) {
+        a = src[i] & 0xFFF;
+        b = src[i + 1] & 0xFFF;
+        if (little) {
+            dst[0] = (uint8_t) a;
+            dst[1] = (uint8_t) ((a >> 8) | (b << 4));
+            dst[2] = (uint8_t) (b >> 4);
+        } else {
+            dst[0] = (uint8_t) (a >> 4);
+            dst[1] = (uint8_t) ((a << 4) | (b >> 8));
+            dst[2] = (uint8_t) b;
+        }
+        dst += 3;
+    }
+
+    if (i < count) {
+        /* odd item is padded with zero bits */
+        a = src[i] & 0xFFF;
+        dst[0] = (uint8_t) (little ? a : a >> 4);
+        dst[1] = (uint8_t) (little ? a >> 8 : a << 4);
+    }
+}
+
+static void unpack12(void * array, size_t first, const uint8_t * src, size_t count, scpi_bool_t little, scpi_bool_t sign) {
+    uint32_t * dst = (uint32_t *) array + first;
+    uint32_t ext = sign ? 0xFFFFF000UL : 0;
+    uint32_t a;
+    uint32_t b;
+    size_t i;
+
+    for (i = 0; i + 1 < count; i += 2) {
+        if (little) {
+            a = src[0] | ((uint32_t) (src[1] & 0x0F) << 8);
+            b = (src[1] >> 4) | ((uint32_t) src[2] << 4);
+        } else {
+            a = ((uint32_t) src[0] << 4) | (src[1] >> 4);
+            b = ((uint32_t) (src[1] & 0x0F) << 8) | src[2];
+        }
+        dst[i] = (a & 0x800) ? (a | ext) : a;
+        dst[i + 1] = (b & 0x800) ? (b | ext) : b;
+        src += 3;
+    }
+
+    if (i < count) {
+        a = little
+                ? (src[0] | ((uint32_t) (src[1] & 0x0F) << 8))
+                : (((uint32_t) src[0] << 4) | (src[1] >> 4));
+        dst[i] = (a & 0x800) ? (a | ext) : a;
+    }
+}
+
+static void pack24(uint8_t * dst, const void * array, size_t first, size_t count, scpi_bool_t little) {
+    const uint32_t * src = (const uint32_t *) array + first;
+    size_t i;
+
+    for (i = 0; i < count; i++) {
+        dst[3 * i + (little ? 0 : 2)] = (uint8_t) src[i];
+        dst[3 * i + 1] = (uint8_t) (src[i] >> 8);
+        dst[3 * i + (little ? 2 : 0)] = (uint8_t) (src[i] >> 16);
+    }
+}
+
+static void unpack24(void * array, size_t first, const uint8_t * src, size_t count, scpi_bool_t little, scpi_bool_t sign) {
+    uint32_t * dst = (uint32_t *) array + first;
+    uint32_t ext = sign ? 0xFF000000UL : 0;
+    uint32_t a;
+    size_t i;
+
+    for (i = 0; i < count; i++) {
+        a = ((uint32_t) src[3 * i + (little ? 2 : 0)] << 16)
+                | ((uint32_t) src[3 * i + 1] << 8)
+                | src[3 * i + (little ? 0 : 2)];
+        dst[i] = (a & 0x800000) ? (a | ext) : a;
+    }
+}
+
+/**
+ * Result packed array as arbitrary block. Items are packed by chunks
+ * directly to the memory reserved in the output path or on the stack.
+ * @param context
+ * @param array
+ * @param count
+ * @param bits - bits per item, 12, 16 or 24
+ * @param pack - packing function
+ * @param format
+ * @return
+ */
+static size_t produceResultArrayPacked(scpi_t * context, const void * array, size_t count, size_t bits, array_pack_t pack, scpi_array_format_t format) {
+    uint8_t buffer[ARRAY_GATHER_BUFFER_SIZE];
+    scpi_bool_t little = (format == SCPI_FORMAT_LITTLEENDIAN) ? TRUE : FALSE;
+    /* whole bytes per chunk, 12 bit items go in pairs */
+    size_t chunk_items = (sizeof (buffer) * 8 / bits) & ~(size_t) 1;
+    size_t first = 0;
+    size_t result;
+    size_t chunk;
+    size_t chunk_len;
+    uint8_t * dst;
+
+    result = SCPI_ResultArbitraryBlockHeader(context, (count * bits + 7) / 8);
+    if (count == 0) {
+        result += SCPI_ResultArbitraryBlockData(context, NULL, 0);
+    }
+
+    while (first < count) {
+        chunk = (count - first) < chunk_items ? (count - first) : chunk_items;
+        chunk_len = (chunk * bits + 7) / 8;
+
+        dst = (uint8_t *) SCPI_ResultArbitraryBlockReserve(context, chunk_len);
+        if (dst != NULL) {
+            pack(dst, array, first, chunk, little);
+            result += SCPI_ResultArbitraryBlockCommit(context, chunk_len);
+        } else {
+            pack(buffer, array, first, chunk, little);
+            result += SCPI_ResultArbitraryBlockData(context, buffer, chunk_len);
+        }
+        first += chunk;
+    }
+
+    return result;
+}
+
+/**
+ * Result array of floats in IEEE 754 half precision (REAL,16)
+ * @param context
+ * @param array
+ * @param count
+ * @param format - ASCII is the same as SCPI_ResultArrayFloat, NORMAL and
+ *                 SWAPPED send 2 bytes per item
+ * @return
+ */
+size_t SCPI_ResultArrayHalf(scpi_t * context, const float * array, size_t count, scpi_array_format_t format) {
+    if ((format == SCPI_FORMAT_ASCII) || (format == SCPI_FORMAT_COMPRESSED)) {
+        return SCPI_ResultArrayFloat(context, array, count, format);
+    }
+    return produceResultArrayPacked(context, array, count, 16, packHalf, format);
+}
+
+/**
+ * Result array of signed integers packed to 12 or 24 bits. Values are
+ * truncated to the number of bits. Two 12 bit items are packed to 3 bytes,
+ * odd item at the end is padded to 2 bytes.
+ * @param context
+ * @param array
+ * @param count
+ * @param bits - 12 or 24
+ * @param format - ASCII is the same as SCPI_ResultArrayInt32
+ * @return
+ */
+size_t SCPI_ResultArrayPackedInt32(scpi_t * context, const int32_t * array, size_t count, size_t bits, scpi_array_format_t format) {
+    if ((format == SCPI_FORMAT_ASCII) || (format == SCPI_FORMAT_COMPRESSED)) {
+        return SCPI_ResultArrayInt32(context, array, count, format);
+    }
+    return SCPI_ResultArrayPackedUInt32(context, (const uint32_t *) array, count, bits, format);
+}
+
+/**
+ * Result array of unsigned integers packed to 12 or 24 bits. Values are
+ * truncated to the number of bits. Two 12 bit items are packed to 3 bytes,
+ * odd item at the end is padded to 2 bytes.
+ * @param context
+ * @param array
+ * @param count
+ * @param bits - 12 or 24
+ * @param format - ASCII is the same as SCPI_ResultArrayUInt32
+ * @return
+ */
+size_t SCPI_ResultArrayPackedUInt32(scpi_t * context, const uint32_t * array, size_t count, size_t bits, scpi_array_format_t format) {
+    switch (((format == SCPI_FORMAT_ASCII) || (format == SCPI_FORMAT_COMPRESSED)) ? 0 : bits) {
+        case 0:
+            return SCPI_ResultArrayUInt32(context, array, count, format);
+        case 12:
+            return produceResultArrayPacked(context, array, count, bits, pack12, format);
+        case 24:
+            return produceResultArrayPacked(context, array, count, bits, pack24, format);
+        default:
+            SCPI_ErrorPush(context, SCPI_ERROR_SYSTEM_ERROR);
+            return 0;
+    }
+}
+
+/*
+ * Array results in format selected by FORMat:DATA and FORMat:BORDer
+ */
+
+typedef enum {
+    DATA_ITEM_INT8,
+    DATA_ITEM_INT16,
+    DATA_ITEM_INT32,
+    DATA_ITEM_INT64,
+    DATA_ITEM_HALF,
+    DATA_ITEM_FLOAT,
+    DATA_ITEM_DOUBLE,
+} data_item_t;
+
+static const uint8_t data_item_size[] = {1, 2, 4, 8, 2, 4, 8};
+
+static double loadDataItemReal(const void * src, data_item_t type, size_t index) {
+    switch (type) {
+        case DATA_ITEM_INT16:
+            return ((const int16_t *) src)[index];
+        case DATA_ITEM_INT32:
+            return ((const int32_t *) src)[index];
+        case DATA_ITEM_FLOAT:
+            return ((const float *) src)[index];
+        default:
+            return ((const double *) src)[index];
+    }
+}
+
+static int64_t loadDataItemInt(const void * src, data_item_t type, size_t index) {
+    double val;
+
+    switch (type) {
+        case DATA_ITEM_INT16:
+            return ((const int16_t *) src)[index];
+        case DATA_ITEM_INT32:
+            return ((const int32_t *) src)[index];
+        default:
+            val = loadDataItemReal(src, type, index);
+            /* round half away from zero, saturate, NaN is 0 */
+            if (val >= 9223372036854775807.0) return INT64_MAX;
+            if (val <= -9223372036854775808.0) return INT64_MIN;
+            if (val != val) return 0;
+            return (int64_t) (val < 0 ? val - 0.5 : val + 0.5);
+    }
+}
+
+static void storeDataItemInt(void * dst, data_item_t type, size_t index, int64_t val) {
+    switch (type) {
+        case DATA_ITEM_INT8:
+            ((int8_t *) dst)[index] = (int8_t) (val > INT8_MAX ? INT8_MAX : val < INT8_MIN ? INT8_MIN : val);
+            break;
+        case DATA_ITEM_INT16:
+            ((int16_t *) dst)[index] = (int16_t) (val > INT16_MAX ? INT16_MAX : val < INT16_MIN ? INT16_MIN : val);
+            break;
+        case DATA_ITEM_INT32:
+            ((int32_t *) dst)[index] = (int32_t) (val > INT32_MAX ? INT32_MAX : val < INT32_MIN ? INT32_MIN : val);
+            break;
+        default:
+            ((int64_t *) dst)[index] = val;
+            break;
+    }
+}
+
+/**
+ * Convert items to other type, floating point values are rounded and all
+ * values are saturated to the range of integer types.
+ * @param dst
+ * @param dst_type - integer type, float or double
+ * @param src
+ * @param src_type - int16, int32, float or double
+ * @param count
+ */
+static void convertDataItems(void * dst, data_item_t dst_type, const void * src, data_item_t src_type, size_t count) {
+    const double * src_double = (const double *) src;
+    float * dst_float = (float *) dst;
+    double * dst_double = (double *) dst;
+    size_t i;
+
+    switch (dst_type) {
+        case DATA_ITEM_FLOAT:
+            if (src_type == DATA_ITEM_DOUBLE) {
+                /* simple loop, compiler can vectorize the narrowing */
+                for (i = 0; i < count; i++) {
+                    dst_float[i] = (float) src_double[i];
+                }
+            } else {
+                for (i = 0; i < count; i++) {
+                    dst_float[i] = (float) loadDataItemReal(src, src_type, i);
+                }
+            }
+            break;
+        case DATA_ITEM_DOUBLE:
+            for (i = 0; i < count; i++) {
+                dst_double[i] = loadDataItemReal(src, src_type, i);
+            }
+            break;
+        default:
+            for (i = 0; i < count; i++) {
+                storeDataItemInt(dst, dst_type, i, loadDataItemInt(src, src_type, i));
+            }
+            break;
+    }
+}
+
+/**
+ * Get type of binary items selected by FORMat:DATA
+ * @param format
+ * @param type - resulting item type
+ * @return FALSE for non binary formats
+ */
+static scpi_bool_t dataFormatItemType(const scpi_data_format_t * format, data_item_t * type) {
+    switch (format->type) {
+        case SCPI_DATA_INTEGER:
+            switch (format->length) {
+                case 8:
+                    *type = DATA_ITEM_INT8;
+                    return TRUE;
+                case 16:
+                    *type = DATA_ITEM_INT16;
+                    return TRUE;
+                case 32:
+                    *type = DATA_ITEM_INT32;
+                    return TRUE;
+                case 64:
+                    *type = DATA_ITEM_INT64;
+                    return TRUE;
+            }
+            break;
+        case SCPI_DATA_REAL:
+            switch (format->length) {
+                case 16:
+                    *type = DATA_ITEM_HALF;
+                    return TRUE;
+                case 32:
+                    *type = DATA_ITEM_FLOAT;
+                    return TRUE;
+                case 64:
+                    *type = DATA_ITEM_DOUBLE;
+                    return TRUE;
+            }
+            break;
+        default:
+            break;
+    }
+    return FALSE;
+}
+
+/**
+ * Get array format for SCPI_ResultArrayXYZ and SCPI_ParamArrayXYZ functions
+ * selected by FORMat:DATA and FORMat:BORDer
+ * @param context
+ * @return SCPI_FORMAT_ASCII, SCPI_FORMAT_COMPRESSED, SCPI_FORMAT_NORMAL or
+ *         SCPI_FORMAT_SWAPPED
+ */
+scpi_array_format_t SCPI_DataArrayFormat(scpi_t * context) {
+    switch (context->data_format.type) {
+        case SCPI_DATA_ASCII:
+            return SCPI_FORMAT_ASCII;
+        case SCPI_DATA_COMPRESSED:
+            return SCPI_FORMAT_COMPRESSED;
+        default:
+            return context->data_format.swapped ? SCPI_FORMAT_SWAPPED : SCPI_FORMAT_NORMAL;
+    }
+}
+
+/**
+ * Result array in format selected by FORMat:DATA. Items are sent without
+ * conversion if the type matches, otherwise they are converted by chunks
+ * directly to the memory reserved in the output path or on the stack.
+ * @param context
+ * @param array
+ * @param count
+ * @param src_type - type of array items
+ * @return
+ */
+static size_t resultDataArray(scpi_t * context, const void * array, size_t count, data_item_t src_type) {
+    double items[ARRAY_GATHER_BUFFER_SIZE / sizeof (double)];
+    uint8_t buffer[ARRAY_GATHER_BUFFER_SIZE];
+    scpi_array_format_t format = SCPI_DataArrayFormat(context);
+    const char * src = (const char *) array;
+    data_item_t dst_type;
+    data_item_t item_type;
+    size_t item_size;
+    size_t out_size;
+    size_t chunk_items;
+    size_t first = 0;
+    size_t result;
+    size_t chunk;
+    uint8_t * dst;
+
+    if ((format == SCPI_FORMAT_ASCII) || (format == SCPI_FORMAT_COMPRESSED)
+            || !dataFormatItemType(&context->data_format, &dst_type) || (dst_type == src_type)) {
+        switch (src_type) {
+            case DATA_ITEM_INT16:
+                return SCPI_ResultArrayInt16(context, (const int16_t *) array, count, format);
+            case DATA_ITEM_INT32:
+                return SCPI_ResultArrayInt32(context, (const int32_t *) array, count, format);
+            case DATA_ITEM_FLOAT:
+                return SCPI_ResultArrayFloat(context, (const float *) array, count, format);
+            default:
+                return SCPI_ResultArrayDouble(context, (const double *) array, count, format);
+        }
+    }
+
+    item_type = (dst_type == DATA_ITEM_HALF) ? DATA_ITEM_FLOAT : dst_type;
+    item_size = data_item_size[item_type];
+    out_size = data_item_size[dst_type];
+    chunk_items = sizeof (items) / item_size;
+
+    result = SCPI_ResultArbitraryBlockHeader(context, count * out_size);
+    if (count == 0) {
+        result += SCPI_ResultArbitraryBlockData(context, NULL, 0);
+    }
+
+    while (first < count) {
+        chunk = (count - first) < chunk_items ? (count - first) : chunk_items;
+        convertDataItems(items, item_type, src + first * data_item_size[src_type], src_type, chunk);
+
+        dst = (uint8_t *) SCPI_ResultArbitraryBlockReserve(context, chunk * out_size);
+        if (dst_type == DATA_ITEM_HALF) {
+            packHalf(dst ? dst : buffer, items, 0, chunk, format == SCPI_FORMAT_LITTLEENDIAN ? TRUE : FALSE);
+        } else {
+            gatherArrayItems(dst ? (char *) dst : (char *) buffer, (const char *) items, item_size, chunk, item_size, (SCPI_GetNativeFormat() != format) ? TRUE : FALSE);
+        }
+
+        if (dst != NULL) {
+            result += SCPI_ResultArbitraryBlockCommit(context, chunk * out_size);
+        } else {
+            result += SCPI_ResultArbitraryBlockData(context, buffer, chunk * out_size);
+        }
+        first += chunk;
+    }
+
+    return result;
+}
+
+/**
+ * Result array of signed 16bit integers in format selected by FORMat:DATA
+ * and FORMat:BORDer
+ * @param context
+ * @param array
+ * @param count
+ * @return
+ */
+size_t SCPI_ResultDataArrayInt16(scpi_t * context, const int16_t * array, size_t count) {
+    return resultDataArray(context, array, count, DATA_ITEM_INT16);
+}
+
+/**
+ * Result array of signed 32bit integers in format selected by FORMat:DATA
+ * and FORMat:BORDer
+ * @param context
+ * @param array
+ * @param count
+ * @return
+ */
+size_t SCPI_ResultDataArrayInt32(scpi_t * context, const int32_t * array, size_t count) {
+    return resultDataArray(context, array, count, DATA_ITEM_INT32);
+}
+
+/**
+ * Result array of floats in format selected by FORMat:DATA and FORMat:BORDer
+ * @param context
+ * @param array
+ * @param count
+ * @return
+ */
+size_t SCPI_ResultDataArrayFloat(scpi_t * context, const float * array, size_t count) {
+    return resultDataArray(context, array, count, DATA_ITEM_FLOAT);
+}
+
+/**
+ * Result array of doubles in format selected by FORMat:DATA and
+ * FORMat:BORDer, e.g. REAL,32 converts the items to floats on the fly
+ * @param context
+ * @param array
+ * @param count
+ * @return
+ */
+size_t SCPI_ResultDataArrayDouble(scpi_t * context, const double * array, size_t count) {
+    return resultDataArray(context, array, count, DATA_ITEM_DOUBLE);
+}
+
+/*
+ * Template macro to generate all SCPI_ParamArrayXYZ function
+ */
+#define SWAR_BYTES(x) ((uint64_t) 0x0101010101010101ULL * (x))
+
+/**
+ * Skip run of decimal digits, eight characters at a time while possible
+ * @param ptr - first character
+ * @param end - end of the buffer
+ * @return number of digits
+ */
+static size_t skipDigitsBulk(const char * ptr, const char * end) {
+    const char * start = ptr;
+    uint64_t word;
+
+    while ((end - ptr) >= 8) {
+        memcpy(&word, ptr, sizeof (word));
+        if (((word & SWAR_BYTES(0xF0)) != SWAR_BYTES(0x30)) ||
+                (((word + SWAR_BYTES(0x06)) & SWAR_BYTES(0xF0)) != SWAR_BYTES(0x30))) {
+            break;
+        }
+        ptr += 8;
+    }
+
+    while ((ptr < end) && (*ptr >= '0') && (*ptr <= '9')) {
+        ptr++;
+    }
+
+    return ptr - start;
+}
+
+/**
+ * Skip white space
+ * @param ptr - first character
+ * @param end - end of the buffer
+ * @return pointer to first non white space character
+ */
+static const char * skipBlankBulk(const char * ptr, const char * end) {
+    while ((ptr < end) && ((*ptr == ' ') || (*ptr == '\t'))) {
+        ptr++;
+    }
+    return ptr;
+}
+
+/**
+ * Scan plain decimal number without suffix
+ * @param ptr - first character
+ * @param end - end of the buffer
+ * @param value - start of the number, suitable for strto* functions
+ * @return pointer to following separator or end of the buffer, NULL if the
+ *         element is something else
+ */
+static const char * scanDecimalBulk(const char * ptr, const char * end, const char ** value) {
+    const char * rollback;
+    size_t digits;
+    size_t exponent;
+
+    ptr = skipBlankBulk(ptr, end);
+    *value = ptr;
+
+    if ((ptr < end) && ((*ptr == '+') || (*ptr == '-'))) {
+        ptr++;
+    }
+    digits = skipDigitsBulk(ptr, end);
+    ptr += digits;
+    if ((ptr < end) && (*ptr == '.')) {
+        ptr++;
+        exponent = skipDigitsBulk(ptr, end);
+        digits += exponent;
+        ptr += exponent;
+    }
+    if (digits == 0) {
+        return NULL;
+    }
+
+    rollback = ptr;
+    ptr = skipBlankBulk(ptr, end);
+    if ((ptr < end) && ((*ptr == 'e') || (*ptr == 'E'))) {
+        ptr = skipBlankBulk(ptr + 1, end);
+        if ((ptr < end) && ((*ptr == '+') || (*ptr == '-'))) {
+            ptr++;
+        }
+        exponent = skipDigitsBulk(ptr, end);
+        ptr = exponent ? ptr + exponent : rollback;
+    } else {
+        ptr = rollback;
+    }
+
+    /* suffix, mnemonic or anything else is handled by general path */
+    ptr = skipBlankBulk(ptr, end);
+    if ((ptr < end) && (*ptr != ',')) {
+        return NULL;
+    }
+
+    return ptr;
+}
+
+/**
+ * Fast path for one element of ASCII array parameter. Accepts only plain
+ * decimal numbers without suffix followed by separator or end of the
+ * parameters. Anything else is left untouched for SCPI_Parameter.
+ * @param context
+ * @param value - start of the number, suitable for strto* functions
+ * @return TRUE if element was consumed
+ */
+static scpi_bool_t paramArrayScanDecimal(scpi_t * context, const char ** value) {
+    lex_state_t * state = &context->param_list.lex_state;
+    const char * ptr = state->pos;
+    const char * end = state->buffer + state->len;
+
+    if (context->input_count != 0) {
+        if ((ptr >= end) || (*ptr != ',')) {
+            return FALSE;
+        }
+        ptr++;
+    }
+
+    ptr = scanDecimalBulk(ptr, end, value);
+    if (ptr == NULL) {
+        return FALSE;
+    }
+
+    state->pos = (char *) ptr;
+    context->input_count++;
+    return TRUE;
+}
+
+typedef size_t (*array_convert_t)(const char * str, void * array, size_t index);
+
+static size_t convertInt32(const char * str, void * array, size_t index) {
+    return strBaseToInt32(str, (int32_t *) array + index, 10);
+}
+
+static size_t convertUInt32(const char * str, void * array, size_t index) {
+    return strBaseToUInt32(str, (uint32_t *) array + index, 10);
+}
+
+static size_t convertInt64(const char * str, void * array, size_t index) {
+    return strBaseToInt64(str, (int64_t *) array + index, 10);
+}
+
+static size_t convertUInt64(const char * str, void * array, size_t index) {
+    return strBaseToUInt64(str, (uint64_t *) array + index, 10);
+}
+
+static size_t convertFloat(const char * str, void * array, size_t index) {
+    return strToFloat(str, (float *) array + index);
+}
+
+static size_t convertDouble(const char * str, void * array, size_t index) {
+    return strToDouble(str, (double *) array + index);
+}
+
+#if USE_PARALLEL_ARRAY_CONVERSION
+/**
+ * Convert one chunk of ASCII array parameter, executed by worker thread
+ * @param arg - parallel_chunk_t
+ * @return NULL
+ */
+static void * paramArrayParallelChunk(void * arg) {
+    parallel_chunk_t * chunk = (parallel_chunk_t *) arg;
+    const char * ptr = chunk->ptr;
+    const char * value;
+    size_t i;
+
+    chunk->ok = FALSE;
+    for (i = 0; i < chunk->count; i++) {
+        if (i > 0) {
+            if ((ptr >= chunk->end) || (*ptr != ',')) {
+                return NULL;
+            }
+            ptr++;
+        }
+        ptr = scanDecimalBulk(ptr, chunk->end, &value);
+        if ((ptr == NULL) || (chunk->convert(value, chunk->data, chunk->first + i) == 0)) {
+            return NULL;
+        }
+    }
+    chunk->ok = (ptr == chunk->end) ? TRUE : FALSE;
+    return NULL;
+}
+
+/**
+ * Count separators in the part of the buffer
+ * @param ptr
+ * @param end
+ * @return number of commas
+ */
+static size_t countCommas(const char * ptr, const char * end) {
+    size_t count = 0;
+    while ((ptr < end) && (ptr = memchr(ptr, ',', end - ptr)) != NULL) {
+        count++;
+        ptr++;
+    }
+    return count;
+}
+
+/**
+ * Convert whole remaining ASCII array parameter on several threads. The
+ * list is split at commas, each chunk is converted directly into its
+ * place in the destination array.
+ * @param context
+ * @param data - array to fill
+ * @param i_count - number of elements of data
+ * @param o_count - real number of filled elements
+ * @param convert - element conversion
+ * @return TRUE if the list was converted, FALSE to use sequential path
+ */
+static scpi_bool_t paramArrayParallel(scpi_t * context, void * data, size_t i_count, size_t * o_count, array_convert_t convert) {
+    lex_state_t * state = &context->param_list.lex_state;
+    parallel_chunk_t chunks[SCPI_PARALLEL_ARRAY_THREADS];
+    const char * ptr = state->pos;
+    const char * end = state->buffer + state->len;
+    const char * start;
+    size_t total = 0;
+    size_t len;
+    size_t n;
+    size_t i;
+
+    if (context->input_count != 0) {
+        if ((ptr >= end) || (*ptr != ',')) {
+            return FALSE;
+        }
+        ptr++;
+    }
+
+    /* every item occupies at least one character */
+    start = ptr;
+    len = end - ptr;
+    if ((len < SCPI_PARALLEL_ARRAY_THRESHOLD) || (i_count < SCPI_PARALLEL_ARRAY_THRESHOLD)) {
+        return FALSE;
+    }
+
+    for (n = 0; (n < SCPI_PARALLEL_ARRAY_THREADS) && (ptr < end); n++) {
+        const char * split = end;
+        if (n < (SCPI_PARALLEL_ARRAY_THREADS - 1)) {
+            const char * target = start + (len * (n + 1)) / SCPI_PARALLEL_ARRAY_THREADS;
+            if (target < ptr) {
+                target = ptr;
+            }
+            split = memchr(target, ',', end - target);
+            if (split == NULL) {
+                split = end;
+            }
+        }
+        chunks[n].ptr = ptr;
+        chunks[n].end = split;
+        chunks[n].first = total;
+        chunks[n].count = countCommas(ptr, split) + 1;
+        chunks[n].convert = convert;
+        chunks[n].data = data;
+        total += chunks[n].count;
+        ptr = (split < end) ? split + 1 : end;
+        if ((split < end) && (ptr == end)) {
+            /* trailing comma, leave it for the general path */
+            return FALSE;
+        }
+    }
+
+    if ((total > i_count) || (total < SCPI_PARALLEL_ARRAY_THRESHOLD)) {
+        return FALSE;
+    }
+
+    parallelRun(paramArrayParallelChunk, chunks, n);
+
+    for (i = 0; i < n; i++) {
+        if (!chunks[i].ok) {
+            return FALSE;
+        }
+    }
+
+    state->pos = (char *) end;
+    context->input_count += total;
+    *o_count = total;
+    return TRUE;
+}
+
+#define PARAM_ARRAY_PARALLEL(convert) do {\
+    if (paramArrayParallel(context, data, i_count, o_count, convert)) return TRUE;\
+} while(0)
+#else
+#define PARAM_ARRAY_PARALLEL(convert)
+#endif /* USE_PARALLEL_ARRAY_CONVERSION */
+
+#define PARAM_ARRAY_TEMPLATE(func, convert, type) do{\
+    const char * ptr;\
+    if (format == SCPI_FORMAT_COMPRESSED) return paramArrayCompressed(context, data, sizeof(*data), type, i_count, o_count, mandatory);\
+    if (format != SCPI_FORMAT_ASCII) return FALSE;\
+    PARAM_ARRAY_PARALLEL(convert);\
+    for (*o_count = 0; *o_count < i_count; (*o_count)++) {\
+        if (paramArrayScanDecimal(context, &ptr)) {\
+            if (convert(ptr, data, *o_count) == 0) {\
+                break;\
+            }\
+        } else if (!func(context, &data[*o_count], mandatory)) {\
+            break;\
+        }\
+        mandatory = FALSE;\
+    }\
+    return mandatory ? FALSE : TRUE;\
+}while(0)
+
+/**
+ * Read list of values up to i_count
+ * @param context
+ * @param data - array to fill
+ * @param i_count - number of elements of data
+ * @param o_count - real number of filled elements
+ * @param mandatory
+ * @return TRUE on success
+ */
+scpi_bool_t SCPI_ParamArrayInt32(scpi_t * context, int32_t *data, size_t i_count, size_t *o_count, scpi_array_format_t format, scpi_bool_t mandatory) {
+    PARAM_ARRAY_TEMPLATE(SCPI_ParamInt32, convertInt32, COMPRESSED_TYPE_SIGNED);
+}
+
+/**
+ * Read list of values up to i_count
+ * @param context
+ * @param data - array to fill
+ * @param i_count - number of elements of data
+ * @param o_count - real number of filled elements
+ * @param mandatory
+ * @return TRUE on success
+ */
+scpi_bool_t SCPI_ParamArrayUInt32(scpi_t * context, uint32_t *data, size_t i_count, size_t *o_count, scpi_array_format_t format, scpi_bool_t mandatory) {
+    PARAM_ARRAY_TEMPLATE(SCPI_ParamUInt32, convertUInt32, COMPRESSED_TYPE_UNSIGNED);
+}
+
+/**
+ * Read list of values up to i_count
+ * @param context
+ * @param data - array to fill
+ * @param i_count - number of elements of data
+ * @param o_count - real number of filled elements
+ * @param mandatory
+ * @return TRUE on success
+ */
+scpi_bool_t SCPI_ParamArrayInt64(scpi_t * context, int64_t *data, size_t i_count, size_t *o_count, scpi_array_format_t format, scpi_bool_t mandatory) {
+    PARAM_ARRAY_TEMPLATE(SCPI_ParamInt64, convertInt64, COMPRESSED_TYPE_SIGNED);
+}
+
+/**
+ * Read list of values up to i_count
  * @param context
  * @param data - array to fill
  * @param i_count - number of elements of data
@@ -1804,7 +4237,7 @@ scpi_bool_t SCPI_ParamArrayInt64(scpi_t * context, int64_t *data, size_t i_count
  * @return TRUE on success
  */
 scpi_bool_t SCPI_ParamArrayUInt64(scpi_t * context, uint64_t *data, size_t i_count, size_t *o_count, scpi_array_format_t format, scpi_bool_t mandatory) {
-    PARAM_ARRAY_TEMPLATE(SCPI_ParamUInt64);
+    PARAM_ARRAY_TEMPLATE(SCPI_ParamUInt64, convertUInt64, COMPRESSED_TYPE_UNSIGNED);
 }
 
 /**
@@ -1817,7 +4250,7 @@ scpi_bool_t SCPI_ParamArrayUInt64(scpi_t * context, uint64_t *data, size_t i_cou
  * @return TRUE on success
  */
 scpi_bool_t SCPI_ParamArrayFloat(scpi_t * context, float *data, size_t i_count, size_t *o_count, scpi_array_format_t format, scpi_bool_t mandatory) {
-    PARAM_ARRAY_TEMPLATE(SCPI_ParamFloat);
+    PARAM_ARRAY_TEMPLATE(SCPI_ParamFloat, convertFloat, COMPRESSED_TYPE_FLOAT);
 }
 
 /**
@@ -1830,5 +4263,112 @@ scpi_bool_t SCPI_ParamArrayFloat(scpi_t * context, float *data, size_t i_count,
  * @return TRUE on success
  */
 scpi_bool_t SCPI_ParamArrayDouble(scpi_t * context, double *data, size_t i_count, size_t *o_count, scpi_array_format_t format, scpi_bool_t mandatory) {
-    PARAM_ARRAY_TEMPLATE(SCPI_ParamDouble);
+    PARAM_ARRAY_TEMPLATE(SCPI_ParamDouble, convertDouble, COMPRESSED_TYPE_FLOAT);
+}
+
+/**
+ * Read packed array from arbitrary block parameter
+ * @param context
+ * @param data - array to fill
+ * @param i_count - number of elements of data
+ * @param o_count - real number of filled elements
+ * @param bits - bits per item
+ * @param unpack - unpacking function
+ * @param sign - sign extend the items
+ * @param format
+ * @param mandatory
+ * @return TRUE on success
+ */
+static scpi_bool_t paramArrayPacked(scpi_t * context, void * data, size_t i_count, size_t *o_count, size_t bits, array_unpack_t unpack, scpi_bool_t sign, scpi_array_format_t format, scpi_bool_t mandatory) {
+    const char * ptr;
+    size_t len;
+    size_t count;
+
+    *o_count = 0;
+    if (!SCPI_ParamArbitraryBlock(context, &ptr, &len, mandatory)) {
+        return mandatory ? FALSE : TRUE;
+    }
+
+    count = len * 8 / bits;
+    if ((count * bits + 7) / 8 != len) {
+        SCPI_ErrorPush(context, SCPI_ERROR_ILLEGAL_PARAMETER_VALUE);
+        return FALSE;
+    }
+    if (count > i_count) {
+        count = i_count;
+    }
+
+    unpack(data, 0, (const uint8_t *) ptr, count, format == SCPI_FORMAT_LITTLEENDIAN ? TRUE : FALSE, sign);
+    *o_count = count;
+    return TRUE;
+}
+
+/**
+ * Read list of values up to i_count, binary formats are IEEE 754 half
+ * precision (REAL,16) in arbitrary block
+ * @param context
+ * @param data - array to fill
+ * @param i_count - number of elements of data
+ * @param o_count - real number of filled elements
+ * @param format
+ * @param mandatory
+ * @return TRUE on success
+ */
+scpi_bool_t SCPI_ParamArrayHalf(scpi_t * context, float *data, size_t i_count, size_t *o_count, scpi_array_format_t format, scpi_bool_t mandatory) {
+    if ((format == SCPI_FORMAT_ASCII) || (format == SCPI_FORMAT_COMPRESSED)) {
+        return SCPI_ParamArrayFloat(context, data, i_count, o_count, format, mandatory);
+    }
+    return paramArrayPacked(context, data, i_count, o_count, 16, unpackHalf, FALSE, format, mandatory);
+}
+
+/**
+ * Read list of values up to i_count, binary formats are signed integers
+ * packed to 12 or 24 bits in arbitrary block
+ * @param context
+ * @param data - array to fill
+ * @param i_count - number of elements of data
+ * @param o_count - real number of filled elements
+ * @param bits - 12 or 24
+ * @param format
+ * @param mandatory
+ * @return TRUE on success
+ */
+scpi_bool_t SCPI_ParamArrayPackedInt32(scpi_t * context, int32_t *data, size_t i_count, size_t *o_count, size_t bits, scpi_array_format_t format, scpi_bool_t mandatory) {
+    switch (((format == SCPI_FORMAT_ASCII) || (format == SCPI_FORMAT_COMPRESSED)) ? 0 : bits) {
+        case 0:
+            return SCPI_ParamArrayInt32(context, data, i_count, o_count, format, mandatory);
+        case 12:
+            return paramArrayPacked(context, data, i_count, o_count, bits, unpack12, TRUE, format, mandatory);
+        case 24:
+            return paramArrayPacked(context, data, i_count, o_count, bits, unpack24, TRUE, format, mandatory);
+        default:
+            SCPI_ErrorPush(context, SCPI_ERROR_SYSTEM_ERROR);
+            return FALSE;
+    }
+}
+
+/**
+ * Read list of values up to i_count, binary formats are unsigned integers
+ * packed to 12 or 24 bits in arbitrary block
+ * @param context
+ * @param data - array to fill
+ * @param i_count - number of elements of data
+ * @param o_count - real number of filled elements
+ * @param bits - 12 or 24
+ * @param format
+ * @param mandatory
+ * @return TRUE on success
+ */
+scpi_bool_t SCPI_ParamArrayPackedUInt32(scpi_t * context, uint32_t *data, size_t i_count, size_t *o_count, size_t bits, scpi_array_format_t format, scpi_bool_t mandatory) {
+    switch (((format == SCPI_FORMAT_ASCII) || (format == SCPI_FORMAT_COMPRESSED)) ? 0 : bits) {
+        case 0:
+            return SCPI_ParamArrayUInt32(context, data, i_count, o_count, format, mandatory);
+        case 12:
+            return paramArrayPacked(context, data, i_count, o_count, bits, unpack12, FALSE, format, mandatory);
+        case 24:
+            return paramArrayPacked(context, data, i_count, o_count, bits, unpack24, FALSE, format, mandatory);
+        default:
+            SCPI_ErrorPush(context, SCPI_ERROR_SYSTEM_ERROR);
+            return FALSE;
+    }
 }
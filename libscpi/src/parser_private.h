@@ -44,9 +44,13 @@
 extern "C" {
 #endif
 
-    int scpiParser_parseProgramData(lex_state_t * state, scpi_token_t * token) LOCAL;
-    int scpiParser_parseAllProgramData(lex_state_t * state, scpi_token_t * token, int * numberOfParameters) LOCAL;
-    int scpiParser_detectProgramMessageUnit(scpi_parser_state_t * state, char * buffer, int len) LOCAL;
+    size_t scpiParser_parseProgramData(lex_state_t * state, scpi_token_t * token) LOCAL;
+    size_t scpiParser_parseAllProgramData(lex_state_t * state, scpi_token_t * token, int * numberOfParameters) LOCAL;
+    size_t scpiParser_detectProgramMessageUnit(scpi_parser_state_t * state, char * buffer, size_t len) LOCAL;
+#if USE_LAZY_ERROR_INFO
+    void scpiError_pushLazy(scpi_t * context, int16_t err, const char * info, size_t info_len) LOCAL;
+    void scpiError_materialize(scpi_t * context) LOCAL;
+#endif
 
 #ifdef	__cplusplus
 }
@@ -0,0 +1,513 @@
+/*-
+ * BSD 2-Clause License
+ *
+ * Copyright (c) 2012-2018, Jan Breuer
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * * Redistributions of source code must retain the above copyright notice, this
+ *   list of conditions and the following disclaimer.
+ *
+ * * Redistributions in binary form must reproduce the above copyright notice,
+ *   this list of conditions and the following disclaimer in the documentation
+ *   and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+
+/**
+ * @file   status.c
+ *
+ * @brief  Status register tree of instrument subsystems and channels
+ *
+ * Tree is declared as array of scpi_status_node_def_t. Register nodes are
+ * ordinary SCPI status register groups (condition, event, enable and
+ * transition filters), possibly instantiated for many channels. Summary
+ * nodes collect summaries of any number of children in a bitmap, so a
+ * change is propagated to the root in O(depth) without scanning siblings.
+ * Root nodes report into a bit of a condition register in context.
+ */
+
+#include <string.h>
+
+#include "scpi/status.h"
+#include "scpi/ieee488.h"
+
+#define STATUS_WORD_BITS 32
+
+/**
+ * Get index of first node of definition
+ * @param defs
+ * @param def - index of definition
+ * @return index of node
+ */
+static size_t statusFirstNode(const scpi_status_node_def_t * defs, uint16_t def) {
+    size_t i;
+    size_t first = 0;
+
+    for (i = 0; i < def; i++) {
+        first += (defs[i].type == SCPI_STATUS_NODE_SUMMARY) ? 1 : defs[i].count;
+    }
+
+    return first;
+}
+
+/**
+ * Initialize status tree
+ * 
+ * Parent definition has to precede its children and has to have exactly
+ * one instance. Instances of register definition occupy consecutive bits
+ * in parent, starting with parent_bit.
+ * 
+ * @param context
+ * @param defs - declaration of tree
+ * @param defs_count - number of items in defs
+ * @param nodes - storage of nodes
+ * @param nodes_count - number of items in nodes
+ * @param bitmap - storage of summary bitmaps
+ * @param bitmap_words - number of items in bitmap
+ * @return TRUE if tree fits the storage and declaration is consistent
+ */
+scpi_bool_t SCPI_StatusTreeInit(scpi_t * context, const scpi_status_node_def_t * defs, size_t defs_count, scpi_status_node_t * nodes, size_t nodes_count, uint32_t * bitmap, size_t bitmap_words) {
+    size_t i;
+    size_t n = 0;
+    size_t words = 0;
+    uint16_t j;
+
+    if (!context) {
+        return FALSE;
+    }
+
+    memset(&context->status_tree, 0, sizeof (context->status_tree));
+
+    if (!defs || !nodes) {
+        return FALSE;
+    }
+
+    for (i = 0; i < defs_count; i++) {
+        const scpi_status_node_def_t * def = &defs[i];
+        size_t instances = (def->type == SCPI_STATUS_NODE_SUMMARY) ? 1 : def->count;
+        size_t capacity = 16;
+
+        if (def->parent == SCPI_STATUS_NODE_NONE) {
+            if (def->parent_reg >= SCPI_REG_COUNT) {
+                return FALSE;
+            }
+        } else if (def->parent >= i) {
+            return FALSE;
+        } else if (defs[def->parent].type == SCPI_STATUS_NODE_SUMMARY) {
+            capacity = defs[def->parent].count;
+        } else if (defs[def->parent].count != 1) {
+            return FALSE;
+        }
+
+        if (def->parent_bit + instances > capacity) {
+            return FALSE;
+        }
+
+        if (def->type == SCPI_STATUS_NODE_SUMMARY) {
+            words += (def->count + STATUS_WORD_BITS - 1) / STATUS_WORD_BITS;
+        }
+        n += instances;
+    }
+
+    if ((n > nodes_count) || (n >= SCPI_STATUS_NODE_NONE) || (words > 0 && (!bitmap || words > bitmap_words))) {
+        return FALSE;
+    }
+
+    memset(nodes, 0, n * sizeof (*nodes));
+    if (words) {
+        memset(bitmap, 0, words * sizeof (*bitmap));
+    }
+
+    n = 0;
+    for (i = 0; i < defs_count; i++) {
+        const scpi_status_node_def_t * def = &defs[i];
+        uint16_t parent = SCPI_STATUS_NODE_NONE;
+
+        if (def->parent != SCPI_STATUS_NODE_NONE) {
+            parent = (uint16_t) statusFirstNode(defs, def->parent);
+        }
+
+        if (def->type == SCPI_STATUS_NODE_SUMMARY) {
+            nodes[n].parent = parent;
+            nodes[n].parent_bit = def->parent_bit;
+            nodes[n].parent_reg = def->parent_reg;
+            nodes[n].summary = bitmap;
+            nodes[n].size = def->count;
+            bitmap += (def->count + STATUS_WORD_BITS - 1) / STATUS_WORD_BITS;
+            n++;
+        } else {
+            for (j = 0; j < def->count; j++) {
+                nodes[n].parent = parent;
+                nodes[n].parent_bit = def->parent_bit + j;
+                nodes[n].parent_reg = def->parent_reg;
+                nodes[n].enable = 0x7FFF;
+                nodes[n].ptfilt = 0x7FFF;
+                n++;
+            }
+        }
+    }
+
+    context->status_tree.defs = defs;
+    context->status_tree.defs_count = defs_count;
+    context->status_tree.nodes = nodes;
+    context->status_tree.nodes_count = n;
+
+    return TRUE;
+}
+
+/**
+ * Get node index of instance of definition
+ * @param context
+ * @param def - index of definition
+ * @param instance - instance (channel) of definition
+ * @return index of node or SCPI_STATUS_NODE_NONE
+ */
+uint16_t SCPI_StatusNode(scpi_t * context, uint16_t def, uint16_t instance) {
+    const scpi_status_node_def_t * defs;
+
+    if (!context || def >= context->status_tree.defs_count) {
+        return SCPI_STATUS_NODE_NONE;
+    }
+
+    defs = context->status_tree.defs;
+    if (instance >= ((defs[def].type == SCPI_STATUS_NODE_SUMMARY) ? 1 : defs[def].count)) {
+        return SCPI_STATUS_NODE_NONE;
+    }
+
+    return (uint16_t) (statusFirstNode(defs, def) + instance);
+}
+
+/**
+ * Get summary of node
+ * @param node
+ * @return TRUE if any enabled event is set or any child is active
+ */
+static scpi_bool_t statusSummary(const scpi_status_node_t * node) {
+    if (node->summary) {
+        return node->active ? TRUE : FALSE;
+    }
+    return (node->event & node->enable) ? TRUE : FALSE;
+}
+
+/**
+ * Set one register of register node
+ * @param node
+ * @param type - condition, event, enable or transition filter
+ * @param val - new value
+ * @return TRUE if summary of node has changed
+ */
+static scpi_bool_t statusApply(scpi_status_node_t * node, scpi_reg_class_t type, scpi_reg_val_t val) {
+    scpi_bool_t summary = statusSummary(node);
+    scpi_reg_val_t transitions;
+
+    switch (type) {
+        case SCPI_REG_CLASS_COND:
+            transitions = node->condition ^ val;
+            node->event |= (transitions & val & node->ptfilt) | (transitions & ~val & node->ntfilt);
+            node->condition = val;
+            break;
+        case SCPI_REG_CLASS_EVEN:
+            node->event = val;
+            break;
+        case SCPI_REG_CLASS_ENAB:
+            node->enable = val;
+            break;
+        case SCPI_REG_CLASS_PTR:
+            node->ptfilt = val;
+            break;
+        case SCPI_REG_CLASS_NTR:
+            node->ntfilt = val;
+            break;
+        default:
+            return FALSE;
+    }
+
+    return statusSummary(node) != summary;
+}
+
+/**
+ * Set or clear bit of root condition register. During bulk update the
+ * change is only collected in roots.
+ * @param context
+ * @param node - root node
+ * @param summary - new value of the bit
+ * @param roots - collected root registers or NULL
+ * @param roots_count - number of items in roots
+ */
+static void statusRootUpdate(scpi_t * context, const scpi_status_node_t * node, scpi_bool_t summary, scpi_reg_condition_t * roots, size_t * roots_count) {
+    scpi_reg_val_t mask = (scpi_reg_val_t) (1 << node->parent_bit);
+    size_t i;
+
+    if (!roots) {
+        if (summary) {
+            SCPI_RegSetBits(context, node->parent_reg, mask);
+        } else {
+            SCPI_RegClearBits(context, node->parent_reg, mask);
+        }
+        return;
+    }
+
+    for (i = 0; i < *roots_count; i++) {
+        if (roots[i].name == node->parent_reg) {
+            break;
+        }
+    }
+
+    if (i == *roots_count) {
+        roots[i].name = node->parent_reg;
+        roots[i].val = SCPI_RegGet(context, node->parent_reg);
+        (*roots_count)++;
+    }
+
+    if (summary) {
+        roots[i].val |= mask;
+    } else {
+        roots[i].val &= ~mask;
+    }
+}
+
+/**
+ * Propagate changed summary of node towards root. Propagation stops at
+ * first parent whose summary doesn't change.
+ * @param context
+ * @param index - node with changed summary
+ * @param roots - collected root registers or NULL
+ * @param roots_count - number of items in roots
+ */
+static void statusPropagate(scpi_t * context, uint16_t index, scpi_reg_condition_t * roots, size_t * roots_count) {
+    scpi_status_node_t * nodes = context->status_tree.nodes;
+    scpi_status_node_t * node = &nodes[index];
+    scpi_status_node_t * parent;
+    scpi_bool_t summary;
+    uint32_t * word;
+    uint32_t mask;
+
+    for (;;) {
+        summary = statusSummary(node);
+
+        if (node->parent == SCPI_STATUS_NODE_NONE) {
+            statusRootUpdate(context, node, summary, roots, roots_count);
+            return;
+        }
+
+        parent = &nodes[node->parent];
+        if (parent->summary) {
+            word = &parent->summary[node->parent_bit / STATUS_WORD_BITS];
+            mask = (uint32_t) 1 << (node->parent_bit % STATUS_WORD_BITS);
+            if (((*word & mask) ? TRUE : FALSE) == summary) {
+                return;
+            }
+            if (summary) {
+                *word |= mask;
+                if (parent->active++ != 0) {
+                    return;
+                }
+            } else {
+                *word &= ~mask;
+                if (--parent->active != 0) {
+                    return;
+                }
+            }
+        } else {
+            scpi_reg_val_t val = parent->condition;
+            if (summary) {
+                val |= (scpi_reg_val_t) (1 << node->parent_bit);
+            } else {
+                val &= (scpi_reg_val_t) ~(1 << node->parent_bit);
+            }
+            if (!statusApply(parent, SCPI_REG_CLASS_COND, val)) {
+                return;
+            }
+        }
+
+        node = parent;
+    }
+}
+
+/**
+ * Get register of register node
+ * @param context
+ * @param node - index of node
+ * @param type - condition, event, enable or transition filter
+ * @return register value
+ */
+scpi_reg_val_t SCPI_StatusGet(scpi_t * context, uint16_t node, scpi_reg_class_t type) {
+    const scpi_status_node_t * n;
+
+    if (!context || node >= context->status_tree.nodes_count) {
+        return 0;
+    }
+
+    n = &context->status_tree.nodes[node];
+    switch (type) {
+        case SCPI_REG_CLASS_COND:
+            return n->condition;
+        case SCPI_REG_CLASS_EVEN:
+            return n->event;
+        case SCPI_REG_CLASS_ENAB:
+            return n->enable;
+        case SCPI_REG_CLASS_PTR:
+            return n->ptfilt;
+        case SCPI_REG_CLASS_NTR:
+            return n->ntfilt;
+        default:
+            return 0;
+    }
+}
+
+/**
+ * Set register of register node and propagate its summary
+ * @param context
+ * @param node - index of node
+ * @param type - condition, event, enable or transition filter
+ * @param val - new value
+ */
+void SCPI_StatusSet(scpi_t * context, uint16_t node, scpi_reg_class_t type, scpi_reg_val_t val) {
+    if (!context || node >= context->status_tree.nodes_count || context->status_tree.nodes[node].summary) {
+        return;
+    }
+
+    if (statusApply(&context->status_tree.nodes[node], type, val)) {
+        statusPropagate(context, node, NULL, NULL);
+    }
+}
+
+/**
+ * Set condition registers of several nodes at once. Root condition
+ * registers are updated together at the end, so service is requested at
+ * most once for whole snapshot.
+ * @param context
+ * @param conditions - array of node conditions
+ * @param count - number of items in conditions
+ */
+void SCPI_StatusSetConditions(scpi_t * context, const scpi_status_condition_t * conditions, size_t count) {
+    scpi_reg_condition_t roots[SCPI_REG_COUNT];
+    size_t roots_count = 0;
+    size_t i;
+
+    if (!context || !conditions) {
+        return;
+    }
+
+    for (i = 0; i < count; i++) {
+        uint16_t node = conditions[i].node;
+        if (node >= context->status_tree.nodes_count || context->status_tree.nodes[node].summary) {
+            continue;
+        }
+        if (statusApply(&context->status_tree.nodes[node], SCPI_REG_CLASS_COND, conditions[i].val)) {
+            statusPropagate(context, node, roots, &roots_count);
+        }
+    }
+
+    SCPI_RegSetConditions(context, roots, roots_count);
+}
+
+/**
+ * Read and clear event registers of consecutive nodes, e.g. all
+ * channels of one definition
+ * @param context
+ * @param first - index of first node
+ * @param values - output array of event registers
+ * @param count - number of items in values
+ * @return number of nodes read
+ */
+size_t SCPI_StatusEventsRead(scpi_t * context, uint16_t first, scpi_reg_val_t * values, size_t count) {
+    size_t i;
+
+    if (!context || !values || first >= context->status_tree.nodes_count) {
+        return 0;
+    }
+
+    if (count > context->status_tree.nodes_count - first) {
+        count = context->status_tree.nodes_count - first;
+    }
+
+    for (i = 0; i < count; i++) {
+        uint16_t node = (uint16_t) (first + i);
+        values[i] = SCPI_StatusGet(context, node, SCPI_REG_CLASS_EVEN);
+        SCPI_StatusSet(context, node, SCPI_REG_CLASS_EVEN, 0);
+    }
+
+    return count;
+}
+
+/**
+ * Find next active child of summary node
+ * @param context
+ * @param node - index of summary node
+ * @param start - first bit to check
+ * @return bit number of active child, size of summary node if none or
+ *         SIZE_MAX if node is not a summary node, so loops over the
+ *         children end in every case
+ */
+size_t SCPI_StatusSummaryNext(scpi_t * context, uint16_t node, size_t start) {
+    const scpi_status_node_t * n;
+    uint32_t word;
+
+    if (!context || node >= context->status_tree.nodes_count) {
+        return SIZE_MAX;
+    }
+
+    n = &context->status_tree.nodes[node];
+    if (!n->summary) {
+        return SIZE_MAX;
+    }
+
+    while (start < n->size) {
+        word = n->summary[start / STATUS_WORD_BITS] >> (start % STATUS_WORD_BITS);
+        if (word == 0) {
+            /* skip rest of the word */
+            start = (start / STATUS_WORD_BITS + 1) * STATUS_WORD_BITS;
+            continue;
+        }
+        while (!(word & 1)) {
+            word >>= 1;
+            start++;
+        }
+        return (start < n->size) ? start : n->size;
+    }
+
+    return n->size;
+}
+
+/**
+ * Clear event registers of all nodes
+ * @param context
+ */
+void SCPI_StatusTreeClear(scpi_t * context) {
+    size_t i;
+
+    for (i = 0; i < context->status_tree.nodes_count; i++) {
+        SCPI_StatusSet(context, (uint16_t) i, SCPI_REG_CLASS_EVEN, 0);
+    }
+}
+
+/**
+ * Preset enable registers and transition filters of all nodes. Enable
+ * registers pass all bits, so summaries are masked only by enable
+ * registers of OPERation and QUEStionable groups.
+ * @param context
+ */
+void SCPI_StatusTreePreset(scpi_t * context) {
+    size_t i;
+
+    for (i = 0; i < context->status_tree.nodes_count; i++) {
+        SCPI_StatusSet(context, (uint16_t) i, SCPI_REG_CLASS_ENAB, 0x7FFF);
+        SCPI_StatusSet(context, (uint16_t) i, SCPI_REG_CLASS_PTR, 0x7FFF);
+        SCPI_StatusSet(context, (uint16_t) i, SCPI_REG_CLASS_NTR, 0);
+    }
+}
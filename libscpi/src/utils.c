@@ -768,7 +768,191 @@ char *OUR_strndup(const char *s, size_t n) {
 }
 #endif
 
-#if USE_DEVICE_DEPENDENT_ERROR_INFORMATION && !USE_MEMORY_ALLOCATION_FREE
+#if USE_DEVICE_DEPENDENT_ERROR_INFORMATION && !USE_MEMORY_ALLOCATION_FREE && USE_ERROR_INFO_RECORDS
+
+/*
+ * Error info in fixed size records. Free records are kept in doubly linked
+ * list, so any of them can be taken out in O(1). Info is preferably stored
+ * in the record selected by hash of the text. When that record is used,
+ * info goes to any free record and the hash record keeps it as alias, so
+ * the same text pushed later is found in one of the two and the record is
+ * shared (reference counted).
+ */
+
+#define RECORD_TRUNCATION_MARK "..."
+#define RECORD_TRUNCATION_MARK_LEN (sizeof (RECORD_TRUNCATION_MARK) - 1)
+
+static uint32_t recordHash(uint32_t hash, const char * s, size_t len) {
+    size_t i;
+
+    for (i = 0; i < len; i++) {
+        hash ^= (uint8_t) s[i];
+        hash *= 16777619UL;
+    }
+    return hash;
+}
+
+static scpi_bool_t recordMatch(const scpi_error_info_record_t * rec, const char * s, size_t len, size_t copy) {
+    return rec && rec->refs && (rec->refs < UINT16_MAX) && (rec->len == len)
+            && (memcmp(rec->text, s, copy) == 0)
+            && (memcmp(rec->text + copy, RECORD_TRUNCATION_MARK, len - copy) == 0);
+}
+
+static void recordUnlink(scpi_error_info_heap_t * heap, scpi_error_info_record_t * rec) {
+    if (rec->prev) {
+        rec->prev->next = rec->next;
+    } else {
+        heap->free = rec->next;
+    }
+    if (rec->next) {
+        rec->next->prev = rec->prev;
+    }
+    heap->count--;
+}
+
+static void recordLink(scpi_error_info_heap_t * heap, scpi_error_info_record_t * rec) {
+    rec->prev = NULL;
+    rec->next = heap->free;
+    if (heap->free) {
+        heap->free->prev = rec;
+    }
+    heap->free = rec;
+    heap->count++;
+}
+
+/**
+ * Initialize heap structure, the buffer is divided to records
+ * @param heap - pointer to manual allocated heap buffer
+ * @param error_info_heap - buffer for the heap
+ * @param error_info_heap_length - length of the heap
+ */
+void scpiheap_init(scpi_error_info_heap_t * heap, char * error_info_heap, size_t error_info_heap_length) {
+    size_t align = (size_t) ((uintptr_t) error_info_heap % sizeof (void *));
+    size_t i;
+
+    if (align) {
+        align = sizeof (void *) - align;
+    }
+    if (error_info_heap_length < align) {
+        error_info_heap_length = align;
+    }
+
+    heap->records = (scpi_error_info_record_t *) (error_info_heap + align);
+    heap->size = (error_info_heap_length - align) / sizeof (scpi_error_info_record_t);
+    heap->count = 0;
+    heap->free = NULL;
+    for (i = heap->size; i > 0; i--) {
+        heap->records[i - 1].refs = 0;
+        heap->records[i - 1].len = 0;
+        heap->records[i - 1].alias = NULL;
+        recordLink(heap, &heap->records[i - 1]);
+    }
+}
+
+/**
+ * Store string in a record, identical string already stored in its hash
+ * record or in the alias of the hash record is shared. String longer than
+ * the record is truncated and ends with "...".
+ *
+ * @param heap - pointer to manual allocated heap buffer
+ * @param s - current pointer of duplication string
+ * @param n - maximal length of the string
+ * @return - pointer of stored string or NULL, if no record is free.
+ */
+char * scpiheap_strndup(scpi_error_info_heap_t * heap, const char *s, size_t n) {
+    scpi_error_info_record_t * home;
+    scpi_error_info_record_t * rec;
+    size_t len;
+    size_t copy;
+    uint32_t hash;
+
+    if (!s || !heap || !heap->size || *s == '\0') {
+        return NULL;
+    }
+
+    len = SCPIDEFINE_strnlen(s, n);
+    copy = len;
+    if (len > SCPI_ERROR_INFO_RECORD_LENGTH - 1) {
+        len = SCPI_ERROR_INFO_RECORD_LENGTH - 1;
+        copy = len - RECORD_TRUNCATION_MARK_LEN;
+    }
+
+    hash = recordHash(2166136261UL, s, copy);
+    hash = recordHash(hash, RECORD_TRUNCATION_MARK, len - copy);
+    home = &heap->records[hash % heap->size];
+
+    if (recordMatch(home, s, len, copy)) {
+        rec = home;
+    } else if (recordMatch(home->alias, s, len, copy)) {
+        rec = home->alias;
+    } else {
+        rec = NULL;
+    }
+    if (rec) {
+        rec->refs++;
+        return rec->text;
+    }
+
+    rec = home;
+    if (rec->refs) {
+        rec = heap->free;
+        if (!rec) {
+            return NULL;
+        }
+        home->alias = rec;
+    }
+
+    recordUnlink(heap, rec);
+    memcpy(rec->text, s, copy);
+    memcpy(rec->text + copy, RECORD_TRUNCATION_MARK, len - copy);
+    rec->text[len] = '\0';
+    rec->len = (uint16_t) len;
+    rec->refs = 1;
+    return rec->text;
+}
+
+/**
+ * Return pointer and length of string, records are never split
+ *
+ * @param heap - pointer to manual allocated heap buffer
+ * @param s - pointer of stored string.
+ * @return len1 - lenght of the string.
+ * @return s2 - always NULL
+ * @return len2 - always 0
+ */
+scpi_bool_t scpiheap_get_parts(scpi_error_info_heap_t * heap, const char * s, size_t * len1, const char ** s2, size_t * len2) {
+    (void) heap;
+
+    if (!s || !len1 || !s2 || !len2) {
+        return FALSE;
+    }
+
+    *len1 = strlen(s);
+    *s2 = NULL;
+    *len2 = 0;
+    return TRUE;
+}
+
+/**
+ * Release string, the record is free when it is not shared any more
+ *
+ * @param heap - pointer to manual allocated heap buffer
+ * @param s - pointer of stored string
+ * @param rollback - not used
+ */
+void scpiheap_free(scpi_error_info_heap_t * heap, char * s, scpi_bool_t rollback) {
+    scpi_error_info_record_t * rec;
+
+    (void) rollback;
+    if (!s) return;
+
+    rec = (scpi_error_info_record_t *) (s - offsetof(scpi_error_info_record_t, text));
+    if (rec->refs && (--rec->refs == 0)) {
+        recordLink(heap, rec);
+    }
+}
+
+#elif USE_DEVICE_DEPENDENT_ERROR_INFORMATION && !USE_MEMORY_ALLOCATION_FREE
 
 /**
  * Initialize heap structure
@@ -1144,3 +1328,91 @@ uint64_t SCPI_Swap64(uint64_t val) {
             ((val & 0x00FF000000000000ull) >> 40) |
             ((val & 0xFF00000000000000ull) >> 56);
 }
+
+/**
+ * Convert float to IEEE 754 half precision (binary16), rounded to nearest
+ * even. Values out of range are converted to infinity.
+ * @param val
+ * @return half precision bits
+ */
+uint16_t SCPI_FloatToHalf(float val) {
+    uint32_t f;
+    uint32_t sign;
+    uint32_t mant;
+    uint32_t half;
+    uint32_t rem;
+    uint32_t shift;
+    int32_t exp;
+
+    memcpy(&f, &val, sizeof (f));
+    sign = (f >> 16) & 0x8000;
+    exp = (int32_t) ((f >> 23) & 0xFF);
+    mant = f & 0x7FFFFF;
+
+    if (exp == 0xFF) {
+        /* infinity or NaN */
+        return (uint16_t) (sign | 0x7C00 | (mant ? 0x200 : 0));
+    }
+
+    exp = exp - 127 + 15;
+    if (exp >= 0x1F) {
+        return (uint16_t) (sign | 0x7C00);
+    }
+
+    if (exp <= 0) {
+        /* subnormal half */
+        if (exp < -10) {
+            return (uint16_t) sign;
+        }
+        mant |= 0x800000;
+        shift = (uint32_t) (14 - exp);
+        half = mant >> shift;
+        rem = mant & ((1UL << shift) - 1);
+        if ((rem > (1UL << (shift - 1))) || ((rem == (1UL << (shift - 1))) && (half & 1))) {
+            half++;
+        }
+        return (uint16_t) (sign | half);
+    }
+
+    half = ((uint32_t) exp << 10) | (mant >> 13);
+    rem = mant & 0x1FFF;
+    if ((rem > 0x1000) || ((rem == 0x1000) && (half & 1))) {
+        /* carry to exponent is correct, including overflow to infinity */
+        half++;
+    }
+    return (uint16_t) (sign | half);
+}
+
+/**
+ * Convert IEEE 754 half precision (binary16) to float
+ * @param val - half precision bits
+ * @return
+ */
+float SCPI_HalfToFloat(uint16_t val) {
+    uint32_t sign = ((uint32_t) val & 0x8000) << 16;
+    uint32_t exp = (val >> 10) & 0x1F;
+    uint32_t mant = val & 0x3FF;
+    uint32_t f;
+    float result;
+
+    if (exp == 0x1F) {
+        f = sign | 0x7F800000 | (mant << 13);
+    } else if (exp == 0) {
+        if (mant == 0) {
+            f = sign;
+        } else {
+            /* normalize subnormal half */
+            exp = 127 - 15 + 1;
+            while (!(mant & 0x400)) {
+                mant <<= 1;
+                exp--;
+            }
+            f = sign | (exp << 23) | ((mant & 0x3FF) << 13);
+        }
+    } else {
+        f = sign | ((exp + 127 - 15) << 23) | (mant << 13);
+    }
+
+    memcpy(&result, &f, sizeof (result));
+    return result;
+}
@@ -26,11 +26,20 @@
  * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
  */
 
+/*
+ * Single threaded error queue, built here without USE_ATOMIC_ERROR_QUEUE
+ * regardless of the library configuration. The lock-free queue is tested
+ * by test_fifo_mpsc.c.
+ */
+
+#undef USE_ATOMIC_ERROR_QUEUE
+#define USE_ATOMIC_ERROR_QUEUE 0
+
 #include <stdio.h>
 #include <stdlib.h>
 #include "CUnit/Basic.h"
 
-#include "../src/fifo_private.h"
+#include "../src/fifo.c"
 
 /*
  * CUnit Test Suite
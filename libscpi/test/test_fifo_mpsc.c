@@ -0,0 +1,380 @@
+/*-
+ * BSD 2-Clause License
+ *
+ * Copyright (c) 2012-2018, Jan Breuer
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * * Redistributions of source code must retain the above copyright notice, this
+ *   list of conditions and the following disclaimer.
+ *
+ * * Redistributions in binary form must reproduce the above copyright notice,
+ *   this list of conditions and the following disclaimer in the documentation
+ *   and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/*
+ * Lock-free error queue, built here with USE_ATOMIC_ERROR_QUEUE regardless
+ * of the library configuration. Run "make test-tsan" to check the stress
+ * test with ThreadSanitizer.
+ */
+
+#define USE_ATOMIC_ERROR_QUEUE 1
+#define USE_LAZY_ERROR_INFO 0
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <limits.h>
+#include <pthread.h>
+#include <sched.h>
+#include "CUnit/Basic.h"
+
+#include "../src/fifo.c"
+#include "scpi/scpi.h"
+
+/*
+ * CUnit Test Suite
+ */
+
+static int init_suite(void) {
+    return 0;
+}
+
+static int clean_suite(void) {
+    return 0;
+}
+
+static void testFifoOverflow(void) {
+    scpi_fifo_t fifo;
+    scpi_error_t fifo_data[4];
+    scpi_error_t value;
+    int16_t count_value;
+    int16_t i;
+
+    fifo_init(&fifo, fifo_data, 4);
+
+    for (i = 1; i <= 4; i++) {
+        value.error_code = i;
+        CU_ASSERT_TRUE(fifo_add(&fifo, &value));
+    }
+    CU_ASSERT_TRUE(fifo_is_full(&fifo));
+
+    /* overflow replaces the last entry */
+    value.error_code = 5;
+    CU_ASSERT_FALSE(fifo_add(&fifo, &value));
+    CU_ASSERT_FALSE(fifo_add(&fifo, &value));
+    fifo_count(&fifo, &count_value);
+    CU_ASSERT_EQUAL(count_value, 4);
+
+    CU_ASSERT_TRUE(fifo_remove(&fifo, &value));
+    CU_ASSERT_EQUAL(value.error_code, 1);
+
+    value.error_code = 6;
+    CU_ASSERT_TRUE(fifo_add(&fifo, &value));
+
+    CU_ASSERT_TRUE(fifo_remove(&fifo, &value));
+    CU_ASSERT_EQUAL(value.error_code, 2);
+    CU_ASSERT_TRUE(fifo_remove(&fifo, &value));
+    CU_ASSERT_EQUAL(value.error_code, 3);
+    CU_ASSERT_TRUE(fifo_remove(&fifo, &value));
+    CU_ASSERT_EQUAL(value.error_code, SCPI_ERROR_QUEUE_OVERFLOW);
+    CU_ASSERT_TRUE(fifo_remove(&fifo, &value));
+    CU_ASSERT_EQUAL(value.error_code, 6);
+    CU_ASSERT_FALSE(fifo_remove(&fifo, &value));
+    CU_ASSERT_TRUE(fifo_is_empty(&fifo));
+
+    /* queue stays usable after clear */
+    for (i = 1; i <= 4; i++) {
+        value.error_code = i;
+        CU_ASSERT_TRUE(fifo_add(&fifo, &value));
+    }
+    fifo_clear(&fifo);
+    CU_ASSERT_TRUE(fifo_is_empty(&fifo));
+    value.error_code = 7;
+    CU_ASSERT_TRUE(fifo_add(&fifo, &value));
+    CU_ASSERT_TRUE(fifo_remove(&fifo, &value));
+    CU_ASSERT_EQUAL(value.error_code, 7);
+
+    /* not possible with concurrent producers */
+    CU_ASSERT_FALSE(fifo_remove_last(&fifo, &value));
+}
+
+static void testFifoWrap(void) {
+    scpi_fifo_t fifo;
+    scpi_error_t fifo_data[6];
+    scpi_error_t value;
+    unsigned start = UINT_MAX - 5;
+    unsigned k;
+    int16_t i;
+
+    /* size is rounded down to power of two */
+    fifo_init(&fifo, fifo_data, 6);
+    CU_ASSERT_EQUAL(fifo.size, 4);
+
+    /* positions close to wrap around of the counters */
+    atomic_store(&fifo.wr, start);
+    atomic_store(&fifo.rd, start);
+    for (k = 0; k < 4; k++) {
+        atomic_store(&fifo_data[(start + k) & 3].sequence, start + k);
+    }
+
+    for (i = 1; i <= 12; i++) {
+        value.error_code = i;
+        CU_ASSERT_TRUE(fifo_add(&fifo, &value));
+        CU_ASSERT_TRUE(fifo_remove(&fifo, &value));
+        CU_ASSERT_EQUAL(value.error_code, i);
+    }
+
+    /* overflow across the wrap around */
+    for (i = 1; i <= 5; i++) {
+        value.error_code = i;
+        CU_ASSERT_EQUAL(fifo_add(&fifo, &value), i <= 4);
+    }
+    for (i = 1; i <= 3; i++) {
+        CU_ASSERT_TRUE(fifo_remove(&fifo, &value));
+        CU_ASSERT_EQUAL(value.error_code, i);
+    }
+    CU_ASSERT_TRUE(fifo_remove(&fifo, &value));
+    CU_ASSERT_EQUAL(value.error_code, SCPI_ERROR_QUEUE_OVERFLOW);
+    CU_ASSERT_FALSE(fifo_remove(&fifo, &value));
+}
+
+#define STRESS_PRODUCERS    4
+#define STRESS_ITEMS        20000
+#define STRESS_QUEUE_SIZE   16
+
+typedef struct {
+    scpi_fifo_t * fifo;
+    int16_t id;
+    long added;
+} stress_producer_t;
+
+static atomic_int stress_running;
+
+static void * stressProducer(void * arg) {
+    stress_producer_t * producer = (stress_producer_t *) arg;
+    scpi_error_t value;
+    long i;
+
+    value.error_code = producer->id;
+    for (i = 0; i < STRESS_ITEMS; i++) {
+        /* sequence number travels in the info pointer */
+        value.device_dependent_info = (char *) (intptr_t) (i + 1);
+        while (!fifo_add(producer->fifo, &value)) {
+            sched_yield();
+        }
+        producer->added++;
+    }
+    atomic_fetch_sub(&stress_running, 1);
+    return NULL;
+}
+
+static void testFifoStress(void) {
+    scpi_fifo_t fifo;
+    scpi_error_t fifo_data[STRESS_QUEUE_SIZE];
+    stress_producer_t producers[STRESS_PRODUCERS];
+    pthread_t threads[STRESS_PRODUCERS];
+    intptr_t last[STRESS_PRODUCERS + 1];
+    long received = 0;
+    long overflows = 0;
+    long added = 0;
+    scpi_bool_t ordered = TRUE;
+    scpi_error_t value;
+    int i;
+
+    fifo_init(&fifo, fifo_data, STRESS_QUEUE_SIZE);
+    atomic_store(&stress_running, STRESS_PRODUCERS);
+
+    for (i = 0; i < STRESS_PRODUCERS; i++) {
+        producers[i].fifo = &fifo;
+        producers[i].id = (int16_t) (i + 1);
+        producers[i].added = 0;
+        last[i + 1] = 0;
+        CU_ASSERT_EQUAL(pthread_create(&threads[i], NULL, stressProducer, &producers[i]), 0);
+    }
+
+    /* single consumer */
+    for (;;) {
+        if (fifo_remove(&fifo, &value)) {
+            if (value.error_code == SCPI_ERROR_QUEUE_OVERFLOW) {
+                overflows++;
+            } else {
+                /* items of one producer keep their order */
+                if ((intptr_t) value.device_dependent_info <= last[value.error_code]) {
+                    ordered = FALSE;
+                }
+                last[value.error_code] = (intptr_t) value.device_dependent_info;
+                received++;
+            }
+        } else if (atomic_load(&stress_running) == 0 && fifo_is_empty(&fifo)) {
+            break;
+        }
+    }
+
+    for (i = 0; i < STRESS_PRODUCERS; i++) {
+        pthread_join(threads[i], NULL);
+        added += producers[i].added;
+    }
+
+    CU_ASSERT_TRUE(ordered);
+    CU_ASSERT_EQUAL(added, STRESS_PRODUCERS * STRESS_ITEMS);
+    /* every accepted entry is read once, either as itself or as overflow */
+    CU_ASSERT_EQUAL(received + overflows, added);
+}
+
+#define ASYNC_PRODUCERS     4
+#define ASYNC_ITEMS         5000
+#define ASYNC_QUEUE_SIZE    16
+#define ASYNC_ERROR_QUEUE_SIZE 8
+
+typedef struct {
+    scpi_t * context;
+    long accepted;
+} async_producer_t;
+
+static atomic_int async_running;
+static long async_errors;
+
+static size_t asyncWrite(scpi_t * context, const char * data, size_t len) {
+    (void) context;
+    (void) data;
+    return len;
+}
+
+static int asyncError(scpi_t * context, int_fast16_t err) {
+    (void) context;
+    if (err == SCPI_ERROR_EXECUTION_ERROR) {
+        async_errors++;
+    }
+    return 0;
+}
+
+static void * asyncProducer(void * arg) {
+    async_producer_t * producer = (async_producer_t *) arg;
+    long i;
+
+    for (i = 0; i < ASYNC_ITEMS; i++) {
+        if (SCPI_ErrorPushAsync(producer->context, SCPI_ERROR_EXECUTION_ERROR)) {
+            producer->accepted++;
+        }
+        if ((i % 64) == 0) {
+            sched_yield();
+        }
+    }
+    atomic_fetch_sub(&async_running, 1);
+    return NULL;
+}
+
+static void testErrorPushAsync(void) {
+    static const scpi_command_t commands[] = {
+        {.pattern = "*ESR?", .callback = SCPI_CoreEsrQ,},
+        {.pattern = "SYSTem:ERRor[:NEXT]?", .callback = SCPI_SystemErrorNextQ,},
+        SCPI_CMD_LIST_END
+    };
+    static const char input[] = "SYST:ERR?;SYST:ERR?;*ESR?\r\n";
+    scpi_interface_t interface = {
+        .error = asyncError,
+        .write = asyncWrite,
+    };
+    scpi_t context;
+    char input_buffer[64];
+    scpi_error_t error_queue_data[ASYNC_ERROR_QUEUE_SIZE];
+    scpi_error_t async_queue_data[ASYNC_QUEUE_SIZE];
+    uint32_t counters[SCPI_ERROR_COUNTERS_SIZE];
+    async_producer_t producers[ASYNC_PRODUCERS];
+    pthread_t threads[ASYNC_PRODUCERS];
+    long accepted = 0;
+    uint32_t executed;
+    int i;
+
+    SCPI_Init(&context, commands, &interface, scpi_units_def,
+            "MA", "IN", NULL, "VER",
+            input_buffer, sizeof (input_buffer),
+            error_queue_data, ASYNC_ERROR_QUEUE_SIZE);
+    SCPI_ErrorAsyncInit(&context, async_queue_data, ASYNC_QUEUE_SIZE);
+    SCPI_ErrorCountersInit(&context, counters, SCPI_ERROR_COUNTERS_SIZE);
+    async_errors = 0;
+
+    atomic_store(&async_running, ASYNC_PRODUCERS);
+    for (i = 0; i < ASYNC_PRODUCERS; i++) {
+        producers[i].context = &context;
+        producers[i].accepted = 0;
+        CU_ASSERT_EQUAL(pthread_create(&threads[i], NULL, asyncProducer, &producers[i]), 0);
+    }
+
+    /* parser keeps running while errors are pushed */
+    while (atomic_load(&async_running) > 0) {
+        SCPI_Input(&context, input, sizeof (input) - 1);
+    }
+
+    for (i = 0; i < ASYNC_PRODUCERS; i++) {
+        pthread_join(threads[i], NULL);
+        accepted += producers[i].accepted;
+    }
+    SCPI_ErrorAsyncApply(&context);
+    SCPI_ErrorClear(&context);
+
+    executed = SCPI_ErrorCounterGet(&context, SCPI_ERROR_EXECUTION_ERROR);
+    CU_ASSERT_TRUE(accepted > 0);
+    /* each accepted error is applied once, or replaced by overflow */
+    CU_ASSERT_TRUE(executed <= (uint32_t) accepted);
+    CU_ASSERT_TRUE(executed + SCPI_ErrorCounterGet(&context, SCPI_ERROR_QUEUE_OVERFLOW) >= (uint32_t) accepted);
+    CU_ASSERT_EQUAL(async_errors, (long) executed);
+    CU_ASSERT_EQUAL(SCPI_ErrorCount(&context), 0);
+
+    /* status is updated by the parser thread */
+    SCPI_RegSet(&context, SCPI_REG_ESR, 0);
+    CU_ASSERT_TRUE(SCPI_ErrorPushAsync(&context, SCPI_ERROR_EXECUTION_ERROR));
+    CU_ASSERT_EQUAL(SCPI_RegGet(&context, SCPI_REG_ESR), 0);
+    CU_ASSERT_FALSE(SCPI_RegGet(&context, SCPI_REG_STB) & STB_QMA);
+    SCPI_ErrorAsyncApply(&context);
+    CU_ASSERT_EQUAL(SCPI_RegGet(&context, SCPI_REG_ESR), ESR_EER);
+    CU_ASSERT_TRUE(SCPI_RegGet(&context, SCPI_REG_STB) & STB_QMA);
+    CU_ASSERT_EQUAL(SCPI_ErrorCount(&context), 1);
+}
+
+int main() {
+    unsigned int result;
+    CU_pSuite pSuite = NULL;
+
+    /* Initialize the CUnit test registry */
+    if (CUE_SUCCESS != CU_initialize_registry())
+        return CU_get_error();
+
+    /* Add a suite to the registry */
+    pSuite = CU_add_suite("FIFO MPSC", init_suite, clean_suite);
+    if (NULL == pSuite) {
+        CU_cleanup_registry();
+        return CU_get_error();
+    }
+
+    /* Add the tests to the suite */
+    if ((NULL == CU_add_test(pSuite, "overflow", testFifoOverflow))
+            || (NULL == CU_add_test(pSuite, "wrap", testFifoWrap))
+            || (NULL == CU_add_test(pSuite, "stress", testFifoStress))
+            || (NULL == CU_add_test(pSuite, "push async", testErrorPushAsync))) {
+        CU_cleanup_registry();
+        return CU_get_error();
+    }
+
+    /* Run all tests using the CUnit Basic interface */
+    CU_basic_set_mode(CU_BRM_VERBOSE);
+    CU_basic_run_tests();
+    result = CU_get_number_of_tests_failed();
+    CU_cleanup_registry();
+    return result ? result : CU_get_error();
+}
@@ -46,8 +46,8 @@ static int clean_suite(void) {
     return 0;
 }
 
-typedef int (*lexfn_t)(lex_state_t * state, scpi_token_t * token);
-typedef int (*lexfn2_t)(lex_state_t * state, scpi_token_t * token, int * cnt);
+typedef size_t (*lexfn_t)(lex_state_t * state, scpi_token_t * token);
+typedef size_t (*lexfn2_t)(lex_state_t * state, scpi_token_t * token, int * cnt);
 
 static const char * typeToStr(scpi_token_type_t type) {
     switch (type) {
@@ -82,8 +82,8 @@ static const char * typeToStr(scpi_token_type_t type) {
 static void printToken(scpi_token_t * token) {
     printf("Token:\r\n");
     printf("\t->type = %s\r\n", typeToStr(token->type));
-    printf("\t->ptr = %p (\"%.*s\")\r\n", token->ptr, token->len, token->ptr);
-    printf("\t->len = %d\r\n", token->len);
+    printf("\t->ptr = %p (\"%.*s\")\r\n", token->ptr, (int) token->len, token->ptr);
+    printf("\t->len = %d\r\n", (int) token->len);
 }
 
 
@@ -106,7 +106,7 @@ static void TEST_TOKEN(const char * str, lexfn_t fn, int offset, int len, scpi_t
     char * str = s;                             \
     lexfn_t fn = f;                             \
     int offset = o;                             \
-    int len = l;                                \
+    size_t len = l;                             \
     scpi_token_type_t tp = t;                   \
     lex_state_t state;                          \
     scpi_token_t token;                         \
@@ -181,6 +181,8 @@ static void testArbitraryBlock(void) {
     TEST_TOKEN("#12AB, ", scpiLex_ArbitraryBlockProgramData, 3, 2, SCPI_TOKEN_ARBITRARY_BLOCK_PROGRAM_DATA);
     TEST_TOKEN("#13AB", scpiLex_ArbitraryBlockProgramData, 0, 0, SCPI_TOKEN_UNKNOWN);
     TEST_TOKEN("#12\r\n, ", scpiLex_ArbitraryBlockProgramData, 3, 2, SCPI_TOKEN_ARBITRARY_BLOCK_PROGRAM_DATA);
+    TEST_TOKEN("#9000000003ABC", scpiLex_ArbitraryBlockProgramData, 11, 3, SCPI_TOKEN_ARBITRARY_BLOCK_PROGRAM_DATA);
+    TEST_TOKEN("#9999999999AB", scpiLex_ArbitraryBlockProgramData, 0, 0, SCPI_TOKEN_UNKNOWN);
     TEST_TOKEN("#02AB, ", scpiLex_ArbitraryBlockProgramData, 0, 0, SCPI_TOKEN_UNKNOWN);
     TEST_TOKEN("#12", scpiLex_ArbitraryBlockProgramData, 0, 0, SCPI_TOKEN_UNKNOWN);
     TEST_TOKEN("#1", scpiLex_ArbitraryBlockProgramData, 0, 0, SCPI_TOKEN_UNKNOWN);
@@ -252,7 +254,7 @@ static void testProgramData(void) {
     char * str = s;                             \
     lexfn2_t fn = f;                            \
     int offset = o;                             \
-    int len = l;                                \
+    size_t len = l;                             \
     scpi_token_type_t tp = t;                   \
     lex_state_t state;                          \
     scpi_token_t token;                         \
@@ -283,7 +285,7 @@ static void testAllProgramData(void) {
 #define TEST_DETECT(s, h, hl, ht, d, dc, t) do {                                \
     char * str = s;                                                             \
     scpi_parser_state_t state;                                                  \
-    int result;                                                                 \
+    size_t result;                                                              \
     result = scpiParser_detectProgramMessageUnit(&state, str, strlen(str));     \
     CU_ASSERT_EQUAL(state.programHeader.ptr, str + h);                          \
     CU_ASSERT_EQUAL(state.programHeader.len, hl);                               \
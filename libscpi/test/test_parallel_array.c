@@ -0,0 +1,264 @@
+/*-
+ * BSD 2-Clause License
+ *
+ * Copyright (c) 2012-2018, Jan Breuer
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * * Redistributions of source code must retain the above copyright notice, this
+ *   list of conditions and the following disclaimer.
+ *
+ * * Redistributions in binary form must reproduce the above copyright notice,
+ *   this list of conditions and the following disclaimer in the documentation
+ *   and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/*
+ * Parallel conversion of ASCII arrays, built here with
+ * USE_PARALLEL_ARRAY_CONVERSION and runtime threshold regardless of the
+ * library configuration. Results must be identical to the sequential path.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include "CUnit/Basic.h"
+
+static size_t parallel_threshold;
+
+#define USE_PARALLEL_ARRAY_CONVERSION 1
+#define SCPI_PARALLEL_ARRAY_THRESHOLD parallel_threshold
+
+#include "../src/parser.c"
+
+/*
+ * CUnit Test Suite
+ */
+
+static int init_suite(void) {
+    return 0;
+}
+
+static int clean_suite(void) {
+    return 0;
+}
+
+#define ITEMS 10007
+#define OUTPUT_SIZE (ITEMS * 32)
+
+static char * output;
+static size_t output_pos;
+
+static size_t SCPI_Write(scpi_t * context, const char * data, size_t len) {
+    (void) context;
+
+    if (len > (OUTPUT_SIZE - output_pos)) {
+        len = OUTPUT_SIZE - output_pos;
+    }
+    memcpy(output + output_pos, data, len);
+    output_pos += len;
+    return len;
+}
+
+static scpi_interface_t scpi_interface = {
+    .write = SCPI_Write,
+};
+
+static scpi_t scpi_context;
+static char input_buffer[16];
+static scpi_error_t error_queue[4];
+
+static void context_init(void) {
+    SCPI_Init(&scpi_context, NULL, &scpi_interface, NULL,
+            "MA", "IN", NULL, "VER",
+            input_buffer, sizeof (input_buffer),
+            error_queue, 4);
+    output_pos = 0;
+}
+
+static int32_t int_data[ITEMS];
+static double double_data[ITEMS];
+
+static void data_init(void) {
+    size_t i;
+
+    for (i = 0; i < ITEMS; i++) {
+        int_data[i] = (int32_t) ((i * 2654435761u) >> 1) * ((i & 1) ? -1 : 1);
+        double_data[i] = (double) int_data[i] / 1024.0 + 1e-3 * (double) i;
+    }
+    int_data[1] = INT32_MIN;
+    int_data[2] = INT32_MAX;
+    double_data[3] = 1.7976931348623157e308;
+    double_data[4] = -4.9e-324;
+}
+
+/**
+ * Format array on sequential and on parallel path with the same initial
+ * output_count and compare the output
+ */
+#define TEST_RESULT_ARRAY(func, array, count, prefix) {                     \
+    char * scalar;                                                          \
+    size_t scalar_pos;                                                      \
+    size_t result;                                                          \
+                                                                            \
+    parallel_threshold = SIZE_MAX;                                          \
+    output_pos = 0;                                                         \
+    scpi_context.output_count = prefix;                                     \
+    result = func(&scpi_context, array, count, SCPI_FORMAT_ASCII);          \
+    drainOutputBuffer(&scpi_context);                                       \
+    CU_ASSERT_EQUAL(result, output_pos);                                    \
+    scalar = malloc(output_pos);                                            \
+    memcpy(scalar, output, output_pos);                                     \
+    scalar_pos = output_pos;                                                \
+                                                                            \
+    parallel_threshold = 16;                                                \
+    output_pos = 0;                                                         \
+    scpi_context.output_count = prefix;                                     \
+    result = func(&scpi_context, array, count, SCPI_FORMAT_ASCII);          \
+    drainOutputBuffer(&scpi_context);                                       \
+    CU_ASSERT_EQUAL(result, output_pos);                                    \
+    CU_ASSERT_EQUAL(scpi_context.output_count, prefix + count);             \
+    CU_ASSERT_EQUAL(output_pos, scalar_pos);                                \
+    CU_ASSERT_EQUAL(memcmp(output, scalar, scalar_pos), 0);                 \
+    free(scalar);                                                           \
+}
+
+static void testResultArray(void) {
+    char out_buffer[64];
+
+    context_init();
+    data_init();
+
+    TEST_RESULT_ARRAY(SCPI_ResultArrayInt32, int_data, ITEMS, 0);
+    TEST_RESULT_ARRAY(SCPI_ResultArrayInt32, int_data, ITEMS, 1);
+    TEST_RESULT_ARRAY(SCPI_ResultArrayInt32, int_data, 128, 0);
+    TEST_RESULT_ARRAY(SCPI_ResultArrayInt32, int_data, 17, 0);
+    TEST_RESULT_ARRAY(SCPI_ResultArrayDouble, double_data, ITEMS, 0);
+    TEST_RESULT_ARRAY(SCPI_ResultArrayDouble, double_data, ITEMS, 1);
+
+    /* blocks are passed through the output buffer */
+    SCPI_InitOutputBuffer(&scpi_context, out_buffer, sizeof (out_buffer));
+    TEST_RESULT_ARRAY(SCPI_ResultArrayInt32, int_data, ITEMS, 0);
+    SCPI_InitOutputBuffer(&scpi_context, NULL, 0);
+}
+
+/**
+ * Parse the list on sequential and on parallel path and compare the result,
+ * items after o_count are undefined
+ */
+#define TEST_PARAM_ARRAY(T, func, list, len, i_count) {                     \
+    T * scalar = calloc(i_count, sizeof (T));                               \
+    T * parallel = calloc(i_count, sizeof (T));                             \
+    scpi_bool_t scalar_result;                                              \
+    scpi_bool_t parallel_result;                                            \
+    size_t scalar_count = 0;                                                \
+    size_t parallel_count = 0;                                              \
+    const char * scalar_pos;                                                \
+                                                                            \
+    parallel_threshold = SIZE_MAX;                                          \
+    SCPI_ErrorClear(&scpi_context);                                         \
+    scpi_context.input_count = 0;                                           \
+    scpi_context.param_list.lex_state.buffer = (char *) (list);             \
+    scpi_context.param_list.lex_state.len = (len);                          \
+    scpi_context.param_list.lex_state.pos = (char *) (list);                \
+    scalar_result = func(&scpi_context, scalar, i_count, &scalar_count, SCPI_FORMAT_ASCII, TRUE);\
+    scalar_pos = scpi_context.param_list.lex_state.pos;                     \
+                                                                            \
+    parallel_threshold = 16;                                                \
+    SCPI_ErrorClear(&scpi_context);                                         \
+    scpi_context.input_count = 0;                                           \
+    scpi_context.param_list.lex_state.pos = (char *) (list);                \
+    parallel_result = func(&scpi_context, parallel, i_count, &parallel_count, SCPI_FORMAT_ASCII, TRUE);\
+                                                                            \
+    CU_ASSERT_EQUAL(parallel_result, scalar_result);                        \
+    CU_ASSERT_EQUAL(parallel_count, scalar_count);                          \
+    CU_ASSERT_EQUAL(memcmp(parallel, scalar, scalar_count * sizeof (T)), 0); \
+    if (scalar_result) {                                                    \
+        CU_ASSERT_EQUAL(scpi_context.param_list.lex_state.pos, scalar_pos); \
+    }                                                                       \
+    free(scalar);                                                           \
+    free(parallel);                                                         \
+}
+
+static void testParamArray(void) {
+    char * list;
+    size_t len;
+
+    context_init();
+    data_init();
+
+    parallel_threshold = SIZE_MAX;
+    SCPI_ResultArrayInt32(&scpi_context, int_data, ITEMS, SCPI_FORMAT_ASCII);
+    /* input buffer is always terminated */
+    list = malloc(output_pos + 1);
+    len = output_pos;
+    memcpy(list, output, len);
+    list[len] = '\0';
+
+    TEST_PARAM_ARRAY(int32_t, SCPI_ParamArrayInt32, list, len, ITEMS);
+    TEST_PARAM_ARRAY(int64_t, SCPI_ParamArrayInt64, list, len, ITEMS);
+    /* array shorter than the list */
+    TEST_PARAM_ARRAY(int32_t, SCPI_ParamArrayInt32, list, len, ITEMS - 1);
+
+    /* invalid item in the middle of the list */
+    list[len / 2] = 'X';
+    TEST_PARAM_ARRAY(int32_t, SCPI_ParamArrayInt32, list, len, ITEMS);
+    free(list);
+
+    output_pos = 0;
+    SCPI_ResultArrayDouble(&scpi_context, double_data, ITEMS, SCPI_FORMAT_ASCII);
+    list = malloc(output_pos + 1);
+    len = output_pos;
+    memcpy(list, output, len);
+    list[len] = '\0';
+
+    TEST_PARAM_ARRAY(double, SCPI_ParamArrayDouble, list, len, ITEMS);
+    free(list);
+}
+
+int main() {
+    unsigned int result;
+    CU_pSuite pSuite = NULL;
+
+    output = malloc(OUTPUT_SIZE);
+
+    /* Initialize the CUnit test registry */
+    if (CUE_SUCCESS != CU_initialize_registry())
+        return CU_get_error();
+
+    /* Add a suite to the registry */
+    pSuite = CU_add_suite("Parallel array conversion", init_suite, clean_suite);
+    if (NULL == pSuite) {
+        CU_cleanup_registry();
+        return CU_get_error();
+    }
+
+    /* Add the tests to the suite */
+    if ((NULL == CU_add_test(pSuite, "result array", testResultArray))
+            || (NULL == CU_add_test(pSuite, "param array", testParamArray))) {
+        CU_cleanup_registry();
+        return CU_get_error();
+    }
+
+    /* Run all tests using the CUnit Basic interface */
+    CU_basic_set_mode(CU_BRM_VERBOSE);
+    CU_basic_run_tests();
+    result = CU_get_number_of_tests_failed();
+    CU_cleanup_registry();
+    free(output);
+    return result ? result : CU_get_error();
+}
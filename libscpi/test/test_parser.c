@@ -28,6 +28,7 @@
 
 #include <stdio.h>
 #include <stdlib.h>
+#include <unistd.h>
 #include "CUnit/Basic.h"
 
 #include "scpi/scpi.h"
@@ -61,6 +62,20 @@ static scpi_result_t test_treeA(scpi_t* context) {
     return SCPI_RES_OK;
 }
 
+static int32_t sweep_handles[4];
+static int sweep_count = 0;
+
+static scpi_result_t test_sweep(scpi_t* context) {
+    int32_t handle = SCPI_OperationBegin(context);
+
+    if (handle < 0) {
+        return SCPI_RES_ERR;
+    }
+    sweep_handles[sweep_count++ % 4] = handle;
+
+    return SCPI_RES_PENDING;
+}
+
 static scpi_result_t test_treeB(scpi_t* context) {
 
     SCPI_ResultInt32(context, 20);
@@ -79,6 +94,93 @@ static scpi_result_t SCPI_Sample(scpi_t * context) {
     return SCPI_RES_OK;
 }
 
+static size_t test_stream_counter;
+
+static size_t test_stream_producer(scpi_t * context, void * user_data, char * buffer, size_t len) {
+    size_t i;
+    size_t * limit = (size_t *) user_data;
+    (void) context;
+
+    for (i = 0; (i < len) && (test_stream_counter < *limit); i++) {
+        buffer[i] = (char) ('a' + test_stream_counter++ % 26);
+    }
+    return i;
+}
+
+static size_t test_stream_limit;
+
+static scpi_result_t test_stream(scpi_t * context) {
+    int32_t len;
+    scpi_bool_t indefinite = FALSE;
+
+    if (!SCPI_ParamInt32(context, &len, TRUE)) return SCPI_RES_ERR;
+    SCPI_ParamBool(context, &indefinite, FALSE);
+
+    test_stream_counter = 0;
+    test_stream_limit = len;
+    SCPI_ResultArbitraryBlockStream(context, indefinite ? SCPI_BLOCK_LENGTH_UNKNOWN : (size_t) len, test_stream_producer, &test_stream_limit);
+    return SCPI_RES_OK;
+}
+
+static scpi_result_t test_indefinite(scpi_t * context) {
+    int32_t count;
+
+    if (!SCPI_ParamInt32(context, &count, TRUE)) return SCPI_RES_ERR;
+
+    SCPI_ResultArbitraryBlockIndefiniteHeader(context);
+    while (count-- > 0) {
+        SCPI_ResultArbitraryBlockIndefiniteData(context, "abc", 3);
+    }
+    return SCPI_RES_OK;
+}
+
+static scpi_result_t test_data(scpi_t * context) {
+    const double data[] = {1.5, -2, 100000.25};
+
+    SCPI_ResultDataArrayDouble(context, data, 3);
+    return SCPI_RES_OK;
+}
+
+static char test_large_chunk[1024 * 1024];
+static size_t test_large_remaining;
+
+static size_t test_large_producer(scpi_t * context, void * user_data, char * buffer, size_t len) {
+    size_t * remaining = (size_t *) user_data;
+
+    (void) context;
+    (void) buffer;
+
+    /* synthetic data, buffer content is not checked */
+    if (len > *remaining) {
+        len = *remaining;
+    }
+    *remaining -= len;
+    return len;
+}
+
+static scpi_result_t test_large(scpi_t * context) {
+    uint64_t len;
+    scpi_bool_t stream = FALSE;
+    size_t chunk;
+
+    if (!SCPI_ParamUInt64(context, &len, TRUE)) return SCPI_RES_ERR;
+    SCPI_ParamBool(context, &stream, FALSE);
+
+    test_large_remaining = (size_t) len;
+    if (stream) {
+        SCPI_ResultArbitraryBlockStream(context, (size_t) len, test_large_producer, &test_large_remaining);
+        return SCPI_RES_OK;
+    }
+
+    SCPI_ResultArbitraryBlockHeader(context, (size_t) len);
+    while (test_large_remaining > 0) {
+        chunk = test_large_remaining < sizeof (test_large_chunk) ? test_large_remaining : sizeof (test_large_chunk);
+        SCPI_ResultArbitraryBlockData(context, test_large_chunk, chunk);
+        test_large_remaining -= chunk;
+    }
+    return SCPI_RES_OK;
+}
+
 static const scpi_command_t scpi_commands[] = {
     /* IEEE Mandated Commands (SCPI std V1999.0 4.1.1) */
     { .pattern = "*CLS", .callback = SCPI_CoreCls,},
@@ -97,25 +199,46 @@ static const scpi_command_t scpi_commands[] = {
 
     /* Required SCPI commands (SCPI std V1999.0 4.2.1) */
     { .pattern = "SYSTem:ERRor[:NEXT]?", .callback = SCPI_SystemErrorNextQ,},
+    { .pattern = "SYSTem:ERRor:ALL?", .callback = SCPI_SystemErrorAllQ,},
     { .pattern = "SYSTem:ERRor:COUNt?", .callback = SCPI_SystemErrorCountQ,},
+    { .pattern = "SYSTem:ERRor:STATistics?", .callback = SCPI_SystemErrorStatisticsQ,},
     { .pattern = "SYSTem:VERSion?", .callback = SCPI_SystemVersionQ,},
 
     { .pattern = "STATus:QUEStionable[:EVENt]?", .callback = SCPI_StatusQuestionableEventQ,},
     { .pattern = "STATus:QUEStionable:CONDition?", .callback = SCPI_StatusQuestionableConditionQ,},
     { .pattern = "STATus:QUEStionable:ENABle", .callback = SCPI_StatusQuestionableEnable,},
     { .pattern = "STATus:QUEStionable:ENABle?", .callback = SCPI_StatusQuestionableEnableQ,},
+    { .pattern = "STATus:QUEStionable:PTRansition", .callback = SCPI_StatusQuestionablePtransition,},
+    { .pattern = "STATus:QUEStionable:PTRansition?", .callback = SCPI_StatusQuestionablePtransitionQ,},
+    { .pattern = "STATus:QUEStionable:NTRansition", .callback = SCPI_StatusQuestionableNtransition,},
+    { .pattern = "STATus:QUEStionable:NTRansition?", .callback = SCPI_StatusQuestionableNtransitionQ,},
 
     {.pattern = "STATus:OPERation[:EVENt]?", .callback = SCPI_StatusOperationEventQ, },
     {.pattern = "STATus:OPERation:CONDition?", .callback = SCPI_StatusOperationConditionQ, },
     {.pattern = "STATus:OPERation:ENABle", .callback = SCPI_StatusOperationEnable, },
     {.pattern = "STATus:OPERation:ENABle?", .callback = SCPI_StatusOperationEnableQ, },
+    {.pattern = "STATus:OPERation:PTRansition", .callback = SCPI_StatusOperationPtransition, },
+    {.pattern = "STATus:OPERation:PTRansition?", .callback = SCPI_StatusOperationPtransitionQ, },
+    {.pattern = "STATus:OPERation:NTRansition", .callback = SCPI_StatusOperationNtransition, },
+    {.pattern = "STATus:OPERation:NTRansition?", .callback = SCPI_StatusOperationNtransitionQ, },
 
     { .pattern = "STATus:PRESet", .callback = SCPI_StatusPreset,},
+    { .pattern = "STATus:SNAPshot?", .callback = SCPI_StatusSnapshotQ,},
 
     { .pattern = "TEXTfunction?", .callback = text_function,},
 
     { .pattern = "TEST:TREEA?", .callback = test_treeA,},
     { .pattern = "TEST:TREEB?", .callback = test_treeB,},
+    { .pattern = "TEST:SWEep", .callback = test_sweep,},
+    { .pattern = "TEST:STReam?", .callback = test_stream,},
+    { .pattern = "TEST:INDefinite?", .callback = test_indefinite,},
+    { .pattern = "TEST:LARGe?", .callback = test_large,},
+    { .pattern = "TEST:DATA?", .callback = test_data,},
+
+    { .pattern = "FORMat[:DATA]", .callback = SCPI_FormatData,},
+    { .pattern = "FORMat[:DATA]?", .callback = SCPI_FormatDataQ,},
+    { .pattern = "FORMat:BORDer", .callback = SCPI_FormatBorder,},
+    { .pattern = "FORMat:BORDer?", .callback = SCPI_FormatBorderQ,},
 
     { .pattern = "STUB", .callback = SCPI_Stub,},
     { .pattern = "STUB?", .callback = SCPI_StubQ,},
@@ -159,16 +282,36 @@ static void error_buffer_add(int_fast16_t err) {
     err_buffer_pos++;
 }
 
+size_t write_limit = (size_t) -1;
+size_t write_count = 0;
+
 static size_t SCPI_Write(scpi_t * context, const char * data, size_t len) {
     (void) context;
 
+    write_count++;
+    if (len > write_limit) {
+        len = write_limit;
+    }
+    write_limit -= len;
+
     return output_buffer_write(data, len);
 }
 
+/* every flush_release-th flush lets the interface accept flush_write_limit bytes */
+size_t flush_count = 0;
+size_t flush_release = 0;
+size_t flush_write_limit = 0;
+scpi_result_t flush_result = SCPI_RES_OK;
+
 static scpi_result_t SCPI_Flush(scpi_t * context) {
     (void) context;
 
-    return SCPI_RES_OK;
+    flush_count++;
+    if ((flush_release > 0) && ((flush_count % flush_release) == 0)) {
+        write_limit = flush_write_limit;
+    }
+
+    return flush_result;
 }
 
 static int SCPI_Error(scpi_t * context, int_fast16_t err) {
@@ -180,12 +323,14 @@ static int SCPI_Error(scpi_t * context, int_fast16_t err) {
 }
 
 scpi_reg_val_t srq_val = 0;
+int srq_count = 0;
 
 static scpi_result_t SCPI_Control(scpi_t * context, scpi_ctrl_name_t ctrl, scpi_reg_val_t val) {
     (void) context;
 
     if (SCPI_CTRL_SRQ == ctrl) {
         srq_val = val;
+        srq_count++;
     } else {
         fprintf(stderr, "**CTRL %02x: 0x%X (%d)\r\n", ctrl, val, val);
     }
@@ -215,7 +360,11 @@ static char scpi_input_buffer[SCPI_INPUT_BUFFER_LENGTH];
 #define SCPI_ERROR_QUEUE_SIZE 4
 static scpi_error_t scpi_error_queue_data[SCPI_ERROR_QUEUE_SIZE];
 
+#if USE_ERROR_INFO_RECORDS
+#define SCPI_ERROR_INFO_HEAP_SIZE ((SCPI_ERROR_QUEUE_SIZE + 1) * sizeof (scpi_error_info_record_t) + sizeof (void *))
+#else
 #define SCPI_ERROR_INFO_HEAP_SIZE 16
+#endif
 static char error_info_heap[SCPI_ERROR_INFO_HEAP_SIZE];
 
 static int init_suite(void) {
@@ -368,7 +517,7 @@ static void testErrorHandlingDeviceDependent(void) {
 #if USE_DEVICE_DEPENDENT_ERROR_INFORMATION
     TEST_CMDERR("-101,\"Invalid character;Test6\"\r\n");
     TEST_CMDERR("-101,\"Invalid character;Test7\"\r\n");
-#if USE_MEMORY_ALLOCATION_FREE
+#if USE_MEMORY_ALLOCATION_FREE || USE_ERROR_INFO_RECORDS
     TEST_CMDERR("-101,\"Invalid character;Test8\"\r\n");
 #else /* USE_MEMORY_ALLOCATION_FREE */
     TEST_CMDERR("-101,\"Invalid character\"\r\n");
@@ -446,6 +595,20 @@ static void testIEEE4882(void) {
 #endif /* USE_DEVICE_DEPENDENT_ERROR_INFORMATION */
     scpi_context.interface->control = SCPI_Control;
 
+    /* flood of undefined headers, first error read in the same message */
+#if USE_DEVICE_DEPENDENT_ERROR_INFORMATION
+    TEST_IEEE4882("AB1;AB2;AB3;AB4;AB5;AB6;:SYST:ERR:NEXT?\r\n", "-113,\"Undefined header;AB1;\"\r\n");
+    TEST_IEEE4882("SYST:ERR:NEXT?\r\n", "-113,\"Undefined header;AB2;\"\r\n");
+    TEST_IEEE4882("SYST:ERR:NEXT?\r\n", "-113,\"Undefined header;AB3;\"\r\n");
+#else /* USE_DEVICE_DEPENDENT_ERROR_INFORMATION */
+    TEST_IEEE4882("AB1;AB2;AB3;AB4;AB5;AB6;:SYST:ERR:NEXT?\r\n", "-113,\"Undefined header\"\r\n");
+    TEST_IEEE4882("SYST:ERR:NEXT?\r\n", "-113,\"Undefined header\"\r\n");
+    TEST_IEEE4882("SYST:ERR:NEXT?\r\n", "-113,\"Undefined header\"\r\n");
+#endif /* USE_DEVICE_DEPENDENT_ERROR_INFORMATION */
+    TEST_IEEE4882("SYST:ERR:NEXT?\r\n", "-350,\"Queue overflow\"\r\n");
+    TEST_IEEE4882("SYST:ERR:NEXT?\r\n", "0,\"No error\"\r\n");
+    TEST_IEEE4882("*ESR?\r\n", "32\r\n");
+
     RST_executed = FALSE;
     TEST_IEEE4882("*RST\r\n", "");
     CU_ASSERT_EQUAL(RST_executed, TRUE);
@@ -514,6 +677,300 @@ static void testIEEE4882(void) {
     TEST_IEEE4882_REG(SCPI_REG_OPERE, 1);
 }
 
+static void testStatusTransitionFilters(void) {
+    scpi_reg_condition_t snapshot[2];
+
+    TEST_IEEE4882("*CLS\r\n", "");
+    TEST_IEEE4882("STATus:PRESet\r\n", "");
+    TEST_IEEE4882("STATus:QUEStionable:PTRansition?\r\n", "32767\r\n");
+    TEST_IEEE4882("STATus:QUEStionable:NTRansition?\r\n", "0\r\n");
+    TEST_IEEE4882("STATus:OPERation:PTRansition?\r\n", "32767\r\n");
+    TEST_IEEE4882("STATus:OPERation:NTRansition?\r\n", "0\r\n");
+
+    /* negative transitions only */
+    TEST_IEEE4882("STATus:QUEStionable:PTRansition 0\r\n", "");
+    TEST_IEEE4882("STATus:QUEStionable:NTRansition 4\r\n", "");
+    TEST_IEEE4882_REG(SCPI_REG_QUESP, 0);
+    TEST_IEEE4882_REG(SCPI_REG_QUESN, 4);
+    TEST_IEEE4882_REG_SET(SCPI_REG_QUESC, 6);
+    TEST_IEEE4882("STATus:QUEStionable:EVENt?\r\n", "0\r\n");
+    TEST_IEEE4882_REG_SET(SCPI_REG_QUESC, 2);
+    TEST_IEEE4882("STATus:QUEStionable:EVENt?\r\n", "4\r\n");
+    TEST_IEEE4882_REG_SET(SCPI_REG_QUESC, 0);
+    TEST_IEEE4882("STATus:QUEStionable:EVENt?\r\n", "0\r\n");
+
+    /* both transitions */
+    TEST_IEEE4882("STATus:OPERation:PTRansition 1;NTRansition 1\r\n", "");
+    TEST_IEEE4882_REG_SET(SCPI_REG_OPERC, 3);
+    TEST_IEEE4882("STATus:OPERation:EVENt?\r\n", "1\r\n");
+    TEST_IEEE4882_REG_SET(SCPI_REG_OPERC, 0);
+    TEST_IEEE4882("STATus:OPERation:EVENt?\r\n", "1\r\n");
+
+    /* snapshot of conditions requests service once */
+    TEST_IEEE4882("STATus:PRESet\r\n", "");
+    TEST_IEEE4882("STATus:QUEStionable:ENABle 65535\r\n", "");
+    TEST_IEEE4882("STATus:OPERation:ENABle 65535\r\n", "");
+    TEST_IEEE4882("*SRE 136\r\n", "");
+    srq_count = 0;
+    srq_val = 0;
+    snapshot[0].name = SCPI_REG_QUESC;
+    snapshot[0].val = 1;
+    snapshot[1].name = SCPI_REG_OPERC;
+    snapshot[1].val = 2;
+    SCPI_RegSetConditions(&scpi_context, snapshot, 2);
+    SCPI_RegServiceRequestFlush(&scpi_context);
+    CU_ASSERT_EQUAL(srq_count, 1);
+    CU_ASSERT_EQUAL(srq_val, STB_QES | STB_OPS | STB_SRQ);
+    TEST_IEEE4882_REG(SCPI_REG_QUES, 1);
+    TEST_IEEE4882_REG(SCPI_REG_OPER, 2);
+
+    /* unchanged snapshot makes no transitions */
+    SCPI_RegSetConditions(&scpi_context, snapshot, 2);
+    SCPI_RegServiceRequestFlush(&scpi_context);
+    CU_ASSERT_EQUAL(srq_count, 1);
+
+    snapshot[0].val = 0;
+    snapshot[1].val = 0;
+    SCPI_RegSetConditions(&scpi_context, snapshot, 2);
+    SCPI_RegServiceRequestFlush(&scpi_context);
+    CU_ASSERT_EQUAL(srq_count, 1);
+    TEST_IEEE4882("*STB?\r\n", "200\r\n");
+
+    TEST_IEEE4882("*SRE 0\r\n", "");
+    TEST_IEEE4882("STATus:QUEStionable:ENABle 0\r\n", "");
+    TEST_IEEE4882("STATus:OPERation:ENABle 0\r\n", "");
+    TEST_IEEE4882("*CLS\r\n", "");
+    TEST_IEEE4882("*STB?\r\n", "0\r\n");
+}
+
+static void testServiceRequestCoalescing(void) {
+    scpi_reg_val_t ese = SCPI_RegGet(&scpi_context, SCPI_REG_ESE);
+    scpi_reg_val_t sre = SCPI_RegGet(&scpi_context, SCPI_REG_SRE);
+    int i;
+
+    TEST_IEEE4882("*CLS\r\n", "");
+    TEST_IEEE4882("*ESE 32;*SRE 32\r\n", "");
+
+    /* two rising request service in one message */
+    srq_count = 0;
+    TEST_IEEE4882("ABCD;*CLS;ABCD\r\n", "");
+#if USE_SRQ_COALESCING
+    CU_ASSERT_EQUAL(srq_count, 1);
+#else
+    /* ESR and error queue bits of STB rise for each error */
+    CU_ASSERT_EQUAL(srq_count, 4);
+#endif
+    CU_ASSERT_EQUAL(srq_val, STB_ESR | STB_SRQ | STB_QMA);
+    CU_ASSERT_FALSE(SCPI_RegServiceRequestFlush(&scpi_context));
+    TEST_IEEE4882("*CLS\r\n", "");
+
+    /* burst of events outside of parser */
+    srq_count = 0;
+    for (i = 0; i < 50; i++) {
+        SCPI_RegSetBits(&scpi_context, SCPI_REG_ESR, ESR_CER);
+        SCPI_RegClearBits(&scpi_context, SCPI_REG_ESR, ESR_CER);
+    }
+#if USE_SRQ_COALESCING
+    CU_ASSERT_EQUAL(srq_count, 0);
+    CU_ASSERT_TRUE(SCPI_RegServiceRequestFlush(&scpi_context));
+    CU_ASSERT_EQUAL(srq_count, 1);
+#else
+    CU_ASSERT_EQUAL(srq_count, 50);
+#endif
+    CU_ASSERT_FALSE(SCPI_RegServiceRequestFlush(&scpi_context));
+
+    TEST_IEEE4882("*CLS\r\n", "");
+
+    /* restore registers used by other tests */
+    SCPI_RegSet(&scpi_context, SCPI_REG_ESE, ese);
+    SCPI_RegSet(&scpi_context, SCPI_REG_SRE, sre);
+}
+
+static void testStatusSnapshot(void) {
+    scpi_reg_val_t ese = SCPI_RegGet(&scpi_context, SCPI_REG_ESE);
+    scpi_reg_val_t sre = SCPI_RegGet(&scpi_context, SCPI_REG_SRE);
+
+    TEST_IEEE4882("*CLS;*SRE 0;STATus:PRESet\r\n", "");
+    TEST_IEEE4882("STATus:QUEStionable:ENABle 0;:STATus:OPERation:ENABle 0\r\n", "");
+    TEST_IEEE4882("*ESE 16\r\n", "");
+    TEST_IEEE4882_REG_SET(SCPI_REG_OPERC, 4);
+    TEST_IEEE4882_REG_SET(SCPI_REG_QUESC, 2);
+
+    /* STB, SRE, ESR, ESE, OPER, OPERE, OPERC, QUES, QUESE, QUESC, OPERP, OPERN, QUESP, QUESN */
+    TEST_IEEE4882("STATus:SNAPshot?\r\n", "0,0,0,16,4,0,4,2,0,2,32767,0,32767,0\r\n");
+    TEST_IEEE4882("STATus:SNAPshot? OFF\r\n", "0,0,0,16,4,0,4,2,0,2,32767,0,32767,0\r\n");
+    TEST_IEEE4882("STATus:SNAPshot? ON\r\n", "0,0,0,16,4,0,4,2,0,2,32767,0,32767,0\r\n");
+    TEST_IEEE4882("STATus:SNAPshot?\r\n", "0,0,0,16,0,0,4,0,0,2,32767,0,32767,0\r\n");
+
+    TEST_IEEE4882_REG_SET(SCPI_REG_OPERC, 0);
+    TEST_IEEE4882_REG_SET(SCPI_REG_QUESC, 0);
+
+    /* restore registers used by other tests */
+    SCPI_RegSet(&scpi_context, SCPI_REG_ESE, ese);
+    SCPI_RegSet(&scpi_context, SCPI_REG_SRE, sre);
+}
+
+static void testOverlappedCommands(void) {
+    TEST_IEEE4882("*CLS\r\n", "");
+    CU_ASSERT_FALSE(SCPI_OperationPending(&scpi_context));
+
+    /* *OPC sets ESR OPC at completion, other commands are executed */
+    sweep_count = 0;
+    TEST_IEEE4882("TEST:SWEep;*OPC\r\n", "");
+    CU_ASSERT_TRUE(SCPI_OperationPending(&scpi_context));
+    TEST_IEEE4882("*ESR?\r\n", "0\r\n");
+    SCPI_OperationComplete(&scpi_context, sweep_handles[0]);
+    CU_ASSERT_FALSE(SCPI_OperationPending(&scpi_context));
+    TEST_IEEE4882("*ESR?\r\n", "1\r\n");
+
+    /* *OPC? responds at completion, rest of the message and next messages wait */
+    sweep_count = 0;
+    TEST_IEEE4882("TEST:SWEep;:TEST:TREEA?;*OPC?;:TEST:TREEB?\r\n", "10;");
+    TEST_IEEE4882("TEST:TREEA?\r\n", "");
+    SCPI_OperationComplete(&scpi_context, sweep_handles[0]);
+    CU_ASSERT_STRING_EQUAL(output_buffer, "1;20\r\n10\r\n");
+    output_buffer_clear();
+
+    /* *WAI waits for all pending operations */
+    sweep_count = 0;
+    TEST_IEEE4882("TEST:SWEep;:TEST:SWEep;*WAI;:TEST:TREEA?\r\n", "");
+    CU_ASSERT_NOT_EQUAL(sweep_handles[0], sweep_handles[1]);
+    SCPI_OperationComplete(&scpi_context, sweep_handles[1]);
+    CU_ASSERT_STRING_EQUAL(output_buffer, "");
+    SCPI_OperationComplete(&scpi_context, sweep_handles[0]);
+    CU_ASSERT_STRING_EQUAL(output_buffer, "10\r\n");
+    output_buffer_clear();
+
+    /* input overrun while paused keeps the paused message */
+    {
+        char overrun[SCPI_INPUT_BUFFER_LENGTH];
+        memset(overrun, 'A', sizeof (overrun));
+        sweep_count = 0;
+        TEST_IEEE4882("TEST:SWEep;*WAI;*IDN?\r\n", "");
+        CU_ASSERT_FALSE(SCPI_Input(&scpi_context, overrun, sizeof (overrun)));
+        SCPI_OperationComplete(&scpi_context, sweep_handles[0]);
+        CU_ASSERT_STRING_EQUAL(output_buffer, "MA,IN,0,VER\r\n");
+        output_buffer_clear();
+        CU_ASSERT_EQUAL(scpi_context.buffer.position, 0);
+        TEST_IEEE4882("SYST:ERR:NEXT?\r\n", "-363,\"Input buffer overrun\"\r\n");
+    }
+
+    /* end of input without terminator while paused is parsed later */
+    sweep_count = 0;
+    TEST_IEEE4882("TEST:SWEep;*WAI;*IDN?\r\n*IDN?", "");
+    CU_ASSERT_TRUE(SCPI_Input(&scpi_context, "", 0));
+    CU_ASSERT_STRING_EQUAL(output_buffer, "");
+    SCPI_OperationComplete(&scpi_context, sweep_handles[0]);
+    CU_ASSERT_STRING_EQUAL(output_buffer, "MA,IN,0,VER\r\nMA,IN,0,VER\r\n");
+    CU_ASSERT_EQUAL(scpi_context.buffer.position, 0);
+    output_buffer_clear();
+
+    /* *WAI without pending operation */
+    TEST_IEEE4882("*WAI;*OPC?\r\n", "1\r\n");
+
+    /* *CLS cancels waiting *OPC */
+    sweep_count = 0;
+    TEST_IEEE4882("TEST:SWEep;*OPC\r\n", "");
+    TEST_IEEE4882("*CLS\r\n", "");
+    SCPI_OperationComplete(&scpi_context, sweep_handles[0]);
+    TEST_IEEE4882("*ESR?\r\n", "0\r\n");
+}
+
+#if USE_ERROR_COALESCING
+static scpi_error_count_t batch_errors[SCPI_ERROR_COALESCE_SIZE];
+static size_t batch_count;
+static size_t batch_suppressed;
+static int batch_calls;
+
+static void SCPI_ErrorBatch(scpi_t * context, const scpi_error_count_t * errors, size_t count, size_t suppressed) {
+    (void) context;
+
+    memcpy(batch_errors, errors, count * sizeof (*errors));
+    batch_count = count;
+    batch_suppressed = suppressed;
+    batch_calls++;
+}
+
+static void testErrorCoalescing(void) {
+    int i;
+
+    output_buffer_clear();
+    error_buffer_clear();
+
+    /* without batch callback, error callback is called for every error */
+    TEST_IEEE4882("AB1;AB2;AB3\r\n", "");
+    CU_ASSERT_EQUAL(err_buffer_pos, 3);
+    CU_ASSERT_EQUAL(err_buffer[0], SCPI_ERROR_UNDEFINED_HEADER);
+    CU_ASSERT_EQUAL(err_buffer[2], SCPI_ERROR_UNDEFINED_HEADER);
+    TEST_IEEE4882("SYST:ERR:COUN?\r\n", "3\r\n");
+    TEST_IEEE4882("*ESR?\r\n", "32\r\n");
+    err_buffer_pos = 0;
+    TEST_IEEE4882("AB1;*CLS;AB2\r\n", "");
+    CU_ASSERT_EQUAL(err_buffer_pos, 3);
+    CU_ASSERT_EQUAL(err_buffer[1], 0);
+    TEST_IEEE4882("*CLS\r\n", "");
+    error_buffer_clear();
+
+    scpi_context.interface->error_batch = SCPI_ErrorBatch;
+
+    /* queue emptied inside of message is reported at the end */
+    TEST_IEEE4882("AB1\r\n", "");
+    err_buffer_pos = 0;
+    TEST_IEEE4882("*CLS\r\n", "");
+    CU_ASSERT_EQUAL(err_buffer_pos, 1);
+    CU_ASSERT_EQUAL(err_buffer[0], 0);
+
+    /* queue is not empty at the end of message, no empty report */
+    err_buffer_pos = 0;
+    TEST_IEEE4882("AB1;*CLS;AB2\r\n", "");
+    CU_ASSERT_EQUAL(err_buffer_pos, 0);
+    TEST_IEEE4882("*CLS\r\n", "");
+    error_buffer_clear();
+
+    batch_calls = 0;
+    TEST_IEEE4882("*ESE?\r\n", "32\r\n");
+    CU_ASSERT_EQUAL(batch_calls, 0);
+
+    TEST_IEEE4882("AB1;AB2;AB3;AB4;AB5;AB6;*ESE 1,2\r\n", "");
+    CU_ASSERT_EQUAL(batch_calls, 1);
+    CU_ASSERT_EQUAL(batch_count, 3);
+    CU_ASSERT_EQUAL(batch_suppressed, 0);
+    CU_ASSERT_EQUAL(batch_errors[0].error_code, SCPI_ERROR_UNDEFINED_HEADER);
+    CU_ASSERT_EQUAL(batch_errors[0].count, 6);
+    CU_ASSERT_EQUAL(batch_errors[1].error_code, SCPI_ERROR_QUEUE_OVERFLOW);
+    CU_ASSERT_EQUAL(batch_errors[1].count, 3);
+    CU_ASSERT_EQUAL(batch_errors[2].error_code, SCPI_ERROR_PARAMETER_NOT_ALLOWED);
+    CU_ASSERT_EQUAL(batch_errors[2].count, 1);
+    CU_ASSERT_EQUAL(err_buffer_pos, 0);
+
+    /* queue semantics are not affected */
+    TEST_IEEE4882("SYST:ERR:COUN?\r\n", "4\r\n");
+    TEST_IEEE4882("*ESR?\r\n", "32\r\n");
+    error_buffer_clear();
+
+    /* number of reported codes is limited */
+    SCPI_ErrorBatchBegin(&scpi_context);
+    for (i = 0; i < SCPI_ERROR_COALESCE_SIZE + 2; i++) {
+        SCPI_ErrorPush(&scpi_context, i + 1);
+    }
+    SCPI_ErrorBatchEnd(&scpi_context);
+    CU_ASSERT_EQUAL(batch_calls, 2);
+    CU_ASSERT_EQUAL(batch_count, SCPI_ERROR_COALESCE_SIZE);
+    CU_ASSERT_EQUAL(batch_suppressed, 3);
+    error_buffer_clear();
+
+    /* errors pushed outside of message are reported immediately */
+    SCPI_ErrorPush(&scpi_context, SCPI_ERROR_EXECUTION_ERROR);
+    CU_ASSERT_EQUAL(batch_calls, 2);
+    CU_ASSERT_EQUAL(err_buffer_pos, 1);
+    CU_ASSERT_EQUAL(err_buffer[0], SCPI_ERROR_EXECUTION_ERROR);
+
+    scpi_context.interface->error_batch = NULL;
+    output_buffer_clear();
+    error_buffer_clear();
+}
+#endif /* USE_ERROR_COALESCING */
+
 #define TEST_ParamInt32(data, mandatory, expected_value, expected_result, expected_error_code) \
 {                                                                                       \
     int32_t value;                                                                      \
@@ -1394,6 +1851,241 @@ static void testResultArray(void) {
     TEST_Result(ArrayDoubleSWAPPED, double_arr, "#216" "\x40\x8c\x16\xd3\x66\x67\xd1\x42" "\x1c\xbc\x6e\xf2\x54\x8b\x11\x43");
 }
 
+static void testResultArrayStrided(void) {
+
+#define SCPI_ResultArrayStridedUInt8CH1(c, a) SCPI_ResultArrayStridedUInt8((c), (a), 1, 2, sizeof(a)/sizeof(*a)/2, SCPI_FORMAT_NORMAL)
+#define SCPI_ResultArrayStridedInt16CH0ASCII(c, a) SCPI_ResultArrayStridedInt16((c), (a), 0, 2, sizeof(a)/sizeof(*a)/2, SCPI_FORMAT_ASCII)
+#define SCPI_ResultArrayStridedInt16CH1ASCII(c, a) SCPI_ResultArrayStridedInt16((c), (a), 1, 2, sizeof(a)/sizeof(*a)/2, SCPI_FORMAT_ASCII)
+#define SCPI_ResultArrayStridedInt16CH0NORMAL(c, a) SCPI_ResultArrayStridedInt16((c), (a), 0, 2, sizeof(a)/sizeof(*a)/2, SCPI_FORMAT_NORMAL)
+#define SCPI_ResultArrayStridedInt16CH0SWAPPED(c, a) SCPI_ResultArrayStridedInt16((c), (a), 0, 2, sizeof(a)/sizeof(*a)/2, SCPI_FORMAT_SWAPPED)
+#define SCPI_ResultArrayStridedUInt32CH2NORMAL(c, a) SCPI_ResultArrayStridedUInt32((c), (a), 2, 3, sizeof(a)/sizeof(*a)/3, SCPI_FORMAT_NORMAL)
+#define SCPI_ResultArrayStridedUInt32CH2SWAPPED(c, a) SCPI_ResultArrayStridedUInt32((c), (a), 2, 3, sizeof(a)/sizeof(*a)/3, SCPI_FORMAT_SWAPPED)
+#define SCPI_ResultArrayStridedInt64CH1SWAPPED(c, a) SCPI_ResultArrayStridedInt64((c), (a), 1, 2, sizeof(a)/sizeof(*a)/2, SCPI_FORMAT_SWAPPED)
+#define SCPI_ResultArrayStridedFloatCH1ASCII(c, a) SCPI_ResultArrayStridedFloat((c), (a), 1, 2, sizeof(a)/sizeof(*a)/2, SCPI_FORMAT_ASCII)
+#define SCPI_ResultArrayStridedDoubleCH0NORMAL(c, a) SCPI_ResultArrayStridedDouble((c), (a), 0, 2, sizeof(a)/sizeof(*a)/2, SCPI_FORMAT_NORMAL)
+
+    uint8_t uint8_arr[] = {1, 250, 2, 48, 3, 49};
+    TEST_Result(ArrayStridedUInt8CH1, uint8_arr, "#13" "\xFA" "01");
+
+    int16_t int16_arr[] = {-5, 1, 18505, 2, 12340, 3};
+    TEST_Result(ArrayStridedInt16CH0ASCII, int16_arr, "-5,18505,12340");
+    TEST_Result(ArrayStridedInt16CH1ASCII, int16_arr, "1,2,3");
+    TEST_Result(ArrayStridedInt16CH0NORMAL, int16_arr, "#16" "\xFF\xFB" "HI" "04");
+    TEST_Result(ArrayStridedInt16CH0SWAPPED, int16_arr, "#16" "\xFB\xFF" "IH" "40");
+
+    uint32_t uint32_arr[] = {1, 2, 4294967291UL, 3, 4, 808530483UL, 5, 6, 1094861636UL};
+    TEST_Result(ArrayStridedUInt32CH2NORMAL, uint32_arr, "#212" "\xFF\xFF\xFF\xFB" "0123" "ABCD");
+    TEST_Result(ArrayStridedUInt32CH2SWAPPED, uint32_arr, "#212" "\xFB\xFF\xFF\xFF" "3210" "DCBA");
+
+    int64_t int64_arr[] = {1, -5LL, 2, 3472611983179986487LL};
+    TEST_Result(ArrayStridedInt64CH1SWAPPED, int64_arr, "#216" "\xFB\xFF\xFF\xFF" "\xFF\xFF\xFF\xFF" "76543210");
+
+    float float_arr[] = {1, 0.7549173, 2, 3.0196693};
+    TEST_Result(ArrayStridedFloatCH1ASCII, float_arr, "0.754917,3.01967");
+
+    double double_arr[] = {76543217654321, 1, 1234567891234567, 2};
+    TEST_Result(ArrayStridedDoubleCH0NORMAL, double_arr, "#216" "\x42\xd1\x67\x66\xd3\x16\x8c\x40" "\x43\x11\x8b\x54\xf2\x6e\xbc\x1c");
+}
+
+#define TEST_ResultArrayPacked(call, expected_result) \
+{\
+    output_buffer_clear();\
+    scpi_context.output_count = 0;\
+    CU_ASSERT_EQUAL(call, sizeof(expected_result) - 1);\
+    CU_ASSERT_EQUAL(output_buffer_pos, sizeof(expected_result) - 1);\
+    CU_ASSERT_EQUAL(memcmp(output_buffer, expected_result, sizeof(expected_result) - 1), 0);\
+}
+
+static void testResultArrayPacked(void) {
+    float half_arr[] = {1.0f, -2.0f, 65504.0f};
+    uint32_t uint12_arr[] = {0xABC, 0x123, 0x456};
+    int32_t int24_arr[] = {-1, 2};
+    scpi_error_t val;
+
+    TEST_ResultArrayPacked(SCPI_ResultArrayHalf(&scpi_context, half_arr, 3, SCPI_FORMAT_ASCII), "1,-2,65504");
+    TEST_ResultArrayPacked(SCPI_ResultArrayHalf(&scpi_context, half_arr, 3, SCPI_FORMAT_NORMAL), "#16" "\x3C\x00" "\xC0\x00" "\x7B\xFF");
+    TEST_ResultArrayPacked(SCPI_ResultArrayHalf(&scpi_context, half_arr, 3, SCPI_FORMAT_SWAPPED), "#16" "\x00\x3C" "\x00\xC0" "\xFF\x7B");
+
+    TEST_ResultArrayPacked(SCPI_ResultArrayPackedUInt32(&scpi_context, uint12_arr, 3, 12, SCPI_FORMAT_NORMAL), "#15" "\xAB\xC1\x23" "\x45\x60");
+    TEST_ResultArrayPacked(SCPI_ResultArrayPackedUInt32(&scpi_context, uint12_arr, 3, 12, SCPI_FORMAT_SWAPPED), "#15" "\xBC\x3A\x12" "\x56\x04");
+    TEST_ResultArrayPacked(SCPI_ResultArrayPackedUInt32(&scpi_context, uint12_arr, 0, 12, SCPI_FORMAT_NORMAL), "#10");
+
+    TEST_ResultArrayPacked(SCPI_ResultArrayPackedInt32(&scpi_context, int24_arr, 2, 24, SCPI_FORMAT_ASCII), "-1,2");
+    TEST_ResultArrayPacked(SCPI_ResultArrayPackedInt32(&scpi_context, int24_arr, 2, 24, SCPI_FORMAT_NORMAL), "#16" "\xFF\xFF\xFF" "\x00\x00\x02");
+    TEST_ResultArrayPacked(SCPI_ResultArrayPackedInt32(&scpi_context, int24_arr, 2, 24, SCPI_FORMAT_SWAPPED), "#16" "\xFF\xFF\xFF" "\x02\x00\x00");
+
+    SCPI_CoreCls(&scpi_context);
+    TEST_ResultArrayPacked(SCPI_ResultArrayPackedInt32(&scpi_context, int24_arr, 2, 16, SCPI_FORMAT_NORMAL), "");
+    SCPI_ErrorPop(&scpi_context, &val);
+    CU_ASSERT_EQUAL(val.error_code, SCPI_ERROR_SYSTEM_ERROR);
+}
+
+#define TEST_ParamArrayPacked(data, data_len, call, expected_result, expected_count, expected_error_code) \
+{\
+    size_t o_count;\
+    scpi_error_t errCode;\
+\
+    SCPI_CoreCls(&scpi_context);\
+    scpi_context.input_count = 0;\
+    scpi_context.param_list.lex_state.buffer = data;\
+    scpi_context.param_list.lex_state.len = data_len;\
+    scpi_context.param_list.lex_state.pos = scpi_context.param_list.lex_state.buffer;\
+    CU_ASSERT_EQUAL(call, expected_result);\
+    CU_ASSERT_EQUAL(o_count, expected_count);\
+    SCPI_ErrorPop(&scpi_context, &errCode);\
+    CU_ASSERT_EQUAL(errCode.error_code, expected_error_code);\
+}
+
+static void testParamArrayPacked(void) {
+    int32_t int_arr[600];
+    int32_t int_out[600];
+    uint32_t uint_out[4];
+    float half_out[4];
+    size_t i;
+
+    TEST_ParamArrayPacked("#16" "\x3C\x01" "\xC0\x01" "\x7B\xFF", 9,
+            SCPI_ParamArrayHalf(&scpi_context, half_out, 4, &o_count, SCPI_FORMAT_NORMAL, TRUE), TRUE, 3, SCPI_ERROR_NO_ERROR);
+    CU_ASSERT_EQUAL(half_out[0], 1.0009765625f);
+    CU_ASSERT_EQUAL(half_out[1], -2.001953125f);
+    CU_ASSERT_EQUAL(half_out[2], 65504.0f);
+
+    TEST_ParamArrayPacked("1.5, 2", 6,
+            SCPI_ParamArrayHalf(&scpi_context, half_out, 4, &o_count, SCPI_FORMAT_ASCII, TRUE), TRUE, 2, SCPI_ERROR_NO_ERROR);
+    CU_ASSERT_EQUAL(half_out[0], 1.5f);
+
+    TEST_ParamArrayPacked("#15" "\xBC\x3A\x12" "\x56\x04", 8,
+            SCPI_ParamArrayPackedUInt32(&scpi_context, uint_out, 4, &o_count, 12, SCPI_FORMAT_SWAPPED, TRUE), TRUE, 3, SCPI_ERROR_NO_ERROR);
+    CU_ASSERT_EQUAL(uint_out[0], 0xABC);
+    CU_ASSERT_EQUAL(uint_out[1], 0x123);
+    CU_ASSERT_EQUAL(uint_out[2], 0x456);
+
+    TEST_ParamArrayPacked("#16" "\xFF\xFF\xFE" "\x7F\x11\x22", 9,
+            SCPI_ParamArrayPackedUInt32(&scpi_context, uint_out, 4, &o_count, 24, SCPI_FORMAT_NORMAL, TRUE), TRUE, 2, SCPI_ERROR_NO_ERROR);
+    CU_ASSERT_EQUAL(uint_out[0], 0xFFFFFE);
+    CU_ASSERT_EQUAL(uint_out[1], 0x7F1122);
+
+    TEST_ParamArrayPacked("#16" "\xFF\xFF\xFE" "\x7F\x11\x22", 9,
+            SCPI_ParamArrayPackedInt32(&scpi_context, int_out, 4, &o_count, 24, SCPI_FORMAT_NORMAL, TRUE), TRUE, 2, SCPI_ERROR_NO_ERROR);
+    CU_ASSERT_EQUAL(int_out[0], -2);
+    CU_ASSERT_EQUAL(int_out[1], 0x7F1122);
+
+    TEST_ParamArrayPacked("#14ABCD", 7,
+            SCPI_ParamArrayPackedInt32(&scpi_context, int_out, 4, &o_count, 12, SCPI_FORMAT_NORMAL, TRUE), FALSE, 0, SCPI_ERROR_ILLEGAL_PARAMETER_VALUE);
+
+    TEST_ParamArrayPacked("", 0,
+            SCPI_ParamArrayPackedInt32(&scpi_context, int_out, 4, &o_count, 12, SCPI_FORMAT_NORMAL, FALSE), TRUE, 0, SCPI_ERROR_NO_ERROR);
+
+    /* round trip through several chunks */
+    for (i = 0; i < 599; i++) {
+        int_arr[i] = (int32_t) ((i * 7) % 4096) - 2048;
+    }
+    output_buffer_clear();
+    scpi_context.output_count = 0;
+    SCPI_ResultArrayPackedInt32(&scpi_context, int_arr, 599, 12, SCPI_FORMAT_NORMAL);
+    CU_ASSERT_EQUAL(output_buffer_pos, 5 + 899);
+    TEST_ParamArrayPacked(output_buffer, output_buffer_pos,
+            SCPI_ParamArrayPackedInt32(&scpi_context, int_out, 600, &o_count, 12, SCPI_FORMAT_NORMAL, TRUE), TRUE, 599, SCPI_ERROR_NO_ERROR);
+    CU_ASSERT_EQUAL(memcmp(int_arr, int_out, 599 * sizeof (*int_arr)), 0);
+    output_buffer_clear();
+}
+
+static void testArrayCompressed(void) {
+    int16_t int16_arr[] = {100, 101, 99, -1};
+    uint8_t uint8_arr[] = {255, 0};
+    int32_t wave[300];
+    int32_t wave_out[300];
+    double double_arr[] = {1.5, 1.25, -3e100};
+    double double_out[4];
+    int32_t int_out[4];
+    size_t i;
+
+    TEST_ResultArrayPacked(SCPI_ResultArrayInt16(&scpi_context, int16_arr, 4, SCPI_FORMAT_COMPRESSED), "#18" "\x12\x04" "\xC8\x01" "\x02" "\x03" "\xC7\x01");
+    TEST_ResultArrayPacked(SCPI_ResultArrayUInt8(&scpi_context, uint8_arr, 2, SCPI_FORMAT_COMPRESSED), "#16" "\x01\x02" "\xFE\x03" "\xFD\x03");
+    TEST_ResultArrayPacked(SCPI_ResultArrayStridedInt16(&scpi_context, int16_arr, 1, 2, 2, SCPI_FORMAT_COMPRESSED), "#16" "\x12\x02" "\xCA\x01" "\xCB\x01");
+    TEST_ResultArrayPacked(SCPI_ResultArrayInt32(&scpi_context, wave, 0, SCPI_FORMAT_COMPRESSED), "#12" "\x14\x00");
+
+    /* slowly varying waveform, several chunks */
+    for (i = 0; i < 300; i++) {
+        wave[i] = 50000 - (int32_t) ((i - 150) * (i - 150) / 5);
+    }
+    output_buffer_clear();
+    scpi_context.output_count = 0;
+    SCPI_ResultArrayInt32(&scpi_context, wave, 300, SCPI_FORMAT_COMPRESSED);
+    CU_ASSERT_EQUAL(output_buffer_pos, 5 + 1 + 2 + 3 + 299);
+    TEST_ParamArrayPacked(output_buffer, output_buffer_pos,
+            SCPI_ParamArrayInt32(&scpi_context, wave_out, 300, &o_count, SCPI_FORMAT_COMPRESSED, TRUE), TRUE, 300, SCPI_ERROR_NO_ERROR);
+    CU_ASSERT_EQUAL(memcmp(wave, wave_out, sizeof (wave)), 0);
+
+    output_buffer_clear();
+    scpi_context.output_count = 0;
+    SCPI_ResultArrayDouble(&scpi_context, double_arr, 3, SCPI_FORMAT_COMPRESSED);
+    TEST_ParamArrayPacked(output_buffer, output_buffer_pos,
+            SCPI_ParamArrayDouble(&scpi_context, double_out, 4, &o_count, SCPI_FORMAT_COMPRESSED, TRUE), TRUE, 3, SCPI_ERROR_NO_ERROR);
+    CU_ASSERT_EQUAL(memcmp(double_arr, double_out, sizeof (double_arr)), 0);
+
+    /* type of items must match */
+    output_buffer_clear();
+    scpi_context.output_count = 0;
+    SCPI_ResultArrayInt32(&scpi_context, wave, 2, SCPI_FORMAT_COMPRESSED);
+    TEST_ParamArrayPacked(output_buffer, output_buffer_pos,
+            SCPI_ParamArrayUInt32(&scpi_context, (uint32_t *) int_out, 4, &o_count, SCPI_FORMAT_COMPRESSED, TRUE), FALSE, 0, SCPI_ERROR_ILLEGAL_PARAMETER_VALUE);
+    TEST_ParamArrayPacked(output_buffer, output_buffer_pos,
+            SCPI_ParamArrayFloat(&scpi_context, (float *) int_out, 4, &o_count, SCPI_FORMAT_COMPRESSED, TRUE), FALSE, 0, SCPI_ERROR_ILLEGAL_PARAMETER_VALUE);
+    TEST_ParamArrayPacked("#13" "\x18\x01" "\x02", 6,
+            SCPI_ParamArrayInt32(&scpi_context, int_out, 4, &o_count, SCPI_FORMAT_COMPRESSED, TRUE), FALSE, 0, SCPI_ERROR_ILLEGAL_PARAMETER_VALUE);
+
+    /* more items than fit to the array */
+    TEST_ParamArrayPacked("#16" "\x14\x03" "\x02" "\x02" "\x01", 9,
+            SCPI_ParamArrayInt32(&scpi_context, int_out, 2, &o_count, SCPI_FORMAT_COMPRESSED, TRUE), FALSE, 0, SCPI_ERROR_ILLEGAL_PARAMETER_VALUE);
+
+    /* truncated data and data after the last item */
+    TEST_ParamArrayPacked("#13" "\x14\x02" "\x02", 6,
+            SCPI_ParamArrayInt32(&scpi_context, int_out, 4, &o_count, SCPI_FORMAT_COMPRESSED, TRUE), FALSE, 0, SCPI_ERROR_INVALID_BLOCK_DATA);
+    TEST_ParamArrayPacked("#13" "\x14\x01" "\x80", 6,
+            SCPI_ParamArrayInt32(&scpi_context, int_out, 4, &o_count, SCPI_FORMAT_COMPRESSED, TRUE), FALSE, 0, SCPI_ERROR_INVALID_BLOCK_DATA);
+    TEST_ParamArrayPacked("#11" "\x14", 4,
+            SCPI_ParamArrayInt32(&scpi_context, int_out, 4, &o_count, SCPI_FORMAT_COMPRESSED, TRUE), FALSE, 0, SCPI_ERROR_INVALID_BLOCK_DATA);
+    TEST_ParamArrayPacked("#14" "\x14\x01" "\x02" "\x7F", 7,
+            SCPI_ParamArrayInt32(&scpi_context, int_out, 4, &o_count, SCPI_FORMAT_COMPRESSED, TRUE), FALSE, 0, SCPI_ERROR_INVALID_BLOCK_DATA);
+    output_buffer_clear();
+}
+
+static void testResultArrayStridedLong(void) {
+    char buffer[512];
+    uint16_t samples[2 * 300];
+    size_t i;
+
+    for (i = 0; i < 300; i++) {
+        samples[2 * i] = (uint16_t) i;
+        samples[2 * i + 1] = 0xFFFF;
+    }
+
+    /* gathered in chunks on stack */
+    output_buffer_clear();
+    scpi_context.output_count = 0;
+    CU_ASSERT_EQUAL(SCPI_ResultArrayStridedUInt16(&scpi_context, samples, 0, 2, 300, SCPI_FORMAT_NORMAL), 5 + 600);
+    CU_ASSERT_EQUAL(output_buffer_pos, 5 + 600);
+    CU_ASSERT_EQUAL(memcmp(output_buffer, "#3600", 5), 0);
+    CU_ASSERT_EQUAL((uint8_t) output_buffer[5 + 2 * 299], 299 >> 8);
+    CU_ASSERT_EQUAL((uint8_t) output_buffer[5 + 2 * 299 + 1], 299 & 0xFF);
+
+    /* gathered directly to output buffer */
+    output_buffer_clear();
+    SCPI_InitOutputBuffer(&scpi_context, buffer, sizeof (buffer));
+    scpi_context.output_count = 0;
+    SCPI_ResultArrayStridedUInt16(&scpi_context, samples, 0, 2, 300, SCPI_FORMAT_SWAPPED);
+    SCPI_OutputFlush(&scpi_context);
+    CU_ASSERT_EQUAL(output_buffer_pos, 5 + 600);
+    CU_ASSERT_EQUAL((uint8_t) output_buffer[5 + 2 * 299], 299 & 0xFF);
+    CU_ASSERT_EQUAL((uint8_t) output_buffer[5 + 2 * 299 + 1], 299 >> 8);
+    for (i = 0; i < 300; i++) {
+        if ((uint8_t) output_buffer[5 + 2 * i] != (i & 0xFF)) break;
+    }
+    CU_ASSERT_EQUAL(i, 300);
+    SCPI_InitOutputBuffer(&scpi_context, NULL, 0);
+    output_buffer_clear();
+}
+
 #define _countof(a) (sizeof(a)/sizeof(*(a)))
 
 #define TEST_ParamArrayDouble(T, func, data, mandatory, _expected_value, expected_result, expected_error_code) \
@@ -1456,6 +2148,10 @@ static void testParamArray(void) {
     TEST_ParamArrayDouble(double, SCPI_ParamArrayDouble, "1, 2, 3", TRUE, (1, 2, 3), TRUE, SCPI_ERROR_NO_ERROR);
     TEST_ParamArrayDouble(double, SCPI_ParamArrayDouble, "", TRUE, (0), FALSE, SCPI_ERROR_MISSING_PARAMETER);
     TEST_ParamArrayDouble(double, SCPI_ParamArrayDouble, "1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11", TRUE, (1, 2, 3, 4, 5, 6, 7, 8, 9, 10), TRUE, SCPI_ERROR_NO_ERROR);
+    TEST_ParamArrayDouble(double, SCPI_ParamArrayDouble, "1e3,-2.5E-1 , +.5,12345678901234", TRUE, (1000, -0.25, 0.5, 12345678901234.0), TRUE, SCPI_ERROR_NO_ERROR);
+    TEST_ParamArrayDouble(double, SCPI_ParamArrayDouble, "1, #H10, 3", TRUE, (1, 16, 3), TRUE, SCPI_ERROR_NO_ERROR);
+    TEST_ParamArrayDouble(double, SCPI_ParamArrayDouble, "1, 2 V, 3", TRUE, (1), TRUE, SCPI_ERROR_SUFFIX_NOT_ALLOWED);
+    TEST_ParamArrayDouble(double, SCPI_ParamArrayDouble, "1, MAX, 3", TRUE, (1), TRUE, SCPI_ERROR_DATA_TYPE_ERROR);
 
     TEST_ParamArrayDouble(float, SCPI_ParamArrayFloat, "1, 2, 3", TRUE, (1, 2, 3), TRUE, SCPI_ERROR_NO_ERROR);
     TEST_ParamArrayDouble(float, SCPI_ParamArrayFloat, "", TRUE, (0), FALSE, SCPI_ERROR_MISSING_PARAMETER);
@@ -1464,6 +2160,8 @@ static void testParamArray(void) {
     TEST_ParamArrayInt(int32_t, SCPI_ParamArrayInt32, "1, 2, 3", TRUE, (1, 2, 3), TRUE, SCPI_ERROR_NO_ERROR);
     TEST_ParamArrayInt(int32_t, SCPI_ParamArrayInt32, "", TRUE, (0), FALSE, SCPI_ERROR_MISSING_PARAMETER);
     TEST_ParamArrayInt(int32_t, SCPI_ParamArrayInt32, "1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11", TRUE, (1, 2, 3, 4, 5, 6, 7, 8, 9, 10), TRUE, SCPI_ERROR_NO_ERROR);
+    TEST_ParamArrayInt(int32_t, SCPI_ParamArrayInt32, "-1234567890,#B11, 12345678 ,-7", TRUE, (-1234567890, 3, 12345678, -7), TRUE, SCPI_ERROR_NO_ERROR);
+    TEST_ParamArrayInt(int32_t, SCPI_ParamArrayInt32, "1, 2/s", TRUE, (1), TRUE, SCPI_ERROR_SUFFIX_NOT_ALLOWED);
 
     TEST_ParamArrayInt(uint32_t, SCPI_ParamArrayUInt32, "1, 2, 3", TRUE, (1, 2, 3), TRUE, SCPI_ERROR_NO_ERROR);
     TEST_ParamArrayInt(uint32_t, SCPI_ParamArrayUInt32, "", TRUE, (0), FALSE, SCPI_ERROR_MISSING_PARAMETER);
@@ -1685,6 +2383,639 @@ static void testIncompleteArbitraryParameter(void) {
     CU_ASSERT_STRING_EQUAL("\"" _text "\"\r\n", output_buffer);\
 } while(0)
 
+static void testOutputBuffer(void) {
+    char buffer[16];
+    scpi_error_t val;
+
+    output_buffer_clear();
+    error_buffer_clear();
+    SCPI_InitOutputBuffer(&scpi_context, buffer, sizeof (buffer));
+
+    /* whole response in one write */
+    write_count = 0;
+    TEST_INPUT("*IDN?\r\n", "MA,IN,0,VER\r\n");
+    CU_ASSERT_EQUAL(write_count, 1);
+    output_buffer_clear();
+
+    /* response longer than the buffer */
+    TEST_INPUT("*IDN?;*IDN?\r\n", "MA,IN,0,VER;MA,IN,0,VER\r\n");
+    output_buffer_clear();
+
+    /* short write pauses parsing of next message */
+    write_limit = 4;
+    TEST_INPUT("*IDN?\r\n*IDN?\r\n", "MA,I");
+    CU_ASSERT_EQUAL(SCPI_OutputPending(&scpi_context), 9);
+    write_limit = (size_t) -1;
+    CU_ASSERT_EQUAL(SCPI_OutputFlush(&scpi_context), 0);
+    CU_ASSERT_STRING_EQUAL(output_buffer, "MA,IN,0,VER\r\nMA,IN,0,VER\r\n");
+    output_buffer_clear();
+
+    /* interface temporarily doesn't accept anything (EAGAIN) */
+    write_limit = 0;
+    flush_count = 0;
+    flush_release = 3;
+    flush_write_limit = 4;
+    TEST_INPUT("*IDN?;*IDN?\r\n*IDN?\r\n", "MA,IN,0,VER;");
+    CU_ASSERT_EQUAL(flush_count, 9);
+    CU_ASSERT_EQUAL(SCPI_OutputPending(&scpi_context), 13);
+    CU_ASSERT_EQUAL(SCPI_ErrorCount(&scpi_context), 0);
+    flush_release = 0;
+    write_limit = (size_t) -1;
+    CU_ASSERT_EQUAL(SCPI_OutputFlush(&scpi_context), 0);
+    CU_ASSERT_STRING_EQUAL(output_buffer, "MA,IN,0,VER;MA,IN,0,VER\r\nMA,IN,0,VER\r\n");
+    CU_ASSERT_EQUAL(SCPI_ErrorCount(&scpi_context), 0);
+    output_buffer_clear();
+
+    /* transport can't wait, queued part is terminated, rest is discarded */
+    write_limit = 0;
+    flush_result = SCPI_RES_ERR;
+    TEST_INPUT("*IDN?;*IDN?;*IDN?\r\n*IDN?\r\n", "");
+    CU_ASSERT_EQUAL(SCPI_OutputPending(&scpi_context), 16);
+    flush_result = SCPI_RES_OK;
+    write_limit = (size_t) -1;
+    CU_ASSERT_EQUAL(SCPI_OutputFlush(&scpi_context), 0);
+    CU_ASSERT_STRING_EQUAL(output_buffer, "MA,IN,0,VER;MA\r\nMA,IN,0,VER\r\n");
+    SCPI_ErrorPop(&scpi_context, &val);
+    CU_ASSERT_EQUAL(val.error_code, SCPI_ERROR_QUERY_INTERRUPTED);
+    CU_ASSERT_EQUAL(SCPI_ErrorCount(&scpi_context), 0);
+    output_buffer_clear();
+
+    /* interface doesn't accept anything and input buffer is full */
+    {
+        char input[SCPI_INPUT_BUFFER_LENGTH - 1];
+
+        memset(input, ' ', sizeof (input));
+        memcpy(input, "*IDN?;*IDN?\r\n", 13);
+        write_limit = 0;
+        SCPI_Input(&scpi_context, input, sizeof (input));
+        CU_ASSERT_STRING_EQUAL(output_buffer, "");
+        CU_ASSERT_EQUAL(SCPI_OutputPending(&scpi_context), 0);
+        SCPI_ErrorPop(&scpi_context, &val);
+        CU_ASSERT_EQUAL(val.error_code, SCPI_ERROR_QUERY_DEADLOCKED);
+        CU_ASSERT_EQUAL(SCPI_ErrorCount(&scpi_context), 0);
+        write_limit = (size_t) -1;
+        TEST_INPUT("\r\n*IDN?\r\n", "MA,IN,0,VER\r\n");
+        output_buffer_clear();
+    }
+
+    SCPI_InitOutputBuffer(&scpi_context, NULL, 0);
+    error_buffer_clear();
+}
+
+static void testErrorCounters(void) {
+    uint32_t counters[SCPI_ERROR_COUNTERS_SIZE];
+
+    output_buffer_clear();
+    error_buffer_clear();
+
+    /* not counted without storage */
+    SCPI_ErrorPush(&scpi_context, SCPI_ERROR_INVALID_CHARACTER);
+    CU_ASSERT_EQUAL(SCPI_ErrorCounterGet(&scpi_context, SCPI_ERROR_INVALID_CHARACTER), 0);
+    error_buffer_clear();
+
+    SCPI_ErrorCountersInit(&scpi_context, counters, SCPI_ERROR_COUNTERS_SIZE);
+    TEST_INPUT("SYST:ERR:STAT?\r\n", "0,0\r\n");
+    output_buffer_clear();
+
+    TEST_INPUT("AB1;AB2;*ESE 1,2;*ESR?\r\n", "32\r\n");
+    output_buffer_clear();
+    SCPI_ErrorPush(&scpi_context, 1234);
+    SCPI_ErrorPush(&scpi_context, SCPI_ERROR_INVALID_CHARACTER);
+    CU_ASSERT_EQUAL(SCPI_RegGet(&scpi_context, SCPI_REG_ESR), ESR_DER | ESR_CER);
+
+    CU_ASSERT_EQUAL(SCPI_ErrorCounterGet(&scpi_context, SCPI_ERROR_UNDEFINED_HEADER), 2);
+    CU_ASSERT_EQUAL(SCPI_ErrorCounterGet(&scpi_context, SCPI_ERROR_PARAMETER_NOT_ALLOWED), 1);
+    CU_ASSERT_EQUAL(SCPI_ErrorCounterGet(&scpi_context, SCPI_ERROR_QUEUE_OVERFLOW), 1);
+    /* errors not in the lists are counted together */
+    CU_ASSERT_EQUAL(SCPI_ErrorCounterGet(&scpi_context, 1234), 0);
+    CU_ASSERT_EQUAL(SCPI_ErrorCounterGet(&scpi_context, 4321), 0);
+    CU_ASSERT_EQUAL(SCPI_ErrorCounterOtherGet(&scpi_context), 1);
+
+    TEST_INPUT("SYST:ERR:STAT? -113\r\n", "2\r\n");
+    output_buffer_clear();
+    TEST_INPUT("SYST:ERR:STAT? -999\r\n", "0\r\n");
+    output_buffer_clear();
+    TEST_INPUT("SYST:ERR:STAT?\r\n", "-101,1,-108,1,-113,2,-350,1\r\n");
+    output_buffer_clear();
+
+    /* counters survive clearing of the queue */
+    error_buffer_clear();
+    CU_ASSERT_EQUAL(SCPI_ErrorCounterGet(&scpi_context, SCPI_ERROR_UNDEFINED_HEADER), 2);
+
+    SCPI_ErrorCountersClear(&scpi_context);
+    CU_ASSERT_EQUAL(SCPI_ErrorCounterGet(&scpi_context, SCPI_ERROR_UNDEFINED_HEADER), 0);
+
+    SCPI_ErrorCountersInit(&scpi_context, NULL, 0);
+    output_buffer_clear();
+    error_buffer_clear();
+}
+
+static void testSystemErrorAll(void) {
+    char buffer[128];
+
+    output_buffer_clear();
+    error_buffer_clear();
+
+    TEST_INPUT("SYST:ERR:ALL?\r\n", "0,\"No error\"\r\n");
+    output_buffer_clear();
+
+    SCPI_ErrorPush(&scpi_context, SCPI_ERROR_INVALID_CHARACTER);
+    SCPI_ErrorPush(&scpi_context, SCPI_ERROR_PARAMETER_NOT_ALLOWED);
+    TEST_INPUT("SYST:ERR:ALL?;COUN?\r\n", "-101,\"Invalid character\",-108,\"Parameter not allowed\";0\r\n");
+    output_buffer_clear();
+
+    /* whole queue including overflow in one write */
+    SCPI_InitOutputBuffer(&scpi_context, buffer, sizeof (buffer));
+    SCPI_ErrorPush(&scpi_context, SCPI_ERROR_INVALID_CHARACTER);
+    SCPI_ErrorPush(&scpi_context, SCPI_ERROR_INVALID_CHARACTER);
+    SCPI_ErrorPush(&scpi_context, SCPI_ERROR_INVALID_CHARACTER);
+    SCPI_ErrorPush(&scpi_context, SCPI_ERROR_INVALID_CHARACTER);
+    SCPI_ErrorPush(&scpi_context, SCPI_ERROR_INVALID_CHARACTER);
+    write_count = 0;
+    TEST_INPUT("SYST:ERR:ALL?\r\n", "-101,\"Invalid character\",-101,\"Invalid character\",-101,\"Invalid character\",-350,\"Queue overflow\"\r\n");
+    CU_ASSERT_EQUAL(write_count, 1);
+    CU_ASSERT_EQUAL(SCPI_ErrorCount(&scpi_context), 0);
+    output_buffer_clear();
+
+    /* error pushed by the output is not part of the response */
+    SCPI_InitOutputBuffer(&scpi_context, buffer, 16);
+    SCPI_ErrorPush(&scpi_context, SCPI_ERROR_INVALID_CHARACTER);
+    SCPI_ErrorPush(&scpi_context, SCPI_ERROR_PARAMETER_NOT_ALLOWED);
+    write_limit = 0;
+    flush_result = SCPI_RES_ERR;
+    TEST_INPUT("SYST:ERR:ALL?\r\n", "");
+    flush_result = SCPI_RES_OK;
+    write_limit = (size_t) -1;
+    CU_ASSERT_EQUAL(SCPI_OutputFlush(&scpi_context), 0);
+    CU_ASSERT_STRING_EQUAL(output_buffer, "-101,\"Invalid \r\n");
+    output_buffer_clear();
+    TEST_INPUT("SYST:ERR:ALL?\r\n", "-410,\"Query INTERRUPTED\"\r\n");
+    output_buffer_clear();
+
+    SCPI_InitOutputBuffer(&scpi_context, NULL, 0);
+    error_buffer_clear();
+}
+
+static char reserve_buffer[16];
+
+static char * SCPI_Reserve(scpi_t * context, size_t len) {
+    (void) context;
+
+    return len <= sizeof (reserve_buffer) ? reserve_buffer : NULL;
+}
+
+static size_t SCPI_Commit(scpi_t * context, char * data, size_t len) {
+    (void) context;
+
+    return output_buffer_write(data, len);
+}
+
+static void testArbitraryBlockReserve(void) {
+    char buffer[16];
+    char * data;
+    scpi_error_t val;
+
+    output_buffer_clear();
+    error_buffer_clear();
+    scpi_context.output_count = 0;
+
+    /* no memory available */
+    CU_ASSERT_PTR_NULL(SCPI_ResultArbitraryBlockReserve(&scpi_context, 4));
+    CU_ASSERT_STRING_EQUAL(output_buffer, "");
+
+    /* memory from output buffer */
+    SCPI_InitOutputBuffer(&scpi_context, buffer, sizeof (buffer));
+    data = SCPI_ResultArbitraryBlockReserve(&scpi_context, 4);
+    CU_ASSERT_PTR_NOT_NULL_FATAL(data);
+    memcpy(data, "abcd", 4);
+    CU_ASSERT_EQUAL(SCPI_ResultArbitraryBlockCommit(&scpi_context, 4), 4);
+    CU_ASSERT_EQUAL(scpi_context.output_count, 1);
+    CU_ASSERT_EQUAL(SCPI_OutputFlush(&scpi_context), 0);
+    CU_ASSERT_STRING_EQUAL(output_buffer, "#14abcd");
+    output_buffer_clear();
+
+    /* block split to several reservations */
+    SCPI_ResultArbitraryBlockHeader(&scpi_context, 6);
+    data = SCPI_ResultArbitraryBlockReserve(&scpi_context, 3);
+    memcpy(data, "abc", 3);
+    SCPI_ResultArbitraryBlockCommit(&scpi_context, 3);
+    CU_ASSERT_EQUAL(scpi_context.output_count, 1);
+    data = SCPI_ResultArbitraryBlockReserve(&scpi_context, 3);
+    memcpy(data, "def", 3);
+    SCPI_ResultArbitraryBlockCommit(&scpi_context, 3);
+    CU_ASSERT_EQUAL(scpi_context.output_count, 2);
+    SCPI_OutputFlush(&scpi_context);
+    CU_ASSERT_STRING_EQUAL(output_buffer, ",#16abcdef");
+    output_buffer_clear();
+    SCPI_InitOutputBuffer(&scpi_context, NULL, 0);
+
+    /* memory supplied by the interface */
+    scpi_interface.reserve = SCPI_Reserve;
+    scpi_interface.commit = SCPI_Commit;
+    scpi_context.output_count = 0;
+    data = SCPI_ResultArbitraryBlockReserve(&scpi_context, 5);
+    CU_ASSERT_PTR_EQUAL(data, reserve_buffer);
+    memcpy(data, "abcde", 5);
+    SCPI_ResultArbitraryBlockCommit(&scpi_context, 5);
+    CU_ASSERT_STRING_EQUAL(output_buffer, "#15abcde");
+    CU_ASSERT_EQUAL(scpi_context.arbitrary_remaining, 0);
+    scpi_interface.reserve = NULL;
+    scpi_interface.commit = NULL;
+    output_buffer_clear();
+
+    CU_ASSERT_EQUAL(SCPI_ErrorCount(&scpi_context), 0);
+
+    /* nothing can follow indefinite length block */
+    SCPI_InitOutputBuffer(&scpi_context, buffer, sizeof (buffer));
+    scpi_context.output_count = 0;
+    SCPI_ResultArbitraryBlockIndefiniteHeader(&scpi_context);
+    CU_ASSERT_PTR_NULL(SCPI_ResultArbitraryBlockReserve(&scpi_context, 4));
+    CU_ASSERT_EQUAL(SCPI_ErrorCount(&scpi_context), 1);
+    CU_ASSERT_PTR_NULL(SCPI_ResultArbitraryBlockReserve(&scpi_context, 4));
+    CU_ASSERT_EQUAL(SCPI_ErrorCount(&scpi_context), 1);
+    SCPI_ErrorPop(&scpi_context, &val);
+    CU_ASSERT_EQUAL(val.error_code, SCPI_ERROR_QUERY_UNTERM_INDEF_RESP);
+    SCPI_InitOutputBuffer(&scpi_context, NULL, 0);
+    output_buffer_clear();
+    error_buffer_clear();
+}
+
+static size_t writev_count = 0;
+static size_t writev_empty = 0;
+/* bytes accepted by one writev call */
+static size_t writev_limit = (size_t) -1;
+
+static size_t SCPI_Writev(scpi_t * context, const scpi_iovec_t * iov, size_t iovcnt) {
+    size_t result = 0;
+    size_t len;
+    size_t i;
+
+    writev_count++;
+    for (i = 0; i < iovcnt; i++) {
+        if (iov[i].len == 0) {
+            writev_empty++;
+        }
+        len = iov[i].len < (writev_limit - result) ? iov[i].len : (writev_limit - result);
+        result += SCPI_Write(context, iov[i].data, len);
+    }
+    return result;
+}
+
+static void testArbitraryBlockWritev(void) {
+    char buffer[16];
+
+    output_buffer_clear();
+    error_buffer_clear();
+    scpi_interface.writev = SCPI_Writev;
+
+    /* header and data in one call */
+    writev_count = 0;
+    write_count = 0;
+    scpi_context.output_count = 0;
+    SCPI_ResultArbitraryBlock(&scpi_context, "abc", 3);
+    SCPI_ResultArbitraryBlock(&scpi_context, "de", 2);
+    CU_ASSERT_EQUAL(writev_count, 2);
+    CU_ASSERT_EQUAL(writev_empty, 0);
+    CU_ASSERT_STRING_EQUAL(output_buffer, "#13abc,#12de");
+    output_buffer_clear();
+
+    /* short writev is repeated with the rest */
+    writev_count = 0;
+    writev_limit = 4;
+    scpi_context.output_count = 0;
+    CU_ASSERT_EQUAL(SCPI_ResultArbitraryBlock(&scpi_context, "0123456789", 10), 14);
+    CU_ASSERT_EQUAL(writev_count, 4);
+    CU_ASSERT_STRING_EQUAL(output_buffer, "#2100123456789");
+    output_buffer_clear();
+
+    /* interface doesn't accept anything */
+    writev_count = 0;
+    writev_limit = 0;
+    CU_ASSERT_EQUAL(SCPI_ResultArbitraryBlock(&scpi_context, "0123456789", 10), 0);
+    CU_ASSERT_EQUAL(writev_count, 1);
+    writev_limit = (size_t) -1;
+    output_buffer_clear();
+
+    /* small block is coalesced in output buffer */
+    SCPI_InitOutputBuffer(&scpi_context, buffer, sizeof (buffer));
+    writev_count = 0;
+    scpi_context.output_count = 0;
+    SCPI_ResultArbitraryBlock(&scpi_context, "abc", 3);
+    CU_ASSERT_EQUAL(writev_count, 0);
+    CU_ASSERT_EQUAL(SCPI_OutputPending(&scpi_context), 6);
+
+    /* buffered data, header and data in one call */
+    SCPI_ResultArbitraryBlock(&scpi_context, "0123456789ABCDEFGHIJ", 20);
+    CU_ASSERT_EQUAL(writev_count, 1);
+    CU_ASSERT_EQUAL(SCPI_OutputPending(&scpi_context), 0);
+    CU_ASSERT_STRING_EQUAL(output_buffer, "#13abc,#2200123456789ABCDEFGHIJ");
+    output_buffer_clear();
+
+    /* empty output buffer is not passed */
+    writev_empty = 0;
+    scpi_context.output_count = 0;
+    SCPI_ResultArbitraryBlock(&scpi_context, "0123456789ABCDEFGHIJ", 20);
+    CU_ASSERT_EQUAL(writev_empty, 0);
+    output_buffer_clear();
+
+    /* rest of short write is queued */
+    write_limit = 15;
+    scpi_context.output_count = 0;
+    SCPI_ResultArbitraryBlock(&scpi_context, "0123456789ABCDEFGHIJ", 20);
+    CU_ASSERT_STRING_EQUAL(output_buffer, "#2200123456789A");
+    CU_ASSERT_EQUAL(SCPI_OutputPending(&scpi_context), 9);
+    write_limit = (size_t) -1;
+    CU_ASSERT_EQUAL(SCPI_OutputFlush(&scpi_context), 0);
+    CU_ASSERT_STRING_EQUAL(output_buffer, "#2200123456789ABCDEFGHIJ");
+    output_buffer_clear();
+
+    SCPI_InitOutputBuffer(&scpi_context, NULL, 0);
+    scpi_interface.writev = NULL;
+    CU_ASSERT_EQUAL(SCPI_ErrorCount(&scpi_context), 0);
+    error_buffer_clear();
+}
+
+#if HAVE_PREAD
+static size_t sendfile_limit;
+
+static size_t SCPI_Sendfile(scpi_t * context, int fd, int64_t offset, size_t len) {
+    char buffer[64];
+    ssize_t rd;
+
+    (void) context;
+
+    if (len > sendfile_limit) {
+        len = sendfile_limit;
+    }
+    rd = pread(fd, buffer, len, (off_t) offset);
+    return rd > 0 ? output_buffer_write(buffer, (size_t) rd) : 0;
+}
+
+static void testArbitraryBlockFile(void) {
+    FILE * file;
+    int fd;
+    scpi_error_t val;
+
+    output_buffer_clear();
+    error_buffer_clear();
+
+    file = tmpfile();
+    CU_ASSERT_PTR_NOT_NULL_FATAL(file);
+    fputs("0123456789", file);
+    fflush(file);
+    fd = fileno(file);
+
+    /* read and write */
+    scpi_context.output_count = 0;
+    SCPI_ResultArbitraryBlockFile(&scpi_context, fd, 2, 5);
+    SCPI_ResultArbitraryBlockFile(&scpi_context, fd, 0, 0);
+    CU_ASSERT_STRING_EQUAL(output_buffer, "#1523456,#10");
+    output_buffer_clear();
+
+    /* sendfile, rest by read and write */
+    scpi_interface.sendfile = SCPI_Sendfile;
+    sendfile_limit = 3;
+    scpi_context.output_count = 0;
+    SCPI_ResultArbitraryBlockFile(&scpi_context, fd, 0, 10);
+    CU_ASSERT_EQUAL(scpi_context.arbitrary_remaining, 0);
+    CU_ASSERT_STRING_EQUAL(output_buffer, "#2100123456789");
+    output_buffer_clear();
+    scpi_interface.sendfile = NULL;
+
+    CU_ASSERT_EQUAL(SCPI_ErrorCount(&scpi_context), 0);
+
+    /* file too short */
+    scpi_context.output_count = 0;
+    SCPI_ResultArbitraryBlockFile(&scpi_context, fd, 8, 4);
+    CU_ASSERT_EQUAL(output_buffer_pos, 7);
+    CU_ASSERT_EQUAL(memcmp(output_buffer, "#1489\0\0", 7), 0);
+    output_buffer_clear();
+    SCPI_ErrorPop(&scpi_context, &val);
+    CU_ASSERT_EQUAL(val.error_code, SCPI_ERROR_MASS_STORAGE_ERROR);
+
+    fclose(file);
+    error_buffer_clear();
+}
+#endif
+
+static void testArbitraryBlockIndefinite(void) {
+    scpi_error_t val;
+
+    output_buffer_clear();
+    error_buffer_clear();
+
+    TEST_INPUT("TEST:IND? 3\r\n", "#0abcabcabc\n");
+    output_buffer_clear();
+
+    TEST_INPUT("*IDN?;TEST:IND? 0\r\n", "MA,IN,0,VER;#0\n");
+    output_buffer_clear();
+
+    /* nothing can follow the block in the same response */
+    TEST_INPUT("TEST:IND? 1;*IDN?\r\n*IDN?\r\n", "#0abc\nMA,IN,0,VER\r\n");
+    output_buffer_clear();
+    SCPI_ErrorPop(&scpi_context, &val);
+    CU_ASSERT_EQUAL(val.error_code, SCPI_ERROR_QUERY_UNTERM_INDEF_RESP);
+    CU_ASSERT_EQUAL(SCPI_ErrorCount(&scpi_context), 0);
+
+    /* data without header */
+    SCPI_ResultArbitraryBlockIndefiniteData(&scpi_context, "abc", 3);
+    CU_ASSERT_STRING_EQUAL(output_buffer, "");
+    SCPI_ErrorPop(&scpi_context, &val);
+    CU_ASSERT_EQUAL(val.error_code, SCPI_ERROR_SYSTEM_ERROR);
+
+    error_buffer_clear();
+}
+
+#define TEST_INPUT_BIN(data, expected_result) {\
+    output_buffer_clear();\
+    SCPI_Input(&scpi_context, data, strlen(data));\
+    CU_ASSERT_EQUAL(output_buffer_pos, sizeof(expected_result) - 1);\
+    CU_ASSERT_EQUAL(memcmp(output_buffer, expected_result, sizeof(expected_result) - 1), 0);\
+}
+
+static void testDataFormat(void) {
+    scpi_error_t val;
+
+    output_buffer_clear();
+    error_buffer_clear();
+
+    TEST_INPUT_BIN("FORM?;:FORM:BORD?\r\n", "ASC,0;NORM\r\n");
+    TEST_INPUT_BIN("TEST:DATA?\r\n", "1.5,-2,100000.25\r\n");
+
+    /* doubles narrowed to floats */
+    TEST_INPUT_BIN("FORM REAL;FORM?\r\n", "REAL,32\r\n");
+    TEST_INPUT_BIN("TEST:DATA?\r\n", "#212" "\x3F\xC0\x00\x00" "\xC0\x00\x00\x00" "\x47\xC3\x50\x20" "\r\n");
+    TEST_INPUT_BIN("FORM:BORD SWAP;BORD?\r\n", "SWAP\r\n");
+    TEST_INPUT_BIN("TEST:DATA?\r\n", "#212" "\x00\x00\xC0\x3F" "\x00\x00\x00\xC0" "\x20\x50\xC3\x47" "\r\n");
+
+    /* same type is sent directly */
+    TEST_INPUT_BIN("FORM:DATA REAL,64;:FORM:BORD NORM\r\n", "");
+    TEST_INPUT_BIN("TEST:DATA?\r\n", "#224" "\x3F\xF8\x00\x00\x00\x00\x00\x00" "\xC0\x00\x00\x00\x00\x00\x00\x00" "\x40\xF8\x6A\x04\x00\x00\x00\x00" "\r\n");
+
+    /* rounded and saturated integers */
+    TEST_INPUT_BIN("FORM INT,16;FORM?\r\n", "INT,16\r\n");
+    TEST_INPUT_BIN("TEST:DATA?\r\n", "#16" "\x00\x02" "\xFF\xFE" "\x7F\xFF" "\r\n");
+    TEST_INPUT_BIN("FORM REAL,16\r\n", "");
+    TEST_INPUT_BIN("TEST:DATA?\r\n", "#16" "\x3E\x00" "\xC0\x00" "\x7C\x00" "\r\n");
+
+    TEST_INPUT_BIN("FORM COMP;FORM?\r\n", "COMP,0\r\n");
+
+    /* invalid length keeps previous state */
+    TEST_INPUT_BIN("FORM INT,12;FORM?\r\n", "COMP,0\r\n");
+    SCPI_ErrorPop(&scpi_context, &val);
+    CU_ASSERT_EQUAL(val.error_code, SCPI_ERROR_ILLEGAL_PARAMETER_VALUE);
+    TEST_INPUT_BIN("FORM ASC,5\r\n", "");
+    SCPI_ErrorPop(&scpi_context, &val);
+    CU_ASSERT_EQUAL(val.error_code, SCPI_ERROR_ILLEGAL_PARAMETER_VALUE);
+
+    /* state set out of range by the application */
+    scpi_context.data_format.type = (scpi_data_type_t) 7;
+    TEST_INPUT_BIN("FORM?\r\n", "");
+    SCPI_ErrorPop(&scpi_context, &val);
+    CU_ASSERT_EQUAL(val.error_code, SCPI_ERROR_SYSTEM_ERROR);
+
+    TEST_INPUT_BIN("FORM:BORD SWAP;*RST;FORM?;:FORM:BORD?\r\n", "ASC,0;NORM\r\n");
+    CU_ASSERT_EQUAL(SCPI_ErrorCount(&scpi_context), 0);
+
+    output_buffer_clear();
+    error_buffer_clear();
+}
+
+static size_t count_write_total;
+static char count_write_last;
+
+static size_t SCPI_WriteCount(scpi_t * context, const char * data, size_t len) {
+    (void) context;
+
+    count_write_total += len;
+    count_write_last = data[len - 1];
+    return len;
+}
+
+#define TEST_INPUT_STR(s) SCPI_Input(&scpi_context, (s), strlen(s))
+
+static void testLargeBlocks(void) {
+#if SIZE_MAX > 0xFFFFFFFFUL
+    const size_t total = (size_t) 5 * 1024 * 1024 * 1024;
+    size_t pulled;
+    size_t len;
+
+    error_buffer_clear();
+    output_buffer_clear();
+
+    /* header and data, too long for #N header */
+    scpi_interface.write = SCPI_WriteCount;
+    count_write_total = 0;
+    TEST_INPUT_STR("TEST:LARG? 5368709120\r\n");
+    CU_ASSERT_EQUAL(count_write_total, 2 + total + 1);
+    CU_ASSERT_EQUAL(count_write_last, '\n');
+    CU_ASSERT_EQUAL(scpi_context.arbitrary_remaining, 0);
+    scpi_interface.write = SCPI_Write;
+
+    /* pulled stream of known length */
+    TEST_INPUT_STR("TEST:LARG? 5368709120, ON\r\n");
+    CU_ASSERT_STRING_EQUAL(output_buffer, "#0");
+    output_buffer_clear();
+    pulled = 0;
+    while ((len = SCPI_OutputPull(&scpi_context, test_large_chunk, sizeof (test_large_chunk))) > 0) {
+        pulled += len;
+    }
+    CU_ASSERT_EQUAL(pulled, total + 1);
+    CU_ASSERT_EQUAL(test_large_remaining, 0);
+
+    /* pulled stream of unknown length */
+    test_large_remaining = total;
+    scpi_context.output_count = 0;
+    SCPI_ResultArbitraryBlockStream(&scpi_context, SCPI_BLOCK_LENGTH_UNKNOWN, test_large_producer, &test_large_remaining);
+    CU_ASSERT_STRING_EQUAL(output_buffer, "#0");
+    output_buffer_clear();
+    pulled = 0;
+    while ((len = SCPI_OutputPull(&scpi_context, test_large_chunk, sizeof (test_large_chunk))) > 0) {
+        pulled += len;
+    }
+    CU_ASSERT_EQUAL(pulled, total + 1);
+
+    CU_ASSERT_EQUAL(SCPI_ErrorCount(&scpi_context), 0);
+    error_buffer_clear();
+#endif
+}
+
+static void testArbitraryBlockStream(void) {
+    char buffer[8];
+    size_t len;
+    scpi_error_t val;
+
+    output_buffer_clear();
+    error_buffer_clear();
+
+    /* definite length, next message waits for the stream */
+    TEST_INPUT("TEST:STR? 10\r\n*IDN?\r\n", "#210");
+    len = SCPI_OutputPull(&scpi_context, buffer, 4);
+    CU_ASSERT_EQUAL(len, 4);
+    CU_ASSERT_NSTRING_EQUAL(buffer, "abcd", 4);
+    len = SCPI_OutputPull(&scpi_context, buffer, 7);
+    CU_ASSERT_EQUAL(len, 7);
+    CU_ASSERT_NSTRING_EQUAL(buffer, "efghij\r", 7);
+    CU_ASSERT_STRING_EQUAL(output_buffer, "#210");
+    len = SCPI_OutputPull(&scpi_context, buffer, 8);
+    CU_ASSERT_EQUAL(len, 1);
+    CU_ASSERT_NSTRING_EQUAL(buffer, "\n", 1);
+    CU_ASSERT_STRING_EQUAL(output_buffer, "#210MA,IN,0,VER\r\n");
+    CU_ASSERT_EQUAL(SCPI_OutputPull(&scpi_context, buffer, 8), 0);
+    output_buffer_clear();
+
+    /* indefinite length */
+    TEST_INPUT("TEST:STR? 5, ON\r\n", "#0");
+    len = SCPI_OutputPull(&scpi_context, buffer, 8);
+    CU_ASSERT_EQUAL(len, 5);
+    CU_ASSERT_NSTRING_EQUAL(buffer, "abcde", 5);
+    len = SCPI_OutputPull(&scpi_context, buffer, 8);
+    CU_ASSERT_EQUAL(len, 1);
+    CU_ASSERT_NSTRING_EQUAL(buffer, "\n", 1);
+    output_buffer_clear();
+
+    /* nothing can follow indefinite length stream in the same response */
+    TEST_INPUT("TEST:STR? 2, ON;*IDN?\r\n", "#0");
+    len = SCPI_OutputPull(&scpi_context, buffer, 8);
+    CU_ASSERT_EQUAL(len, 2);
+    CU_ASSERT_NSTRING_EQUAL(buffer, "ab", 2);
+    len = SCPI_OutputPull(&scpi_context, buffer, 8);
+    CU_ASSERT_EQUAL(len, 1);
+    CU_ASSERT_NSTRING_EQUAL(buffer, "\n", 1);
+    SCPI_ErrorPop(&scpi_context, &val);
+    CU_ASSERT_EQUAL(val.error_code, SCPI_ERROR_QUERY_UNTERM_INDEF_RESP);
+    output_buffer_clear();
+
+    /* values after known length stream need output buffer */
+    TEST_INPUT("TEST:STR? 2;*IDN?\r\n", "#12");
+    len = SCPI_OutputPull(&scpi_context, buffer, 8);
+    CU_ASSERT_EQUAL(len, 4);
+    CU_ASSERT_NSTRING_EQUAL(buffer, "ab\r\n", 4);
+    SCPI_ErrorPop(&scpi_context, &val);
+    CU_ASSERT_EQUAL(val.error_code, SCPI_ERROR_QUERY_INTERRUPTED);
+    output_buffer_clear();
+
+    /* values after known length stream are sent after the block */
+    {
+        char out[16];
+        char pulled[64];
+        size_t chunk;
+
+        SCPI_InitOutputBuffer(&scpi_context, out, sizeof (out));
+        TEST_INPUT("TEST:STR? 2;*IDN?\r\n", "");
+        len = 0;
+        while ((len < sizeof (pulled)) && (chunk = SCPI_OutputPull(&scpi_context, pulled + len, 5)) > 0) {
+            len += chunk;
+        }
+        CU_ASSERT_EQUAL(len, 19);
+        CU_ASSERT_NSTRING_EQUAL(pulled, "#12ab;MA,IN,0,VER\r\n", 19);
+        CU_ASSERT_EQUAL(SCPI_OutputPull(&scpi_context, pulled, 8), 0);
+        CU_ASSERT_EQUAL(SCPI_ErrorCount(&scpi_context), 0);
+        SCPI_InitOutputBuffer(&scpi_context, NULL, 0);
+    }
+    error_buffer_clear();
+}
+
 static void testIncompleteTextParameter(void) {
     TEST_INCOMPLETE_TEXT("AbcdEfgh", 20);
     TEST_INCOMPLETE_TEXT("AbcdEfgh", 19);
@@ -1739,6 +3070,13 @@ int main() {
             || (NULL == CU_add_test(pSuite, "Error handling", testErrorHandling))
             || (NULL == CU_add_test(pSuite, "Device dependent error handling", testErrorHandlingDeviceDependent))
             || (NULL == CU_add_test(pSuite, "IEEE 488.2 Mandatory commands", testIEEE4882))
+            || (NULL == CU_add_test(pSuite, "Status transition filters", testStatusTransitionFilters))
+            || (NULL == CU_add_test(pSuite, "Service request coalescing", testServiceRequestCoalescing))
+            || (NULL == CU_add_test(pSuite, "STATus:SNAPshot?", testStatusSnapshot))
+            || (NULL == CU_add_test(pSuite, "Overlapped commands", testOverlappedCommands))
+#if USE_ERROR_COALESCING
+            || (NULL == CU_add_test(pSuite, "Error callback coalescing", testErrorCoalescing))
+#endif
             || (NULL == CU_add_test(pSuite, "Numeric list", testNumericList))
             || (NULL == CU_add_test(pSuite, "Channel list", testChannelList))
             || (NULL == CU_add_test(pSuite, "SCPI_ParamNumber", testParamNumber))
@@ -1757,11 +3095,28 @@ int main() {
             || (NULL == CU_add_test(pSuite, "SCPI_ResultText", testResultText))
             || (NULL == CU_add_test(pSuite, "SCPI_ResultArbitraryBlock", testResultArbitraryBlock))
             || (NULL == CU_add_test(pSuite, "SCPI_ResultArray", testResultArray))
+            || (NULL == CU_add_test(pSuite, "SCPI_ResultArrayStrided", testResultArrayStrided))
+            || (NULL == CU_add_test(pSuite, "SCPI_ResultArrayStrided long", testResultArrayStridedLong))
+            || (NULL == CU_add_test(pSuite, "SCPI_ResultArrayPacked", testResultArrayPacked))
+            || (NULL == CU_add_test(pSuite, "SCPI_ParamArrayPacked", testParamArrayPacked))
+            || (NULL == CU_add_test(pSuite, "SCPI_ArrayCompressed", testArrayCompressed))
             || (NULL == CU_add_test(pSuite, "SCPI_ParamArray", testParamArray))
             || (NULL == CU_add_test(pSuite, "SCPI_NumberToStr", testNumberToStr))
             || (NULL == CU_add_test(pSuite, "SCPI_ErrorQueue", testErrorQueue))
             || (NULL == CU_add_test(pSuite, "Incomplete arbitrary parameter", testIncompleteArbitraryParameter))
             || (NULL == CU_add_test(pSuite, "Incomplete text parameter", testIncompleteTextParameter))
+            || (NULL == CU_add_test(pSuite, "Output buffer", testOutputBuffer))
+            || (NULL == CU_add_test(pSuite, "SYSTem:ERRor:ALL?", testSystemErrorAll))
+            || (NULL == CU_add_test(pSuite, "Error counters", testErrorCounters))
+            || (NULL == CU_add_test(pSuite, "Arbitrary block reserve", testArbitraryBlockReserve))
+            || (NULL == CU_add_test(pSuite, "Arbitrary block stream", testArbitraryBlockStream))
+            || (NULL == CU_add_test(pSuite, "Arbitrary block writev", testArbitraryBlockWritev))
+#if HAVE_PREAD
+            || (NULL == CU_add_test(pSuite, "Arbitrary block from file", testArbitraryBlockFile))
+#endif
+            || (NULL == CU_add_test(pSuite, "Indefinite arbitrary block", testArbitraryBlockIndefinite))
+            || (NULL == CU_add_test(pSuite, "Large arbitrary blocks", testLargeBlocks))
+            || (NULL == CU_add_test(pSuite, "FORMat:DATA and FORMat:BORDer", testDataFormat))
             ) {
         CU_cleanup_registry();
         return CU_get_error();
@@ -0,0 +1,284 @@
+/*-
+ * BSD 2-Clause License
+ *
+ * Copyright (c) 2012-2018, Jan Breuer
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * * Redistributions of source code must retain the above copyright notice, this
+ *   list of conditions and the following disclaimer.
+ *
+ * * Redistributions in binary form must reproduce the above copyright notice,
+ *   this list of conditions and the following disclaimer in the documentation
+ *   and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/*
+ * Lock-free status registers, built here with USE_ATOMIC_REGISTERS
+ * regardless of the library configuration. Run "make test-tsan" to check
+ * the stress tests with ThreadSanitizer.
+ */
+
+#define USE_ATOMIC_REGISTERS 1
+#define USE_SRQ_COALESCING 0
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+#include <sched.h>
+#include "CUnit/Basic.h"
+
+#include "../src/ieee488.c"
+
+/*
+ * CUnit Test Suite
+ */
+
+static int init_suite(void) {
+    return 0;
+}
+
+static int clean_suite(void) {
+    return 0;
+}
+
+static atomic_int srq_count;
+static atomic_uint srq_val;
+
+static scpi_result_t SCPI_Control(scpi_t * context, scpi_ctrl_name_t ctrl, scpi_reg_val_t val) {
+    (void) context;
+
+    if (ctrl == SCPI_CTRL_SRQ) {
+        atomic_fetch_add(&srq_count, 1);
+        atomic_store(&srq_val, val);
+    }
+    return SCPI_RES_OK;
+}
+
+static scpi_interface_t scpi_interface = {
+    .control = SCPI_Control,
+};
+
+static scpi_t scpi_context;
+
+static void registers_clear(void) {
+    int i;
+
+    memset(&scpi_context, 0, sizeof (scpi_context));
+    scpi_context.interface = &scpi_interface;
+    for (i = 0; i < SCPI_REG_COUNT; i++) {
+        atomic_store(&scpi_context.registers[i], 0);
+    }
+    SCPI_RegPresetFilters(&scpi_context);
+    atomic_store(&srq_count, 0);
+    atomic_store(&srq_val, 0);
+}
+
+/* summary bits match the registers they summarize */
+static void registers_check(void) {
+    scpi_reg_val_t stb = SCPI_RegGet(&scpi_context, SCPI_REG_STB);
+    scpi_reg_val_t sre = SCPI_RegGet(&scpi_context, SCPI_REG_SRE);
+    scpi_bool_t ques = SCPI_RegGet(&scpi_context, SCPI_REG_QUES) & SCPI_RegGet(&scpi_context, SCPI_REG_QUESE);
+    scpi_bool_t oper = SCPI_RegGet(&scpi_context, SCPI_REG_OPER) & SCPI_RegGet(&scpi_context, SCPI_REG_OPERE);
+    scpi_bool_t esr = SCPI_RegGet(&scpi_context, SCPI_REG_ESR) & SCPI_RegGet(&scpi_context, SCPI_REG_ESE);
+
+    CU_ASSERT_EQUAL(!!(stb & STB_QES), ques);
+    CU_ASSERT_EQUAL(!!(stb & STB_OPS), oper);
+    CU_ASSERT_EQUAL(!!(stb & STB_ESR), esr);
+    CU_ASSERT_EQUAL(!!(stb & STB_SRQ), !!(stb & sre & ~STB_SRQ));
+}
+
+static void testRegisters(void) {
+    registers_clear();
+
+    SCPI_RegSet(&scpi_context, SCPI_REG_SRE, STB_QES | STB_ESR);
+    SCPI_RegSet(&scpi_context, SCPI_REG_QUESE, 0x0003);
+    CU_ASSERT_EQUAL(atomic_load(&srq_count), 0);
+
+    /* condition sets event, summary and requests service */
+    SCPI_RegSetBits(&scpi_context, SCPI_REG_QUESC, 0x0001);
+    CU_ASSERT_EQUAL(SCPI_RegGet(&scpi_context, SCPI_REG_QUES), 0x0001);
+    CU_ASSERT_EQUAL(SCPI_RegGet(&scpi_context, SCPI_REG_STB), STB_QES | STB_SRQ);
+    CU_ASSERT_EQUAL(atomic_load(&srq_count), 1);
+    CU_ASSERT_EQUAL(atomic_load(&srq_val), STB_QES | STB_SRQ);
+
+    /* no transition, no request */
+    SCPI_RegSetBits(&scpi_context, SCPI_REG_QUESC, 0x0001);
+    SCPI_RegClearBits(&scpi_context, SCPI_REG_QUESC, 0x0001);
+    CU_ASSERT_EQUAL(SCPI_RegGet(&scpi_context, SCPI_REG_QUES), 0x0001);
+    CU_ASSERT_EQUAL(atomic_load(&srq_count), 1);
+
+    /* disabled event doesn't change summary */
+    SCPI_RegSetBits(&scpi_context, SCPI_REG_QUESC, 0x0004);
+    CU_ASSERT_EQUAL(SCPI_RegGet(&scpi_context, SCPI_REG_QUES), 0x0005);
+    CU_ASSERT_EQUAL(atomic_load(&srq_count), 1);
+
+    /* another enabled bit of STB requests service again */
+    SCPI_RegSet(&scpi_context, SCPI_REG_ESE, ESR_CER);
+    SCPI_RegSetBits(&scpi_context, SCPI_REG_ESR, ESR_CER);
+    CU_ASSERT_EQUAL(SCPI_RegGet(&scpi_context, SCPI_REG_STB), STB_QES | STB_ESR | STB_SRQ);
+    CU_ASSERT_EQUAL(atomic_load(&srq_count), 2);
+
+    /* reading of events clears summary */
+    SCPI_RegSet(&scpi_context, SCPI_REG_QUES, 0);
+    SCPI_RegSet(&scpi_context, SCPI_REG_ESR, 0);
+    CU_ASSERT_EQUAL(SCPI_RegGet(&scpi_context, SCPI_REG_STB), 0);
+
+    /* STB can be set directly */
+    SCPI_RegSetBits(&scpi_context, SCPI_REG_STB, STB_ESR);
+    CU_ASSERT_EQUAL(SCPI_RegGet(&scpi_context, SCPI_REG_STB), STB_ESR | STB_SRQ);
+    CU_ASSERT_EQUAL(atomic_load(&srq_count), 3);
+    SCPI_RegClearBits(&scpi_context, SCPI_REG_STB, STB_ESR);
+    CU_ASSERT_EQUAL(SCPI_RegGet(&scpi_context, SCPI_REG_STB), 0);
+
+    registers_check();
+}
+
+#define STRESS_THREADS      4
+#define STRESS_ITERATIONS   20000
+#define STRESS_ROUNDS       200
+
+static atomic_int stress_start;
+static atomic_int stress_running;
+
+static void * stressToggle(void * arg) {
+    scpi_reg_val_t bit = (scpi_reg_val_t) (intptr_t) arg;
+    int i;
+
+    while (!atomic_load(&stress_start)) {
+        sched_yield();
+    }
+
+    for (i = 0; i < STRESS_ITERATIONS; i++) {
+        SCPI_RegSetBits(&scpi_context, SCPI_REG_QUESC, bit);
+        SCPI_RegSetBits(&scpi_context, SCPI_REG_OPERC, bit);
+        SCPI_RegClearBits(&scpi_context, SCPI_REG_QUESC, bit);
+        SCPI_RegClearBits(&scpi_context, SCPI_REG_OPERC, bit);
+    }
+
+    atomic_fetch_sub(&stress_running, 1);
+    return NULL;
+}
+
+static void testRegistersStress(void) {
+    pthread_t threads[STRESS_THREADS];
+    int i;
+
+    registers_clear();
+    SCPI_RegSet(&scpi_context, SCPI_REG_SRE, STB_QES | STB_OPS);
+    SCPI_RegSet(&scpi_context, SCPI_REG_QUESE, 0x0005);
+    SCPI_RegSet(&scpi_context, SCPI_REG_OPERE, 0x000A);
+
+    atomic_store(&stress_start, 0);
+    atomic_store(&stress_running, STRESS_THREADS);
+    for (i = 0; i < STRESS_THREADS; i++) {
+        CU_ASSERT_EQUAL(pthread_create(&threads[i], NULL, stressToggle, (void *) (intptr_t) (1 << i)), 0);
+    }
+    atomic_store(&stress_start, 1);
+
+    /* parser thread reads and clears events meanwhile */
+    while (atomic_load(&stress_running) > 0) {
+        SCPI_RegSet(&scpi_context, SCPI_REG_QUES, 0);
+        SCPI_RegGet(&scpi_context, SCPI_REG_STB);
+        SCPI_RegSet(&scpi_context, SCPI_REG_OPER, 0);
+    }
+
+    for (i = 0; i < STRESS_THREADS; i++) {
+        pthread_join(threads[i], NULL);
+    }
+
+    CU_ASSERT_EQUAL(SCPI_RegGet(&scpi_context, SCPI_REG_QUESC), 0);
+    CU_ASSERT_EQUAL(SCPI_RegGet(&scpi_context, SCPI_REG_OPERC), 0);
+    registers_check();
+
+    SCPI_RegSet(&scpi_context, SCPI_REG_QUES, 0);
+    SCPI_RegSet(&scpi_context, SCPI_REG_OPER, 0);
+    CU_ASSERT_EQUAL(SCPI_RegGet(&scpi_context, SCPI_REG_STB), 0);
+}
+
+static void * stressSetOnce(void * arg) {
+    scpi_reg_val_t bit = (scpi_reg_val_t) (intptr_t) arg;
+
+    while (!atomic_load(&stress_start)) {
+        sched_yield();
+    }
+    SCPI_RegSetBits(&scpi_context, SCPI_REG_QUESC, bit);
+
+    return NULL;
+}
+
+static void testRegistersSrqOnce(void) {
+    pthread_t threads[STRESS_THREADS];
+    int round;
+    int i;
+    scpi_bool_t once = TRUE;
+
+    for (round = 0; round < STRESS_ROUNDS; round++) {
+        registers_clear();
+        SCPI_RegSet(&scpi_context, SCPI_REG_SRE, STB_QES);
+        SCPI_RegSet(&scpi_context, SCPI_REG_QUESE, 0xFFFF);
+
+        atomic_store(&stress_start, 0);
+        for (i = 0; i < STRESS_THREADS; i++) {
+            pthread_create(&threads[i], NULL, stressSetOnce, (void *) (intptr_t) (1 << i));
+        }
+        atomic_store(&stress_start, 1);
+        for (i = 0; i < STRESS_THREADS; i++) {
+            pthread_join(threads[i], NULL);
+        }
+
+        /* one transition of QES, one service request */
+        if (atomic_load(&srq_count) != 1) {
+            once = FALSE;
+        }
+        CU_ASSERT_EQUAL(SCPI_RegGet(&scpi_context, SCPI_REG_QUES), (1 << STRESS_THREADS) - 1);
+    }
+
+    CU_ASSERT_TRUE(once);
+    registers_check();
+}
+
+int main() {
+    unsigned int result;
+    CU_pSuite pSuite = NULL;
+
+    /* Initialize the CUnit test registry */
+    if (CUE_SUCCESS != CU_initialize_registry())
+        return CU_get_error();
+
+    /* Add a suite to the registry */
+    pSuite = CU_add_suite("Atomic registers", init_suite, clean_suite);
+    if (NULL == pSuite) {
+        CU_cleanup_registry();
+        return CU_get_error();
+    }
+
+    /* Add the tests to the suite */
+    if ((NULL == CU_add_test(pSuite, "propagation", testRegisters))
+            || (NULL == CU_add_test(pSuite, "stress", testRegistersStress))
+            || (NULL == CU_add_test(pSuite, "SRQ once", testRegistersSrqOnce))) {
+        CU_cleanup_registry();
+        return CU_get_error();
+    }
+
+    /* Run all tests using the CUnit Basic interface */
+    CU_basic_set_mode(CU_BRM_VERBOSE);
+    CU_basic_run_tests();
+    result = CU_get_number_of_tests_failed();
+    CU_cleanup_registry();
+    return result ? result : CU_get_error();
+}
@@ -769,7 +769,104 @@ static void test_swap(void) {
     TEST_SWAP(64, 0x123456789ABCDEF0ull, 0xF0DEBC9A78563412ull);
 }
 
-#if USE_DEVICE_DEPENDENT_ERROR_INFORMATION && !USE_MEMORY_ALLOCATION_FREE
+static void test_half(void) {
+#define TEST_FLOAT_TO_HALF(f, h) CU_ASSERT_EQUAL(SCPI_FloatToHalf(f), h)
+#define TEST_HALF_TO_FLOAT(h, f) CU_ASSERT_EQUAL(SCPI_HalfToFloat(h), f)
+
+    TEST_FLOAT_TO_HALF(0.0f, 0x0000);
+    TEST_FLOAT_TO_HALF(-0.0f, 0x8000);
+    TEST_FLOAT_TO_HALF(1.0f, 0x3C00);
+    TEST_FLOAT_TO_HALF(-2.0f, 0xC000);
+    TEST_FLOAT_TO_HALF(0.333333f, 0x3555);
+    TEST_FLOAT_TO_HALF(65504.0f, 0x7BFF);
+    TEST_FLOAT_TO_HALF(65520.0f, 0x7C00);
+    TEST_FLOAT_TO_HALF(1e10f, 0x7C00);
+    TEST_FLOAT_TO_HALF(-1e10f, 0xFC00);
+    TEST_FLOAT_TO_HALF(5.9604645e-8f, 0x0001);
+    TEST_FLOAT_TO_HALF(6.097555e-5f, 0x03FF);
+    TEST_FLOAT_TO_HALF(1e-8f, 0x0000);
+    /* round to nearest even */
+    TEST_FLOAT_TO_HALF(1.0f + 1.0f / 1024, 0x3C01);
+    TEST_FLOAT_TO_HALF(1.0f + 1.0f / 2048, 0x3C00);
+    TEST_FLOAT_TO_HALF(1.0f + 3.0f / 2048, 0x3C02);
+    TEST_FLOAT_TO_HALF(INFINITY, 0x7C00);
+    TEST_FLOAT_TO_HALF(NAN, 0x7E00);
+
+    TEST_HALF_TO_FLOAT(0x0000, 0.0f);
+    TEST_HALF_TO_FLOAT(0x3C00, 1.0f);
+    TEST_HALF_TO_FLOAT(0xC000, -2.0f);
+    TEST_HALF_TO_FLOAT(0x3555, 0.333251953125f);
+    TEST_HALF_TO_FLOAT(0x7BFF, 65504.0f);
+    TEST_HALF_TO_FLOAT(0x0001, 5.9604645e-8f);
+    TEST_HALF_TO_FLOAT(0x03FF, 6.097555e-5f);
+    TEST_HALF_TO_FLOAT(0x7C00, INFINITY);
+    CU_ASSERT(isnan(SCPI_HalfToFloat(0x7E00)));
+}
+
+#if USE_DEVICE_DEPENDENT_ERROR_INFORMATION && !USE_MEMORY_ALLOCATION_FREE && USE_ERROR_INFO_RECORDS
+
+static void test_heap(void) {
+    scpi_error_info_heap_t heap;
+    char error_info_heap[3 * sizeof (scpi_error_info_record_t) + sizeof (void *)];
+    char long_info[2 * SCPI_ERROR_INFO_RECORD_LENGTH];
+    const char * ptr5;
+    size_t len1, len2;
+
+    /* unaligned buffer still holds 3 records */
+    scpiheap_init(&heap, error_info_heap + 1, sizeof (error_info_heap) - 1);
+    CU_ASSERT_EQUAL(heap.size, 3);
+    CU_ASSERT_EQUAL(heap.count, 3);
+
+    char * ptr1 = scpiheap_strndup(&heap, "abcd", 4);
+    CU_ASSERT_STRING_EQUAL(ptr1, "abcd");
+
+    /* identical info shares the record */
+    char * ptr2 = scpiheap_strndup(&heap, "abcdef", 4);
+    CU_ASSERT_EQUAL(ptr2, ptr1);
+    CU_ASSERT_EQUAL(heap.count, 2);
+
+    char * ptr3 = scpiheap_strndup(&heap, "xyz", 3);
+    CU_ASSERT_STRING_EQUAL(ptr3, "xyz");
+
+    /* long info is truncated and marked */
+    memset(long_info, 'a', sizeof (long_info));
+    char * ptr4 = scpiheap_strndup(&heap, long_info, sizeof (long_info));
+    CU_ASSERT_EQUAL(strlen(ptr4), SCPI_ERROR_INFO_RECORD_LENGTH - 1);
+    CU_ASSERT_STRING_EQUAL(ptr4 + SCPI_ERROR_INFO_RECORD_LENGTH - 4, "...");
+    CU_ASSERT_EQUAL(ptr4[SCPI_ERROR_INFO_RECORD_LENGTH - 5], 'a');
+    CU_ASSERT_EQUAL(scpiheap_get_parts(&heap, ptr4, &len1, &ptr5, &len2), TRUE);
+    CU_ASSERT_EQUAL(len1, SCPI_ERROR_INFO_RECORD_LENGTH - 1);
+    CU_ASSERT_EQUAL(ptr5, NULL);
+    CU_ASSERT_EQUAL(len2, 0);
+    CU_ASSERT_EQUAL(heap.count, 0);
+
+    /* info stored out of its hash record is still shared */
+    CU_ASSERT_EQUAL(scpiheap_strndup(&heap, long_info, sizeof (long_info)), ptr4);
+    CU_ASSERT_EQUAL(scpiheap_strndup(&heap, "xyz", 3), ptr3);
+    scpiheap_free(&heap, ptr4, false);
+    scpiheap_free(&heap, ptr3, false);
+    CU_ASSERT_EQUAL(heap.count, 0);
+
+    /* all records are used */
+    CU_ASSERT_EQUAL(scpiheap_strndup(&heap, "ghij", 4), NULL);
+
+    /* record is free after the last reference is released */
+    scpiheap_free(&heap, ptr1, false);
+    CU_ASSERT_EQUAL(heap.count, 0);
+    scpiheap_free(&heap, ptr2, false);
+    CU_ASSERT_EQUAL(heap.count, 1);
+
+    char * ptr6 = scpiheap_strndup(&heap, "ghij", 4);
+    CU_ASSERT_STRING_EQUAL(ptr6, "ghij");
+    CU_ASSERT_STRING_EQUAL(ptr3, "xyz");
+
+    scpiheap_free(&heap, ptr3, true);
+    scpiheap_free(&heap, ptr4, false);
+    scpiheap_free(&heap, ptr6, false);
+    CU_ASSERT_EQUAL(heap.count, heap.size);
+}
+
+#elif USE_DEVICE_DEPENDENT_ERROR_INFORMATION && !USE_MEMORY_ALLOCATION_FREE
 
 static void test_heap(void) {
 
@@ -860,6 +957,7 @@ int main() {
             || (NULL == CU_add_test(pSuite, "matchCommand", test_matchCommand))
             || (NULL == CU_add_test(pSuite, "composeCompoundCommand", test_composeCompoundCommand))
             || (NULL == CU_add_test(pSuite, "swap", test_swap))
+            || (NULL == CU_add_test(pSuite, "half", test_half))
 #if USE_DEVICE_DEPENDENT_ERROR_INFORMATION && !USE_MEMORY_ALLOCATION_FREE
             || (NULL == CU_add_test(pSuite, "heap", test_heap))
 #endif
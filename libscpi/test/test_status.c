@@ -0,0 +1,260 @@
+/*-
+ * BSD 2-Clause License
+ *
+ * Copyright (c) 2012-2018, Jan Breuer
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * * Redistributions of source code must retain the above copyright notice, this
+ *   list of conditions and the following disclaimer.
+ *
+ * * Redistributions in binary form must reproduce the above copyright notice,
+ *   this list of conditions and the following disclaimer in the documentation
+ *   and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "CUnit/Basic.h"
+
+#include "scpi/scpi.h"
+
+/*
+ * CUnit Test Suite
+ */
+
+static int init_suite(void) {
+    return 0;
+}
+
+static int clean_suite(void) {
+    return 0;
+}
+
+#define CHANNELS 256
+
+/* QUEStionable:INSTrument register summarizing channel registers */
+enum {
+    DEF_INST = 0,
+    DEF_INST_SUMMARY,
+    DEF_CHANNEL,
+    DEF_COUNT
+};
+
+static const scpi_status_node_def_t status_defs[DEF_COUNT] = {
+    { SCPI_STATUS_NODE_REGISTER, 1, SCPI_STATUS_NODE_NONE, 13, SCPI_REG_QUESC },
+    { SCPI_STATUS_NODE_SUMMARY, CHANNELS, DEF_INST, 0, SCPI_REG_NONE },
+    { SCPI_STATUS_NODE_REGISTER, CHANNELS, DEF_INST_SUMMARY, 0, SCPI_REG_NONE },
+};
+
+static scpi_status_node_t status_nodes[CHANNELS + 2];
+static uint32_t status_bitmap[CHANNELS / 32];
+
+static int srq_count;
+
+static scpi_result_t SCPI_Control(scpi_t * context, scpi_ctrl_name_t ctrl, scpi_reg_val_t val) {
+    (void) context;
+    (void) val;
+
+    if (ctrl == SCPI_CTRL_SRQ) {
+        srq_count++;
+    }
+    return SCPI_RES_OK;
+}
+
+static scpi_interface_t scpi_interface = {
+    .control = SCPI_Control,
+};
+
+static scpi_t scpi_context;
+
+static void status_init(void) {
+    memset(&scpi_context, 0, sizeof (scpi_context));
+    scpi_context.interface = &scpi_interface;
+    SCPI_RegPresetFilters(&scpi_context);
+    CU_ASSERT_TRUE(SCPI_StatusTreeInit(&scpi_context, status_defs, DEF_COUNT,
+            status_nodes, CHANNELS + 2, status_bitmap, CHANNELS / 32));
+
+    SCPI_RegSet(&scpi_context, SCPI_REG_QUESE, 1 << 13);
+    SCPI_RegSet(&scpi_context, SCPI_REG_SRE, STB_QES);
+    srq_count = 0;
+}
+
+static void testStatusTreeInit(void) {
+    static const scpi_status_node_def_t late_parent[] = {
+        { SCPI_STATUS_NODE_REGISTER, 1, 1, 0, SCPI_REG_NONE },
+        { SCPI_STATUS_NODE_REGISTER, 1, SCPI_STATUS_NODE_NONE, 0, SCPI_REG_QUESC },
+    };
+    static const scpi_status_node_def_t too_many[] = {
+        { SCPI_STATUS_NODE_REGISTER, 1, SCPI_STATUS_NODE_NONE, 0, SCPI_REG_QUESC },
+        { SCPI_STATUS_NODE_REGISTER, 17, 0, 0, SCPI_REG_NONE },
+    };
+    static const scpi_status_node_def_t multi_parent[] = {
+        { SCPI_STATUS_NODE_REGISTER, 2, SCPI_STATUS_NODE_NONE, 0, SCPI_REG_QUESC },
+        { SCPI_STATUS_NODE_REGISTER, 1, 0, 0, SCPI_REG_NONE },
+    };
+
+    status_init();
+    CU_ASSERT_EQUAL(scpi_context.status_tree.nodes_count, CHANNELS + 2);
+    CU_ASSERT_EQUAL(SCPI_StatusNode(&scpi_context, DEF_INST, 0), 0);
+    CU_ASSERT_EQUAL(SCPI_StatusNode(&scpi_context, DEF_INST_SUMMARY, 0), 1);
+    CU_ASSERT_EQUAL(SCPI_StatusNode(&scpi_context, DEF_CHANNEL, 0), 2);
+    CU_ASSERT_EQUAL(SCPI_StatusNode(&scpi_context, DEF_CHANNEL, CHANNELS - 1), CHANNELS + 1);
+    CU_ASSERT_EQUAL(SCPI_StatusNode(&scpi_context, DEF_CHANNEL, CHANNELS), SCPI_STATUS_NODE_NONE);
+    CU_ASSERT_EQUAL(SCPI_StatusNode(&scpi_context, DEF_COUNT, 0), SCPI_STATUS_NODE_NONE);
+    CU_ASSERT_EQUAL(SCPI_StatusGet(&scpi_context, 2, SCPI_REG_CLASS_PTR), 0x7FFF);
+    CU_ASSERT_EQUAL(SCPI_StatusGet(&scpi_context, 2, SCPI_REG_CLASS_NTR), 0);
+
+    CU_ASSERT_FALSE(SCPI_StatusTreeInit(&scpi_context, status_defs, DEF_COUNT,
+            status_nodes, CHANNELS + 1, status_bitmap, CHANNELS / 32));
+    CU_ASSERT_FALSE(SCPI_StatusTreeInit(&scpi_context, status_defs, DEF_COUNT,
+            status_nodes, CHANNELS + 2, status_bitmap, CHANNELS / 32 - 1));
+    CU_ASSERT_FALSE(SCPI_StatusTreeInit(&scpi_context, late_parent, 2, status_nodes, 2, NULL, 0));
+    CU_ASSERT_FALSE(SCPI_StatusTreeInit(&scpi_context, too_many, 2, status_nodes, 18, NULL, 0));
+    CU_ASSERT_FALSE(SCPI_StatusTreeInit(&scpi_context, multi_parent, 2, status_nodes, 3, NULL, 0));
+    CU_ASSERT_EQUAL(scpi_context.status_tree.nodes_count, 0);
+}
+
+static void testStatusTreePropagation(void) {
+    uint16_t ch200, ch5;
+    scpi_reg_val_t events[CHANNELS];
+
+    status_init();
+    ch200 = SCPI_StatusNode(&scpi_context, DEF_CHANNEL, 200);
+    ch5 = SCPI_StatusNode(&scpi_context, DEF_CHANNEL, 5);
+
+    SCPI_StatusSet(&scpi_context, ch200, SCPI_REG_CLASS_COND, 4);
+    CU_ASSERT_EQUAL(SCPI_StatusGet(&scpi_context, ch200, SCPI_REG_CLASS_EVEN), 4);
+    CU_ASSERT_EQUAL(SCPI_StatusSummaryNext(&scpi_context, 1, 0), 200);
+    CU_ASSERT_EQUAL(SCPI_StatusSummaryNext(&scpi_context, 1, 201), CHANNELS);
+    /* not a summary node */
+    CU_ASSERT_EQUAL(SCPI_StatusSummaryNext(&scpi_context, ch200, 0), SIZE_MAX);
+    CU_ASSERT_EQUAL(SCPI_StatusSummaryNext(&scpi_context, CHANNELS + 2, 0), SIZE_MAX);
+    CU_ASSERT_EQUAL(SCPI_StatusGet(&scpi_context, 0, SCPI_REG_CLASS_COND), 1);
+    CU_ASSERT_EQUAL(SCPI_StatusGet(&scpi_context, 0, SCPI_REG_CLASS_EVEN), 1);
+    CU_ASSERT_EQUAL(SCPI_RegGet(&scpi_context, SCPI_REG_QUESC), 1 << 13);
+    CU_ASSERT_EQUAL(SCPI_RegGet(&scpi_context, SCPI_REG_QUES), 1 << 13);
+    CU_ASSERT_EQUAL(SCPI_RegGet(&scpi_context, SCPI_REG_STB), STB_QES | STB_SRQ);
+    SCPI_RegServiceRequestFlush(&scpi_context);
+    CU_ASSERT_EQUAL(srq_count, 1);
+
+    /* summary is already active */
+    SCPI_StatusSet(&scpi_context, ch5, SCPI_REG_CLASS_COND, 1);
+    CU_ASSERT_EQUAL(SCPI_StatusSummaryNext(&scpi_context, 1, 0), 5);
+    CU_ASSERT_EQUAL(SCPI_StatusSummaryNext(&scpi_context, 1, 6), 200);
+    SCPI_RegServiceRequestFlush(&scpi_context);
+    CU_ASSERT_EQUAL(srq_count, 1);
+
+    /* conditions go away, events stay latched */
+    SCPI_StatusSet(&scpi_context, ch200, SCPI_REG_CLASS_COND, 0);
+    SCPI_StatusSet(&scpi_context, ch5, SCPI_REG_CLASS_COND, 0);
+    CU_ASSERT_EQUAL(SCPI_StatusSummaryNext(&scpi_context, 1, 0), 5);
+
+    /* disabled event doesn't summarize */
+    SCPI_StatusSet(&scpi_context, ch5, SCPI_REG_CLASS_ENAB, 0);
+    CU_ASSERT_EQUAL(SCPI_StatusSummaryNext(&scpi_context, 1, 0), 200);
+
+    CU_ASSERT_EQUAL(SCPI_StatusEventsRead(&scpi_context, SCPI_StatusNode(&scpi_context, DEF_CHANNEL, 0), events, CHANNELS), CHANNELS);
+    CU_ASSERT_EQUAL(events[5], 1);
+    CU_ASSERT_EQUAL(events[200], 4);
+    CU_ASSERT_EQUAL(events[6], 0);
+    CU_ASSERT_EQUAL(SCPI_StatusSummaryNext(&scpi_context, 1, 0), CHANNELS);
+    CU_ASSERT_EQUAL(SCPI_StatusGet(&scpi_context, 0, SCPI_REG_CLASS_COND), 0);
+
+    /* INSTrument event is still latched */
+    CU_ASSERT_EQUAL(SCPI_RegGet(&scpi_context, SCPI_REG_QUESC), 1 << 13);
+    SCPI_StatusTreeClear(&scpi_context);
+    CU_ASSERT_EQUAL(SCPI_RegGet(&scpi_context, SCPI_REG_QUESC), 0);
+    SCPI_RegServiceRequestFlush(&scpi_context);
+    CU_ASSERT_EQUAL(srq_count, 1);
+}
+
+static void testStatusTreeFilters(void) {
+    uint16_t ch;
+
+    status_init();
+    ch = SCPI_StatusNode(&scpi_context, DEF_CHANNEL, 8);
+    SCPI_StatusSet(&scpi_context, ch, SCPI_REG_CLASS_PTR, 0);
+    SCPI_StatusSet(&scpi_context, ch, SCPI_REG_CLASS_NTR, 2);
+
+    SCPI_StatusSet(&scpi_context, ch, SCPI_REG_CLASS_COND, 3);
+    CU_ASSERT_EQUAL(SCPI_StatusGet(&scpi_context, ch, SCPI_REG_CLASS_EVEN), 0);
+    SCPI_StatusSet(&scpi_context, ch, SCPI_REG_CLASS_COND, 0);
+    CU_ASSERT_EQUAL(SCPI_StatusGet(&scpi_context, ch, SCPI_REG_CLASS_EVEN), 2);
+    SCPI_RegServiceRequestFlush(&scpi_context);
+    CU_ASSERT_EQUAL(srq_count, 1);
+
+    SCPI_StatusTreePreset(&scpi_context);
+    CU_ASSERT_EQUAL(SCPI_StatusGet(&scpi_context, ch, SCPI_REG_CLASS_PTR), 0x7FFF);
+    CU_ASSERT_EQUAL(SCPI_StatusGet(&scpi_context, ch, SCPI_REG_CLASS_NTR), 0);
+}
+
+static void testStatusTreeSnapshot(void) {
+    scpi_status_condition_t snapshot[CHANNELS];
+    int i;
+
+    status_init();
+    for (i = 0; i < CHANNELS; i++) {
+        snapshot[i].node = SCPI_StatusNode(&scpi_context, DEF_CHANNEL, i);
+        snapshot[i].val = (i % 3) ? 0 : 1;
+    }
+
+    SCPI_StatusSetConditions(&scpi_context, snapshot, CHANNELS);
+    SCPI_RegServiceRequestFlush(&scpi_context);
+    CU_ASSERT_EQUAL(srq_count, 1);
+    CU_ASSERT_EQUAL(SCPI_StatusSummaryNext(&scpi_context, 1, 0), 0);
+    CU_ASSERT_EQUAL(SCPI_StatusSummaryNext(&scpi_context, 1, 1), 3);
+    CU_ASSERT_EQUAL(SCPI_StatusSummaryNext(&scpi_context, 1, 254), 255);
+    CU_ASSERT_EQUAL(SCPI_RegGet(&scpi_context, SCPI_REG_STB), STB_QES | STB_SRQ);
+
+    /* the same snapshot again has no transitions */
+    SCPI_StatusSetConditions(&scpi_context, snapshot, CHANNELS);
+    SCPI_RegServiceRequestFlush(&scpi_context);
+    CU_ASSERT_EQUAL(srq_count, 1);
+}
+
+int main() {
+    unsigned int result;
+    CU_pSuite pSuite = NULL;
+
+    /* Initialize the CUnit test registry */
+    if (CUE_SUCCESS != CU_initialize_registry())
+        return CU_get_error();
+
+    /* Add a suite to the registry */
+    pSuite = CU_add_suite("Status tree", init_suite, clean_suite);
+    if (NULL == pSuite) {
+        CU_cleanup_registry();
+        return CU_get_error();
+    }
+
+    /* Add the tests to the suite */
+    if ((NULL == CU_add_test(pSuite, "init", testStatusTreeInit))
+            || (NULL == CU_add_test(pSuite, "propagation", testStatusTreePropagation))
+            || (NULL == CU_add_test(pSuite, "transition filters", testStatusTreeFilters))
+            || (NULL == CU_add_test(pSuite, "snapshot", testStatusTreeSnapshot))) {
+        CU_cleanup_registry();
+        return CU_get_error();
+    }
+
+    /* Run all tests using the CUnit Basic interface */
+    CU_basic_set_mode(CU_BRM_VERBOSE);
+    CU_basic_run_tests();
+    result = CU_get_number_of_tests_failed();
+    CU_cleanup_registry();
+    return result ? result : CU_get_error();
+}